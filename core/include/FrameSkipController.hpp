@@ -0,0 +1,92 @@
+#ifndef FRAME_SKIP_CONTROLLER_HPP
+#define FRAME_SKIP_CONTROLLER_HPP
+
+class FrameSkipController {
+public:
+	/** Default constructor
+	  * Frame-skip starts at 1 (every frame rendered) and may increase to at most 4.
+	  */
+	FrameSkipController();
+
+	/** Get the current frame-skip value N (1 out of every N frames are rendered)
+	  */
+	unsigned short getFrameSkip() const {
+		return frameSkip;
+	}
+
+	/** Get the maximum frame-skip value
+	  */
+	unsigned short getMaximum() const {
+		return maxFrameSkip;
+	}
+
+	/** Get the average fraction of the frame period spent working on frames which were rendered
+	  */
+	double getRenderedLoad() const {
+		return (period > 0 ? renderedTime / period : 0);
+	}
+
+	/** Get the average fraction of the frame period spent working on frames which were skipped
+	  */
+	double getSkippedLoad() const {
+		return (period > 0 ? skippedTime / period : 0);
+	}
+
+	/** Set the maximum frame-skip value (must be at least 1)
+	  */
+	void setMaximum(const unsigned short &N);
+
+	/** Set the fraction of the frame period above which frame-skip is increased (default = 0.95)
+	  */
+	void setUpperThreshold(const double &load){
+		upperThreshold = load;
+	}
+
+	/** Set the fraction of the frame period which the predicted load must fall below before frame-skip is decreased (default = 0.8)
+	  */
+	void setLowerThreshold(const double &load){
+		lowerThreshold = load;
+	}
+
+	/** Reset frame time averages and set the current frame-skip value
+	  */
+	void reset(const unsigned short &N=1);
+
+	/** Add the measured time spent working on a frame and adjust the frame-skip value
+	  * Frame-skip is increased when the average load exceeds the upper threshold for several successive frames
+	  * and is only decreased once the load predicted for the smaller frame-skip value has remained below the
+	  * lower threshold for one second of frames, so that it does not oscillate around the target framerate.
+	  * @param workTime Wall time spent emulating (and rendering) the frame, excluding time spent waiting for VSync
+	  * @param framePeriod Target wall time between successive frames
+	  * @param rendered Set if the frame was rendered and false if it was skipped
+	  * @return The new frame-skip value
+	  */
+	unsigned short update(const double &workTime, const double &framePeriod, bool rendered);
+
+private:
+	unsigned short frameSkip; ///< Current frame-skip value N (1 out of every N frames are rendered)
+
+	unsigned short maxFrameSkip; ///< Maximum frame-skip value
+
+	unsigned short framesOver; ///< Number of successive frames with average load above the upper threshold
+
+	unsigned short framesUnder; ///< Number of successive frames with predicted load below the lower threshold
+
+	double upperThreshold; ///< Fraction of the frame period above which frame-skip is increased
+
+	double lowerThreshold; ///< Fraction of the frame period below which frame-skip is decreased
+
+	double renderedTime; ///< Moving average of the work time of rendered frames
+
+	double skippedTime; ///< Moving average of the work time of skipped frames
+
+	double period; ///< Most recent target frame period
+
+	/** Get the average work time per frame for a given frame-skip value
+	  */
+	double getAverageWorkTime(const unsigned short &N) const {
+		return (renderedTime + (N - 1) * skippedTime) / N;
+	}
+};
+
+#endif
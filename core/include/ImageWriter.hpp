@@ -0,0 +1,86 @@
+#ifndef IMAGE_WRITER_HPP
+#define IMAGE_WRITER_HPP
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+#include "SpscQueue.hpp"
+#include "PngEncoder.hpp"
+
+/** Background thread which encodes images and writes them to PNG files
+  * Images are copied into one of a fixed number of frame slots and handed to the writer thread, so the calling
+  * thread never waits for encoding or file output. Images may only be queued by a single thread.
+  */
+class ImageWriter{
+public:
+	static constexpr size_t MAX_QUEUED_FRAMES = 16; ///< Number of frame slots (maximum number of images waiting to be written)
+
+	/** Default constructor
+	  * The writer thread is started when the first image is queued.
+	  */
+	ImageWriter();
+
+	/** Destructor
+	  * Writes all queued images and stops the writer thread.
+	  */
+	~ImageWriter();
+
+	/** Get the number of images which have been written to disk
+	  */
+	unsigned int getImagesWritten() const {
+		return nWritten.load(std::memory_order_acquire);
+	}
+
+	/** Get the number of images which could not be queued or written
+	  */
+	unsigned int getImagesDropped() const {
+		return nDropped.load(std::memory_order_acquire);
+	}
+
+	/** Queue a packed RGBA image to be written to a PNG file
+	  * @param fname Output filename
+	  * @param pixels Packed RGBA pixels (row-major), copied before returning
+	  * @param W Width of the image (in pixels)
+	  * @param H Height of the image (in pixels)
+	  * @param wait If set, wait for a free frame slot when all slots are in use. Otherwise the image is dropped.
+	  * @return True if the image was queued and return false if it was dropped
+	  */
+	bool write(const std::string &fname, const uint32_t *pixels, const int &W, const int &H, bool wait=false);
+
+	/** Wait for all queued images to be written and stop the writer thread
+	  */
+	void stop();
+
+private:
+	struct Frame{
+		std::string filename; ///< Output filename
+		std::vector<uint32_t> pixels; ///< Packed RGBA pixels
+		int width; ///< Width of the image (in pixels)
+		int height; ///< Height of the image (in pixels)
+	};
+
+	Frame frames[MAX_QUEUED_FRAMES]; ///< Frame slots
+
+	SpscQueue<unsigned char, MAX_QUEUED_FRAMES> freeFrames; ///< Indices of unused frame slots (returned by the writer thread)
+
+	SpscQueue<unsigned char, MAX_QUEUED_FRAMES> queuedFrames; ///< Indices of frame slots waiting to be written
+
+	std::thread thread; ///< The writer thread
+
+	std::atomic<bool> stopRequested; ///< Set when the writer thread should exit once all queued images are written
+
+	std::atomic<unsigned int> nWritten; ///< Number of images written to disk
+
+	std::atomic<unsigned int> nDropped; ///< Number of images which could not be queued or written
+
+	PngEncoder encoder; ///< PNG encoder (used by the writer thread only)
+
+	/** Main loop of the writer thread
+	  */
+	void run();
+};
+
+#endif
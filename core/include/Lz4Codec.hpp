@@ -0,0 +1,71 @@
+#ifndef LZ4_CODEC_HPP
+#define LZ4_CODEC_HPP
+
+#include <vector>
+#include <cstdint>
+
+/** Fast lossless compression using the LZ4 block format
+  * Compressed buffers are preceded by an 8 byte header (4 byte identifier and 4 byte uncompressed length) so that
+  * they may be recognized when read back. Each codec owns its own match table, so separate codecs may be used
+  * from separate threads at the same time. Decompression is stateless.
+  */
+class Lz4Codec{
+public:
+	static constexpr uint32_t MAGIC = 0x345A4247; ///< Compressed buffer identifier ("GBZ4")
+
+	static constexpr size_t HEADER_LENGTH = 8; ///< Length of the compressed buffer header (in bytes)
+
+	/** Default constructor
+	  */
+	Lz4Codec();
+
+	/** Get the maximum length of a compressed block (not including the header)
+	  * @param length Length of the uncompressed input (in bytes)
+	  */
+	static size_t getMaxCompressedLength(const size_t &length){
+		return length + length / 255 + 16;
+	}
+
+	/** Return true if a buffer begins with a compressed buffer header
+	  */
+	static bool isCompressed(const unsigned char *src, const size_t &length);
+
+	/** Compress a buffer and prepend the compressed buffer header
+	  * @param src Input buffer
+	  * @param length Length of the input buffer (in bytes)
+	  * @param dest Output buffer, resized to the length of the compressed buffer
+	  * @return The length of the compressed buffer, including the header
+	  */
+	size_t compress(const unsigned char *src, const size_t &length, std::vector<unsigned char> &dest);
+
+	/** Decompress a buffer written by compress()
+	  * @param src Input buffer
+	  * @param length Length of the input buffer (in bytes)
+	  * @param dest Output buffer, resized to the uncompressed length
+	  * @return True if the input was decompressed successfully and return false if it is malformed
+	  */
+	static bool decompress(const unsigned char *src, const size_t &length, std::vector<unsigned char> &dest);
+
+	/** Compress a buffer to a single LZ4 block (without a header)
+	  * @param src Input buffer
+	  * @param length Length of the input buffer (in bytes)
+	  * @param dest Output buffer with room for at least getMaxCompressedLength(length) bytes
+	  * @return The length of the compressed block (in bytes)
+	  */
+	size_t compressBlock(const unsigned char *src, const size_t &length, unsigned char *dest);
+
+	/** Decompress a single LZ4 block
+	  * The input is fully bounds checked, so malformed blocks are rejected rather than read or written out of bounds.
+	  * @param src Input block
+	  * @param length Length of the input block (in bytes)
+	  * @param dest Output buffer
+	  * @param destLength Exact length of the decompressed data (in bytes)
+	  * @return True if the block was decompressed successfully and return false if it is malformed
+	  */
+	static bool decompressBlock(const unsigned char *src, const size_t &length, unsigned char *dest, const size_t &destLength);
+
+private:
+	std::vector<uint32_t> hashTable; ///< Most recent input position for each hashed four byte sequence
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef MEMORY_ARENA_HPP
+#define MEMORY_ARENA_HPP
+
+#include <vector>
+
+class MemoryArena{
+public:
+	/** Default constructor
+	  * No memory is allocated.
+	  */
+	MemoryArena() :
+		nBytesPerBank(0),
+		nBanks(0),
+		base(0x0),
+		storage()
+	{
+	}
+
+	/** Allocation constructor
+	  * @param nB Number of bytes per bank
+	  * @param N Number of banks
+	  */
+	MemoryArena(const unsigned short &nB, const unsigned short &N) :
+		MemoryArena()
+	{
+		allocate(nB, N);
+	}
+
+	/** Copy constructor
+	  * Contents of the input arena are copied into a newly aligned block.
+	  */
+	MemoryArena(const MemoryArena &other);
+
+	/** Assignment operator
+	  */
+	MemoryArena &operator = (const MemoryArena &other);
+
+	/** Get a pointer to the beginning of a memory bank
+	  * No validity checks are performed, undefined behavior may result.
+	  * @param bank Bank number (indexed from zero)
+	  */
+	unsigned char *operator [] (const unsigned short &bank){
+		return base + bank * nBytesPerBank;
+	}
+
+	/** Get a const pointer to the beginning of a memory bank
+	  * No validity checks are performed, undefined behavior may result.
+	  * @param bank Bank number (indexed from zero)
+	  */
+	const unsigned char *operator [] (const unsigned short &bank) const {
+		return base + bank * nBytesPerBank;
+	}
+
+	/** Get a pointer to the beginning of the arena (or null if no memory is allocated)
+	  */
+	unsigned char *data(){
+		return base;
+	}
+
+	/** Get a const pointer to the beginning of the arena (or null if no memory is allocated)
+	  */
+	const unsigned char *data() const {
+		return base;
+	}
+
+	/** Return true if no memory is allocated
+	  */
+	bool empty() const {
+		return (base == 0x0);
+	}
+
+	/** Get the total size of all banks (in bytes)
+	  */
+	unsigned int size() const {
+		return nBytesPerBank * nBanks;
+	}
+
+	/** Allocate a single contiguous, cache line aligned block of memory for all banks
+	  * Any previously allocated memory is released. All banks are initially filled with zeros.
+	  * @param nB Number of bytes per bank
+	  * @param N Number of banks
+	  */
+	void allocate(const unsigned short &nB, const unsigned short &N);
+
+	/** Release all allocated memory
+	  */
+	void clear();
+
+private:
+	unsigned int nBytesPerBank; ///< Number of bytes per bank
+
+	unsigned int nBanks; ///< Number of banks
+
+	unsigned char *base; ///< Cache line aligned pointer to the first byte of bank zero
+
+	std::vector<unsigned char> storage; ///< Underlying storage (padded so that the arena may be aligned)
+};
+
+#endif
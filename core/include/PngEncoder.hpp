@@ -0,0 +1,61 @@
+#ifndef PNG_ENCODER_HPP
+#define PNG_ENCODER_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/** Minimal PNG image encoder with no external dependencies
+  * Images are written as 8-bit RGB with no scanline filtering and uncompressed (stored) deflate blocks. Files
+  * are larger than those written by zlib, but encoding a frame costs little more than copying it.
+  */
+class PngEncoder{
+public:
+	/** Default constructor
+	  */
+	PngEncoder();
+
+	/** Encode a packed RGBA image (alpha is discarded)
+	  * @param pixels Packed RGBA pixels (row-major) stored in memory in the order R, G, B, A
+	  * @param W Width of the image (in pixels)
+	  * @param H Height of the image (in pixels)
+	  * @return Encoded PNG file, valid until the next call to encode()
+	  */
+	const std::vector<unsigned char> &encode(const uint32_t *pixels, const int &W, const int &H);
+
+	/** Encode a packed RGBA image and write it to a file
+	  * @return True if the file was written successfully and return false otherwise
+	  */
+	bool write(const std::string &fname, const uint32_t *pixels, const int &W, const int &H);
+
+private:
+	std::vector<unsigned char> scanlines; ///< Raw image data (filter type byte followed by RGB pixels for each row)
+
+	std::vector<unsigned char> output; ///< Encoded PNG file
+
+	uint32_t crcTable[256]; ///< CRC-32 lookup table
+
+	/** Append a 32-bit big-endian integer to the output
+	  */
+	void appendUInt(const uint32_t &value);
+
+	/** Append a chunk header (length and type) to the output
+	  * @return Offset of the chunk type in the output (the start of the data covered by the chunk CRC)
+	  */
+	size_t beginChunk(const uint32_t &length, const char *type);
+
+	/** Append the CRC of a chunk to the output
+	  * @param start Offset returned by beginChunk()
+	  */
+	void endChunk(const size_t &start);
+
+	/** Compute the CRC-32 of a block of bytes
+	  */
+	uint32_t crc32(const unsigned char *data, const size_t &length) const ;
+
+	/** Compute the Adler-32 checksum of a block of bytes
+	  */
+	static uint32_t adler32(const unsigned char *data, const size_t &length);
+};
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef REWIND_BUFFER_HPP
+#define REWIND_BUFFER_HPP
+
+#include <vector>
+#include <deque>
+
+#include "Lz4Codec.hpp"
+
+/** Fixed-size history of emulator savestates
+  * Only the most recent state is stored in full. Every older state is stored as the run-length encoded XOR
+  * difference between it and the next newer state, so consecutive states which differ in only a few bytes are
+  * very small. Encoded differences are further compressed with LZ4 when that makes them smaller. States are
+  * popped newest first. When the buffer is full, the oldest states are discarded.
+  */
+class RewindBuffer{
+public:
+	/** Default constructor
+	  * @param capacity Number of bytes available for storing compressed states
+	  */
+	RewindBuffer(const size_t &capacity=0x800000);
+
+	/** Get the number of states which may be popped
+	  */
+	size_t getNumberOfStates() const {
+		return (latest.empty() ? 0 : deltas.size() + 1);
+	}
+
+	/** Get the number of bytes used to store the compressed states (not including the most recent state)
+	  */
+	size_t getBytesUsed() const ;
+
+	/** Get the number of bytes available for storing compressed states
+	  */
+	size_t getCapacity() const {
+		return storage.size();
+	}
+
+	/** Return true if there are no states to pop
+	  */
+	bool empty() const {
+		return latest.empty();
+	}
+
+	/** Discard all states
+	  */
+	void clear();
+
+	/** Add a new state
+	  * The previous most recent state is compressed against the new state. All states are discarded
+	  * if the size of the new state does not match the size of the previous state. A state identical to the
+	  * previous state is recorded without using any storage.
+	  */
+	void push(const std::vector<unsigned char> &state);
+
+	/** Remove the most recent state
+	  * @param state Output buffer for the most recent state
+	  * @return True if a state was removed and return false if the buffer is empty
+	  */
+	bool pop(std::vector<unsigned char> &state);
+
+private:
+	struct Delta{
+		size_t offset; ///< Offset of the compressed difference in the storage buffer
+		size_t length; ///< Length of the compressed difference (in bytes)
+		size_t encodedLength; ///< Length of the difference before LZ4 compression (zero if stored without LZ4 compression)
+	};
+
+	std::vector<unsigned char> storage; ///< Ring buffer of compressed differences between successive states
+
+	std::vector<unsigned char> latest; ///< The most recent state (uncompressed)
+
+	std::vector<unsigned char> scratch; ///< Compression output buffer
+
+	std::vector<unsigned char> packed; ///< LZ4 compression output buffer
+
+	Lz4Codec codec; ///< LZ4 compressor for encoded differences
+
+	std::deque<Delta> deltas; ///< Compressed differences, oldest first
+
+	/** Run-length encode the XOR difference between two equal-length states into the scratch buffer
+	  * @return Length of the encoded difference (in bytes)
+	  */
+	size_t encode(const unsigned char *current, const unsigned char *previous, const size_t &length);
+
+	/** Apply an encoded XOR difference to the most recent state
+	  */
+	void decode(const unsigned char *src, const size_t &length);
+
+	/** Remove the newest compressed difference and apply it to the most recent state
+	  */
+	void popDelta();
+
+	/** Get the offset in the storage buffer following the newest compressed difference
+	  */
+	size_t getHead() const ;
+
+	/** Find space for a compressed difference, discarding the oldest differences as needed
+	  * @return Offset in the storage buffer, or the storage size if the difference can never fit
+	  */
+	size_t allocate(const size_t &length);
+};
+
+#endif
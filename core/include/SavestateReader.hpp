@@ -0,0 +1,119 @@
+#ifndef SAVESTATE_READER_HPP
+#define SAVESTATE_READER_HPP
+
+#include <string>
+#include <vector>
+
+constexpr unsigned int SAVESTATE_MAGIC = 0x53434247; ///< Savestate file identifier ("GBCS")
+
+constexpr unsigned int SAVESTATE_HEADER_LENGTH = 18; ///< Length of the savestate header (in bytes)
+
+constexpr unsigned int SAVESTATE_CHUNK_HEADER_LENGTH = 10; ///< Length of the header preceding each chunk (in bytes)
+
+/** A single chunk of a savestate
+  * Each chunk is a 4 byte identifier, a 2 byte version number, and a 4 byte payload length followed by the
+  * payload. All header fields are little-endian.
+  */
+class SavestateChunk{
+public:
+	unsigned int id; ///< Four character code identifying the owner of the chunk (system component ID)
+
+	unsigned short version; ///< Version of the payload layout
+
+	unsigned int length; ///< Length of the payload (in bytes)
+
+	const unsigned char *payload; ///< Pointer to the payload inside the savestate buffer
+
+	/** Default constructor
+	  */
+	SavestateChunk() :
+		id(0),
+		version(0),
+		length(0),
+		payload(0x0)
+	{
+	}
+
+	/** Get the four character code of the chunk as a string
+	  */
+	std::string getName() const ;
+
+	/** Read a chunk header and point the payload at the data following it
+	  * @param src Input buffer
+	  * @param length Number of bytes available in the input buffer
+	  * @return True if the header and the entire payload lie within the buffer, otherwise return false
+	  */
+	bool read(const unsigned char *src, const size_t &length);
+
+	/** Write a chunk header
+	  * @param dest Output buffer with room for at least SAVESTATE_CHUNK_HEADER_LENGTH bytes
+	  * @param id Four character code identifying the owner of the chunk
+	  * @param version Version of the payload layout
+	  * @param length Length of the payload following the header (in bytes)
+	  * @return The number of bytes written to the buffer
+	  */
+	static unsigned int writeHeader(unsigned char *dest, const unsigned int &id, const unsigned short &version, const unsigned int &length);
+};
+
+/** Index of the chunks in a savestate buffer
+  * A savestate is an 18 byte header (4 byte identifier, 2 byte format version, and 12 byte ROM title) followed
+  * by any number of chunks in any order. Chunk payloads are not copied, so the buffer must outlive the reader.
+  */
+class SavestateReader{
+public:
+	/** Default constructor
+	  */
+	SavestateReader() :
+		version(0),
+		title(0x0),
+		chunks()
+	{
+	}
+
+	/** Get the savestate format version
+	  */
+	unsigned short getVersion() const {
+		return version;
+	}
+
+	/** Get a pointer to the 12 byte ROM title
+	  */
+	const unsigned char *getTitle() const {
+		return title;
+	}
+
+	/** Get all chunks, in the order in which they appear in the savestate
+	  */
+	const std::vector<SavestateChunk> &getChunks() const {
+		return chunks;
+	}
+
+	/** Index all chunks in a savestate buffer
+	  * @param state Input savestate buffer
+	  * @param length Length of the input buffer (in bytes)
+	  * @return True if the buffer is a savestate and every chunk lies within the buffer, otherwise return false
+	  */
+	bool open(const unsigned char *state, const size_t &length);
+
+	/** Find the first chunk with a specified identifier
+	  * @return Pointer to the chunk or null if no chunk has the identifier
+	  */
+	const SavestateChunk *find(const unsigned int &id) const ;
+
+	/** Write a savestate header
+	  * @param dest Output buffer with room for at least SAVESTATE_HEADER_LENGTH bytes
+	  * @param version Savestate format version
+	  * @param title 12 byte ROM title
+	  * @return The number of bytes written to the buffer
+	  */
+	static unsigned int writeHeader(unsigned char *dest, const unsigned short &version, const char *title);
+
+private:
+	unsigned short version; ///< Savestate format version
+
+	const unsigned char *title; ///< ROM title inside the savestate buffer
+
+	std::vector<SavestateChunk> chunks; ///< Index of all chunks
+};
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <vector>
+
+class SystemComponent;
+
+class ScheduledEvent{
+public:
+	unsigned long long nCycle; ///< Absolute system clock cycle at which the event is due
+
+	unsigned int nIndex; ///< Index of the associated scheduler entry
+
+	/** Default constructor
+	  */
+	ScheduledEvent() :
+		nCycle(0),
+		nIndex(0)
+	{
+	}
+
+	/** Event constructor
+	  * @param cycle Absolute system clock cycle at which the event is due
+	  * @param index Index of the associated scheduler entry
+	  */
+	ScheduledEvent(const unsigned long long &cycle, const unsigned int &index) :
+		nCycle(cycle),
+		nIndex(index)
+	{
+	}
+
+	/** Return true if this event is due after the rhs event
+	  * Used to order the event heap so that the earliest event is on top.
+	  */
+	bool operator > (const ScheduledEvent &rhs) const {
+		return (nCycle > rhs.nCycle);
+	}
+};
+
+class Scheduler{
+public:
+	/** Default constructor
+	  */
+	Scheduler();
+
+	/** Add a system component to the list of scheduled components
+	  * The component will only be clocked when its next event is due, or when the scheduler is synchronized.
+	  */
+	void add(SystemComponent *comp);
+
+	/** Get the total number of system clock cycles since the scheduler was started
+	  */
+	unsigned long long getCurrentCycle() const {
+		return nCurrentCycle;
+	}
+
+	/** Get the absolute system clock cycle of the next pending event
+	  */
+	unsigned long long getNextEvent() const {
+		return nNextEvent;
+	}
+
+	/** Get the number of system clock cycles until the next pending event
+	  */
+	unsigned long long getCyclesUntilNextEvent() const {
+		return (nNextEvent > nCurrentCycle ? nNextEvent - nCurrentCycle : 0);
+	}
+
+	/** Advance the scheduler by one system clock cycle
+	  * Any events which are due will be dispatched.
+	  * @return True if one or more events were dispatched and return false otherwise
+	  */
+	bool tick(){
+		if(++nCurrentCycle < nNextEvent)
+			return false;
+		return dispatch();
+	}
+
+	/** Advance the scheduler by multiple system clock cycles
+	  * All events which are due will be dispatched in order. No event will be skipped.
+	  * @return True if one or more events were dispatched and return false otherwise
+	  */
+	bool advance(const unsigned int &nCycles);
+
+	/** Bring all scheduled components up to date with the current system clock cycle
+	  * Should be called before any component state is accessed from outside of the component (e.g. register reads).
+	  */
+	void sync();
+
+	/** Recompute the next event for all scheduled components
+	  * Should be called whenever the state of one or more components has been changed externally (e.g. register writes).
+	  */
+	void reschedule();
+
+private:
+	class ScheduleEntry{
+	public:
+		SystemComponent *comp; ///< Pointer to the scheduled system component
+
+		unsigned long long nLastSync; ///< The system clock cycle the component was last brought up to date
+
+		unsigned long long nDeadline; ///< The system clock cycle of the next component event
+
+		/** Component constructor
+		  */
+		ScheduleEntry(SystemComponent *ptr, const unsigned long long &cycle);
+	};
+
+	unsigned long long nCurrentCycle; ///< Total number of system clock cycles
+
+	unsigned long long nNextEvent; ///< The system clock cycle of the earliest pending event
+
+	std::vector<ScheduleEntry> components; ///< List of all scheduled components
+
+	std::vector<ScheduledEvent> events; ///< Binary min-heap of pending events (stale events are discarded when popped)
+
+	/** Dispatch all events which are currently due
+	  * @return True if at least one event was dispatched
+	  */
+	bool dispatch();
+
+	/** Clock a component up to the current system clock cycle
+	  */
+	void syncComponent(ScheduleEntry &entry);
+
+	/** Query a component for its next event and push it onto the event heap
+	  */
+	void schedule(const unsigned int &index);
+
+	/** Rebuild the event heap from the current component deadlines, discarding all stale events
+	  */
+	void rebuild();
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+
+/** Lock-free bounded queue with a single producer thread and a single consumer thread
+  * Neither push() nor pop() ever block. Elements which are pushed while the queue is full are dropped.
+  */
+template <typename T, size_t N>
+class SpscQueue{
+public:
+	static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+	/** Default constructor
+	  */
+	SpscQueue() :
+		head(0),
+		padding(),
+		tail(0),
+		items()
+	{
+	}
+
+	/** Add an element to the back of the queue (producer thread only)
+	  * @return True if the element was added and return false if the queue is full
+	  */
+	bool push(const T &item){
+		size_t h = head.load(std::memory_order_relaxed);
+		if(h - tail.load(std::memory_order_acquire) >= N)
+			return false;
+		items[h & (N - 1)] = item;
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	/** Remove an element from the front of the queue (consumer thread only)
+	  * @return True if an element was removed and return false if the queue is empty
+	  */
+	bool pop(T &item){
+		size_t t = tail.load(std::memory_order_relaxed);
+		if(t == head.load(std::memory_order_acquire))
+			return false;
+		item = items[t & (N - 1)];
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	/** Return true if the queue is empty (approximate when called by the producer)
+	  */
+	bool empty() const {
+		return (head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire));
+	}
+
+private:
+	std::atomic<size_t> head; ///< Total number of elements pushed (written by the producer)
+
+	char padding[64]; ///< Keeps the producer and consumer indices on separate cache lines
+
+	std::atomic<size_t> tail; ///< Total number of elements popped (written by the consumer)
+
+	T items[N]; ///< Ring buffer of queued elements
+};
+
+#endif
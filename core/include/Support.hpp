@@ -81,8 +81,9 @@ std::string ucharToStr(const unsigned char &input);
 std::string ushortToStr(const unsigned short &input);
 
 /** Convert input integer to a decimal string
+  * If parameter 'width' is specified, the string will be padded with leading zeros to at least that many digits
   */
-std::string uintToStr(const unsigned int &input);
+std::string uintToStr(const unsigned int &input, const unsigned short &width=0);
 
 /** Convert input floating point to a string
   * If parameter 'fixed' is specified, fixed decimal point will be used
@@ -4,7 +4,10 @@
 #include <vector>
 #include <fstream>
 
+#include "MemoryArena.hpp"
+
 class SystemGBC;
+class SavestateChunk;
 
 class SystemComponent{
 public:
@@ -30,6 +33,7 @@ public:
 		readLoc(0),
 		readBank(0),
 		mem(),
+		dirtyPages(),
 		userValues()
 	{ 
 	}
@@ -57,6 +61,7 @@ public:
 		readLoc(0),
 		readBank(0),
 		mem(),
+		dirtyPages(),
 		userValues()
 	{ 
 	}
@@ -86,7 +91,8 @@ public:
 		writeVal(0),
 		readLoc(0),
 		readBank(0),
-		mem(N, std::vector<unsigned char>(nB, 0x0)),
+		mem(nB, N),
+		dirtyPages((nB*N + 255) / 256, 1),
 		userValues()
 	{
 	}
@@ -108,6 +114,23 @@ public:
 		return false; 
 	}
 
+	/** Method called to advance the component by multiple 1 MHz system clock ticks at once
+	  * Called by the system scheduler when the component's next event is due, or when the component is
+	  * brought up to date before its state is accessed. Calls onClockUpdate() once per tick by default.
+	  * @param nCycles Number of system clock ticks to advance
+	  * @return True if any of the clock ticks triggered additional actions
+	  */
+	virtual bool onClockAdvance(const unsigned int &nCycles);
+
+	/** Get the number of 1 MHz system clock ticks until the next component event
+	  * The system scheduler will not clock the component again until this many ticks have elapsed (unless it is synchronized).
+	  * Returns one by default (i.e. the component is clocked every tick).
+	  * @return The number of ticks until the next event, or zero if the component has no pending events
+	  */
+	virtual unsigned int getCyclesUntilNextEvent(){
+		return 1;
+	}
+
 	/** Set a pointer to the emulator system bus , define associated system registers, and add all savestate input/output values
 	  */
 	void connectSystemBus(SystemGBC *bus);
@@ -273,24 +296,65 @@ public:
 	  */
 	unsigned int readMemoryFromFile(std::ifstream &f);
 
+	/** Copy component RAM contents from a memory buffer
+	  * At most (nBanks * nBytes) bytes are copied.
+	  * @param src Input buffer
+	  * @param length Length of the input buffer (in bytes)
+	  * @return The number of bytes copied
+	  */
+	unsigned int readMemory(const unsigned char *src, const size_t &length);
+
 	/** Write component state to output savestate file
-	  * Peform the following actions
-	  *  Write component header containing length of component RAM and current bank select.
-	  *  writeUserSavestate() is called to write extra state information for derived classes.
-	  *  If bSaveRAM is true, entire component RAM map is written.
+	  * The component state is written as a single savestate chunk (see writeSavestate(unsigned char*)).
 	  * @return The number of bytes written to output stream.
 	  */
 	unsigned int writeSavestate(std::ofstream &f);
 
-	/** Read component state from output savestate file
-	  * Peform the following actions
-	  *  Read component header containing length of component RAM and current bank select.
-	  *  readUserSavestate() is called to read extra state information for derived classes.
-	  *  If bSaveRAM is true, entire component RAM map is read.
-	  * @return The number of bytes read from input stream.
+	/** Read component state from input savestate file
+	  * A single savestate chunk is read from the stream (see readSavestate(const SavestateChunk&)).
+	  * @return The number of bytes read from input stream, or zero if the chunk does not match this component.
 	  */
 	unsigned int readSavestate(std::ifstream &f);
 
+	/** Get the version number of the component savestate layout
+	  * Derived classes should override this whenever the list of savestate values changes.
+	  */
+	virtual unsigned short getSavestateVersion() const {
+		return 1;
+	}
+
+	/** Get the number of bytes written by writeSavestate(), including the chunk header
+	  */
+	unsigned int getSavestateSize() const ;
+
+	/** Write component state to a memory buffer as a savestate chunk
+	  * Peform the following actions
+	  *  Write chunk header containing the component ID, savestate version, and payload length.
+	  *  Write component header containing the geometry of component RAM and current bank select.
+	  *  Write all values added with addSavestateValue().
+	  *  If bSaveRAM is true, entire component RAM map is written.
+	  * @param dest Output buffer with room for at least getSavestateSize() bytes
+	  * @param dirtyOnly If set, only pages of component RAM which were modified since the previous incremental
+	  *                  write are copied and the rest of the buffer is assumed to already hold the previous state.
+	  * @return The number of bytes written to the buffer
+	  */
+	unsigned int writeSavestate(unsigned char *dest, bool dirtyOnly=false);
+
+	/** Check that a savestate chunk was written by this component and matches its current layout
+	  * A warning describing the mismatch is printed if the chunk may not be read.
+	  * @param chunk Savestate chunk, or null if the savestate contains no chunk for this component
+	  * @return True if the chunk may be read by readSavestate(), otherwise return false
+	  */
+	bool checkSavestate(const SavestateChunk *chunk) const ;
+
+	/** Read component state from a savestate chunk
+	  * The payload is read directly from the savestate buffer. Component state is not modified if the chunk
+	  * does not pass checkSavestate().
+	  * @param chunk Savestate chunk written by writeSavestate()
+	  * @return True if the component state was restored, otherwise return false
+	  */
+	bool readSavestate(const SavestateChunk &chunk);
+
 	/** Check that this system component is sensitive to the specified register address
 	  * May be used to prevent certain registers being written to (e.g. if the component is currently powered off).
 	  * Should return true if register may be written to or read from.
@@ -346,11 +410,35 @@ public:
 		return &mem[bank][loc-offset]; 
 	}
 
+	/** Get a pointer to the modified flag of a 256 byte page of component RAM or null pointer if the bank doesn't exist
+	  * The flag must be set whenever the page is written to directly through a pointer.
+	  * @param bank Component RAM bank select number (indexed from zero)
+	  * @param index Byte offset from the beginning of the bank
+	  */
+	unsigned char *getDirtyFlagToBank(const unsigned short &bank, const unsigned short &index=0){ 
+		return (bank < nBanks ? &dirtyPages[(bank * nBytes + index) >> 8] : 0x0); 
+	}
+
+	/** Get the number of 256 byte pages of component RAM which were modified since the last incremental savestate
+	  */
+	unsigned int getNumberOfDirtyPages() const ;
+
+	/** Flag all pages of component RAM as modified
+	  * Should be called whenever the contents of component RAM are replaced.
+	  */
+	void setAllPagesDirty();
+
 	/** Get pointer to the beginning of the specified RAM bank or null pointer if the bank doesn't exist
 	  * @param bank Component RAM bank select number (indexed from zero)
 	  */
 	unsigned char *getPtrToBank(const unsigned short &bank){ 
-		return (bank < nBanks ? mem[bank].data() : 0x0); 
+		return (bank < nBanks ? mem[bank] : 0x0); 
+	}
+
+	/** Get the number of bytes per RAM bank
+	  */
+	unsigned short getBankSize() const { 
+		return nBytes; 
 	}
 
 	/** Get the size of associated component RAM (in bytes)
@@ -372,6 +460,12 @@ public:
 		return sName; 
 	}
 
+	/** Get the 4-byte component identifier
+	  */
+	unsigned int getComponentID() const {
+		return nComponentID;
+	}
+
 	/** Enable or disable debug mode
 	  */ 
 	void setDebugMode(bool state=true){ 
@@ -419,7 +513,9 @@ protected:
 	
 	unsigned short readBank; ///< Bank of memory to be read from
 
-	std::vector<std::vector<unsigned char> > mem; ///< Physical memory
+	MemoryArena mem; ///< Physical memory (all banks stored contiguously)
+
+	std::vector<unsigned char> dirtyPages; ///< Modified flags for each 256 byte page of component RAM, cleared by incremental savestates
 
 	std::vector<std::pair<void*, unsigned int> > userValues;
 
@@ -455,27 +551,65 @@ protected:
 	virtual void userAddSavestateValues(){
 	}
 	
-	/** Write 13 byte component header 
+	/** Write 9 byte component header 
 	  * Perform the following actions
-	  *  Write 4 byte system component identifier number
 	  *  Write 1 byte RAM read-only flag (0xff read-only, 0x0 normal)
 	  *  Write 2 byte RAM memory address offset
 	  *  Write 2 byte RAM bank size (in bytes)
 	  *  Write 2 byte RAM bank number
 	  *  Write 2 byte RAM bank select
 	  */
-	unsigned int writeSavestateHeader(std::ofstream &f);
+	unsigned int writeSavestateHeader(unsigned char *dest);
+};
 
-	/** Read 13 byte component header 
-	  * Perform the following actions
-	  *  Read 4 byte system component identifier number
-	  *  Read 1 byte RAM read-only flag (0xff read-only, 0x0 normal)
-	  *  Read 2 byte RAM memory address offset
-	  *  Read 2 byte RAM bank size (in bytes)
-	  *  Read 2 byte RAM bank number
-	  *  Read 2 byte RAM bank select
-	  */
-	unsigned int readSavestateHeader(std::ifstream &f);
+typedef bool (*registerWriteFunc)(SystemComponent*, const unsigned short&, const unsigned char&);
+typedef bool (*registerReadFunc)(SystemComponent*, const unsigned short&, unsigned char&);
+typedef bool (*registerCheckFunc)(SystemComponent*, const unsigned short&);
+
+class RegisterHandler{
+public:
+	SystemComponent *comp; ///< System component which the handlers are bound to
+
+	registerWriteFunc write; ///< Called after the register is written (or null if writes require no action)
+
+	registerReadFunc read; ///< Called after the register is read (or null if reads require no action)
+
+	registerCheckFunc check; ///< Called before the register is written, the write is ignored if false is returned (or null if always writable)
+
+	/** Default constructor
+	  */
+	RegisterHandler() :
+		comp(0x0),
+		write(0x0),
+		read(0x0),
+		check(0x0)
+	{
+	}
 };
 
+/** Register write handler which calls the virtual writeRegister() method of a system component
+  */
+bool writeRegisterVirtual(SystemComponent *comp, const unsigned short &reg, const unsigned char &val);
+
+/** Register write handler which calls writeRegister() of a derived system component directly (no virtual dispatch)
+  */
+template <class T>
+bool writeComponentRegister(SystemComponent *comp, const unsigned short &reg, const unsigned char &val){
+	return static_cast<T*>(comp)->T::writeRegister(reg, val);
+}
+
+/** Register read handler which calls readRegister() of a derived system component directly (no virtual dispatch)
+  */
+template <class T>
+bool readComponentRegister(SystemComponent *comp, const unsigned short &reg, unsigned char &val){
+	return static_cast<T*>(comp)->T::readRegister(reg, val);
+}
+
+/** Register check handler which calls checkRegister() of a derived system component directly (no virtual dispatch)
+  */
+template <class T>
+bool checkComponentRegister(SystemComponent *comp, const unsigned short &reg){
+	return static_cast<T*>(comp)->T::checkRegister(reg);
+}
+
 #endif
@@ -0,0 +1,81 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+class ThreadPool{
+public:
+	/** Default constructor
+	  * No worker threads are started, all tasks are run by the calling thread.
+	  */
+	ThreadPool();
+
+	/** Worker constructor
+	  * @param N Number of worker threads to start
+	  */
+	ThreadPool(const unsigned int &N);
+
+	/** Destructor
+	  * Stops and joins all worker threads.
+	  */
+	~ThreadPool();
+
+	/** Get the number of worker threads
+	  */
+	unsigned int getNumberOfThreads() const {
+		return (unsigned int)workers.size();
+	}
+
+	/** Stop all worker threads and start a new set of workers
+	  * @param N Number of worker threads to start
+	  */
+	void resize(const unsigned int &N);
+
+	/** Run a task for every index in [0, N) and wait for all of them to finish
+	  * Tasks are divided between the worker threads and the calling thread. Tasks may run in any
+	  * order, so they must not depend on one another.
+	  * @param N Number of tasks
+	  * @param task Function called once for each task index
+	  */
+	void run(const unsigned int &N, const std::function<void(unsigned int)> &task);
+
+private:
+	std::vector<std::thread> workers; ///< Worker threads
+
+	std::mutex lock; ///< Protects all of the job state below
+
+	std::condition_variable jobReady; ///< Signalled when a new job is posted or the pool is stopping
+
+	std::condition_variable jobDone; ///< Signalled when the last task of a job is finished
+
+	const std::function<void(unsigned int)> *currentTask; ///< Function for the current job (or null if there is no job)
+
+	unsigned int nTasks; ///< Number of tasks in the current job
+
+	unsigned int nextTask; ///< Index of the next task to be started
+
+	unsigned int nFinished; ///< Number of tasks in the current job which have finished
+
+	unsigned long long jobNumber; ///< Incremented each time a job is posted
+
+	bool stopping; ///< Set when worker threads should exit
+
+	/** Stop and join all worker threads
+	  */
+	void stop();
+
+	/** Run tasks from the current job until there are none left to start
+	  * Must be called with the lock held. The lock is released while each task runs.
+	  */
+	void runTasks(std::unique_lock<std::mutex> &guard);
+
+	/** Worker thread main loop
+	  */
+	void work();
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <atomic>
+
+/** Lock-free triple buffer for handing data from one producer thread to one consumer thread
+  * The producer always owns the back buffer and the consumer always owns the front buffer. The
+  * third (middle) buffer holds the most recently published data and is swapped atomically, so
+  * neither thread ever waits for the other. Data which is published before the consumer has a
+  * chance to read it is dropped.
+  */
+template <typename T>
+class TripleBuffer{
+public:
+	/** Default constructor
+	  */
+	TripleBuffer() :
+		buffers(),
+		back(0),
+		front(1),
+		middle(2)
+	{
+	}
+
+	/** Initialization constructor
+	  * @param init Initial value copied into all three buffers
+	  */
+	TripleBuffer(const T &init) :
+		buffers{ init, init, init },
+		back(0),
+		front(1),
+		middle(2)
+	{
+	}
+
+	/** Copy a value into all three buffers and discard any unread data
+	  * Not thread safe, must only be called while neither the producer nor the consumer is running.
+	  * @param init Value copied into all three buffers
+	  */
+	void reset(const T &init){
+		for(int i = 0; i < 3; i++)
+			buffers[i] = init;
+		back = 0;
+		front = 1;
+		middle.store(2);
+	}
+
+	/** Get a reference to the back buffer (producer thread only)
+	  */
+	T &getBackBuffer(){
+		return buffers[back];
+	}
+
+	/** Get a const reference to the front buffer (consumer thread only)
+	  */
+	const T &getFrontBuffer() const {
+		return buffers[front];
+	}
+
+	/** Publish the contents of the back buffer and swap it with the middle buffer (producer thread only)
+	  */
+	void publish(){
+		back = middle.exchange(back | NEW_DATA_FLAG, std::memory_order_acq_rel) & INDEX_MASK;
+	}
+
+	/** Swap the front buffer with the middle buffer if new data has been published (consumer thread only)
+	  * @return True if the front buffer was updated and return false otherwise
+	  */
+	bool update(){
+		if((middle.load(std::memory_order_relaxed) & NEW_DATA_FLAG) == 0)
+			return false;
+		front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+		return true;
+	}
+
+private:
+	static constexpr unsigned char INDEX_MASK    = 0x03; ///< Mask for the buffer index of the middle buffer
+	static constexpr unsigned char NEW_DATA_FLAG = 0x04; ///< Set when the middle buffer contains unread data
+
+	T buffers[3]; ///< Back, middle, and front buffers (in no particular order)
+
+	unsigned char back; ///< Index of the buffer owned by the producer
+
+	unsigned char front; ///< Index of the buffer owned by the consumer
+
+	std::atomic<unsigned char> middle; ///< Index of the shared buffer and the new data flag
+};
+
+#endif
@@ -0,0 +1,73 @@
+#include "FrameSkipController.hpp"
+
+// Weight of each new frame in the moving averages of frame work time.
+constexpr double AVERAGE_WEIGHT = 0.125;
+
+// Number of successive frames over the upper threshold before frame-skip is increased.
+constexpr unsigned short FRAMES_BEFORE_INCREASE = 3;
+
+// Number of successive frames under the lower threshold before frame-skip is decreased.
+constexpr unsigned short FRAMES_BEFORE_DECREASE = 60;
+
+FrameSkipController::FrameSkipController() :
+	frameSkip(1),
+	maxFrameSkip(4),
+	framesOver(0),
+	framesUnder(0),
+	upperThreshold(0.95),
+	lowerThreshold(0.8),
+	renderedTime(-1),
+	skippedTime(-1),
+	period(0)
+{
+}
+
+void FrameSkipController::setMaximum(const unsigned short &N){
+	maxFrameSkip = (N > 1 ? N : 1);
+	if(frameSkip > maxFrameSkip)
+		frameSkip = maxFrameSkip;
+}
+
+void FrameSkipController::reset(const unsigned short &N/*=1*/){
+	frameSkip = (N > 1 ? (N < maxFrameSkip ? N : maxFrameSkip) : 1);
+	framesOver = 0;
+	framesUnder = 0;
+	renderedTime = -1;
+	skippedTime = -1;
+}
+
+unsigned short FrameSkipController::update(const double &workTime, const double &framePeriod, bool rendered){
+	period = framePeriod;
+	double &average = (rendered ? renderedTime : skippedTime);
+	if(average < 0) // First frame of this type
+		average = workTime;
+	else
+		average += AVERAGE_WEIGHT * (workTime - average);
+	if(renderedTime < 0) // Wait until at least one rendered frame has been measured
+		return frameSkip;
+	if(skippedTime < 0) // No skipped frames yet, assume skipping a frame saves no time
+		skippedTime = renderedTime;
+
+	// Increase frame-skip if the current load is too high
+	if(getAverageWorkTime(frameSkip) > upperThreshold * period){
+		framesUnder = 0;
+		if(++framesOver >= FRAMES_BEFORE_INCREASE && frameSkip < maxFrameSkip){
+			frameSkip++;
+			framesOver = 0;
+		}
+		return frameSkip;
+	}
+	framesOver = 0;
+
+	// Decrease frame-skip only if the load would remain comfortably low without it
+	if(frameSkip > 1 && getAverageWorkTime(frameSkip - 1) < lowerThreshold * period){
+		if(++framesUnder >= FRAMES_BEFORE_DECREASE){
+			frameSkip--;
+			framesUnder = 0;
+		}
+	}
+	else
+		framesUnder = 0;
+
+	return frameSkip;
+}
@@ -0,0 +1,75 @@
+#include <iostream>
+#include <chrono>
+
+#include "ImageWriter.hpp"
+
+constexpr int WRITER_IDLE_SLEEP_US = 1000; ///< Time the writer thread sleeps when no images are queued (in microseconds)
+
+ImageWriter::ImageWriter() :
+	frames(),
+	freeFrames(),
+	queuedFrames(),
+	thread(),
+	stopRequested(false),
+	nWritten(0),
+	nDropped(0),
+	encoder()
+{
+	for(size_t i = 0; i < MAX_QUEUED_FRAMES; i++)
+		freeFrames.push((unsigned char)i);
+}
+
+ImageWriter::~ImageWriter(){
+	stop();
+}
+
+bool ImageWriter::write(const std::string &fname, const uint32_t *pixels, const int &W, const int &H, bool wait/*=false*/){
+	unsigned char index;
+	while(!freeFrames.pop(index)){ // All frame slots are in use
+		if(!wait || !thread.joinable()){
+			nDropped++;
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::microseconds(WRITER_IDLE_SLEEP_US));
+	}
+	Frame &frame = frames[index];
+	frame.filename = fname;
+	frame.pixels.assign(pixels, pixels + (size_t)W * H);
+	frame.width = W;
+	frame.height = H;
+	queuedFrames.push(index);
+	if(!thread.joinable()){ // Start the writer thread
+		stopRequested.store(false, std::memory_order_release);
+		thread = std::thread(&ImageWriter::run, this);
+	}
+	return true;
+}
+
+void ImageWriter::stop(){
+	if(!thread.joinable())
+		return;
+	stopRequested.store(true, std::memory_order_release);
+	thread.join();
+}
+
+void ImageWriter::run(){
+	unsigned char index;
+	while(true){
+		// Check the stop flag first so that images queued before stop() are always written
+		bool stopping = stopRequested.load(std::memory_order_acquire);
+		if(queuedFrames.pop(index)){
+			Frame &frame = frames[index];
+			if(encoder.write(frame.filename, frame.pixels.data(), frame.width, frame.height))
+				nWritten++;
+			else{
+				std::cout << " Warning! Failed to write image \"" << frame.filename << "\"." << std::endl;
+				nDropped++;
+			}
+			freeFrames.push(index);
+		}
+		else if(stopping)
+			break;
+		else
+			std::this_thread::sleep_for(std::chrono::microseconds(WRITER_IDLE_SLEEP_US));
+	}
+}
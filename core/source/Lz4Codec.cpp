@@ -0,0 +1,257 @@
+#include <cstring>
+#include <algorithm>
+
+#include "Lz4Codec.hpp"
+
+constexpr uint32_t Lz4Codec::MAGIC;
+constexpr size_t Lz4Codec::HEADER_LENGTH;
+
+constexpr size_t MIN_MATCH = 4; ///< Shortest match which may be encoded (in bytes)
+
+constexpr size_t LAST_LITERALS = 5; ///< The last bytes of a block are always literals
+
+constexpr size_t MATCH_FIND_LIMIT = 12; ///< No match may begin within this many bytes of the end of a block
+
+constexpr size_t MAX_OFFSET = 65535; ///< Maximum distance back to the start of a match
+
+constexpr int HASH_LOG = 14; ///< Number of bits in a match table index
+
+constexpr int SKIP_TRIGGER = 6; ///< Search step grows by one after every 2^SKIP_TRIGGER failed matches
+
+constexpr size_t WILD_COPY_LENGTH = 16; ///< Matches are copied in blocks of this many bytes when there is room
+
+constexpr unsigned char RUN_MASK = 0x0F; ///< Largest length which fits in one half of a sequence token
+
+/** Read an unaligned 32-bit value
+  */
+static inline uint32_t read32(const unsigned char *src){
+	uint32_t value;
+	memcpy(&value, src, 4);
+	return value;
+}
+
+/** Read an unaligned 64-bit value
+  */
+static inline uint64_t read64(const unsigned char *src){
+	uint64_t value;
+	memcpy(&value, src, 8);
+	return value;
+}
+
+/** Get the match table index of a four byte sequence
+  */
+static inline uint32_t hashSequence(const uint32_t &sequence){
+	return (sequence * 2654435761U) >> (32 - HASH_LOG);
+}
+
+/** Write a sequence length which did not fit in the sequence token (255 is added until the remainder fits)
+  */
+static inline unsigned char *writeLength(unsigned char *dest, size_t length){
+	while(length >= 255){
+		*dest++ = 255;
+		length -= 255;
+	}
+	*dest++ = (unsigned char)length;
+	return dest;
+}
+
+/** Read a sequence length which did not fit in the sequence token
+  * @return False if the input ends before the length does
+  */
+static inline bool readLength(const unsigned char *&src, const unsigned char *end, size_t &length){
+	unsigned char byte;
+	do{
+		if(src >= end)
+			return false;
+		byte = *src++;
+		length += byte;
+	} while(byte == 255);
+	return true;
+}
+
+/** Write the literals of a sequence and return a pointer to its token
+  */
+static inline unsigned char *writeLiterals(unsigned char *&dest, const unsigned char *src, const size_t &length){
+	unsigned char *token = dest++;
+	if(length >= RUN_MASK){
+		*token = RUN_MASK << 4;
+		dest = writeLength(dest, length - RUN_MASK);
+	}
+	else
+		*token = (unsigned char)(length << 4);
+	if(length)
+		memcpy(dest, src, length);
+	dest += length;
+	return token;
+}
+
+Lz4Codec::Lz4Codec() :
+	hashTable(1 << HASH_LOG, 0)
+{
+}
+
+bool Lz4Codec::isCompressed(const unsigned char *src, const size_t &length){
+	return (length >= HEADER_LENGTH && read32(src) == MAGIC);
+}
+
+size_t Lz4Codec::compress(const unsigned char *src, const size_t &length, std::vector<unsigned char> &dest){
+	dest.resize(HEADER_LENGTH + getMaxCompressedLength(length));
+	uint32_t magic = MAGIC;
+	uint32_t uncompressedLength = (uint32_t)length;
+	memcpy(&dest[0], &magic, 4);
+	memcpy(&dest[4], &uncompressedLength, 4);
+	size_t compressedLength = HEADER_LENGTH + compressBlock(src, length, &dest[HEADER_LENGTH]);
+	dest.resize(compressedLength);
+	return compressedLength;
+}
+
+bool Lz4Codec::decompress(const unsigned char *src, const size_t &length, std::vector<unsigned char> &dest){
+	if(!isCompressed(src, length))
+		return false;
+	uint32_t uncompressedLength;
+	memcpy(&uncompressedLength, &src[4], 4);
+	if(uncompressedLength > (length - HEADER_LENGTH) * 255) // Larger than any block of this length can expand to
+		return false;
+	dest.resize(uncompressedLength);
+	return decompressBlock(&src[HEADER_LENGTH], length - HEADER_LENGTH, dest.data(), dest.size());
+}
+
+size_t Lz4Codec::compressBlock(const unsigned char *src, const size_t &length, unsigned char *dest){
+	unsigned char *op = dest;
+	size_t anchor = 0; // Start of the pending literals
+	if(length > MATCH_FIND_LIMIT){
+		std::fill(hashTable.begin(), hashTable.end(), 0); // Stale positions are rejected when the bytes are compared
+		const size_t matchFindLimit = length - MATCH_FIND_LIMIT;
+		const size_t matchLimit = length - LAST_LITERALS;
+		size_t ip = 1;
+		hashTable[hashSequence(read32(src))] = 0;
+		while(ip <= matchFindLimit){
+			// Search for a match, stepping further ahead the longer the search fails
+			size_t match = 0;
+			size_t step = 1;
+			unsigned int nAttempts = 1 << SKIP_TRIGGER;
+			bool found = false;
+			while(ip <= matchFindLimit){
+				uint32_t sequence = read32(&src[ip]);
+				uint32_t &entry = hashTable[hashSequence(sequence)];
+				match = entry;
+				entry = (uint32_t)ip;
+				if(ip - match <= MAX_OFFSET && read32(&src[match]) == sequence){
+					found = true;
+					break;
+				}
+				ip += step;
+				step = (nAttempts++ >> SKIP_TRIGGER);
+			}
+			if(!found)
+				break;
+
+			// Extend the match backwards into the pending literals
+			while(ip > anchor && match > 0 && src[ip - 1] == src[match - 1]){
+				ip--;
+				match--;
+			}
+			unsigned char *token = writeLiterals(op, &src[anchor], ip - anchor);
+
+			while(true){
+				// Match offset
+				size_t offset = ip - match;
+				*op++ = offset & 0xFF;
+				*op++ = (offset >> 8) & 0xFF;
+
+				// Extend the match forwards, eight bytes at a time where possible
+				size_t start = ip;
+				ip += MIN_MATCH;
+				match += MIN_MATCH;
+				while(ip + 8 <= matchLimit && read64(&src[ip]) == read64(&src[match])){
+					ip += 8;
+					match += 8;
+				}
+				while(ip < matchLimit && src[ip] == src[match]){
+					ip++;
+					match++;
+				}
+				size_t matchLength = ip - start - MIN_MATCH;
+				if(matchLength >= RUN_MASK){
+					*token |= RUN_MASK;
+					op = writeLength(op, matchLength - RUN_MASK);
+				}
+				else
+					*token |= (unsigned char)matchLength;
+				anchor = ip;
+				if(ip > matchFindLimit)
+					break;
+
+				// Check for a second match immediately following the first
+				hashTable[hashSequence(read32(&src[ip - 2]))] = (uint32_t)(ip - 2);
+				uint32_t &entry = hashTable[hashSequence(read32(&src[ip]))];
+				match = entry;
+				entry = (uint32_t)ip;
+				if(ip - match > MAX_OFFSET || read32(&src[match]) != read32(&src[ip]))
+					break;
+				token = op++;
+				*token = 0;
+			}
+			ip++;
+		}
+	}
+
+	// Remaining input is written as literals
+	writeLiterals(op, &src[anchor], length - anchor);
+	return (size_t)(op - dest);
+}
+
+bool Lz4Codec::decompressBlock(const unsigned char *src, const size_t &length, unsigned char *dest, const size_t &destLength){
+	const unsigned char *ip = src;
+	const unsigned char *const iend = src + length;
+	unsigned char *op = dest;
+	unsigned char *const oend = dest + destLength;
+	while(ip < iend){
+		unsigned char token = *ip++;
+
+		// Literals
+		size_t literalLength = token >> 4;
+		if(literalLength == RUN_MASK && !readLength(ip, iend, literalLength))
+			return false;
+		if(literalLength > (size_t)(iend - ip) || literalLength > (size_t)(oend - op))
+			return false;
+		if(literalLength <= WILD_COPY_LENGTH && (size_t)(iend - ip) >= WILD_COPY_LENGTH && (size_t)(oend - op) >= WILD_COPY_LENGTH) // Short literals, copy a fixed length
+			memcpy(op, ip, WILD_COPY_LENGTH);
+		else if(literalLength)
+			memcpy(op, ip, literalLength);
+		ip += literalLength;
+		op += literalLength;
+		if(ip == iend) // The last sequence has no match
+			break;
+
+		// Match
+		if(iend - ip < 2)
+			return false;
+		size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if(offset == 0 || offset > (size_t)(op - dest))
+			return false;
+		size_t matchLength = token & RUN_MASK;
+		if(matchLength == RUN_MASK && !readLength(ip, iend, matchLength))
+			return false;
+		matchLength += MIN_MATCH;
+		if(matchLength > (size_t)(oend - op))
+			return false;
+		const unsigned char *match = op - offset;
+		size_t distance = offset;
+		size_t i = 0;
+		if(offset < WILD_COPY_LENGTH){ // Any multiple of the offset repeats the same pattern, widen it to a whole block
+			while(distance < WILD_COPY_LENGTH)
+				distance += offset;
+			for(; i < std::min(distance, matchLength); i++)
+				op[i] = match[i];
+		}
+		const size_t room = (size_t)(oend - op);
+		for(; i < matchLength && i + WILD_COPY_LENGTH <= room; i += WILD_COPY_LENGTH) // Whole blocks, may copy past the end of the match
+			memcpy(&op[i], &op[i - distance], WILD_COPY_LENGTH);
+		for(; i < matchLength; i++) // Remainder near the end of the output
+			op[i] = op[i - distance];
+		op += matchLength;
+	}
+	return (op == oend);
+}
@@ -0,0 +1,40 @@
+#include <cstdint>
+#include <cstring>
+
+#include "MemoryArena.hpp"
+
+constexpr std::uintptr_t CACHE_LINE_SIZE = 64; // Bytes
+
+MemoryArena::MemoryArena(const MemoryArena &other) :
+	MemoryArena()
+{
+	(*this) = other;
+}
+
+MemoryArena &MemoryArena::operator = (const MemoryArena &other){
+	if(this == &other)
+		return (*this);
+	allocate(other.nBytesPerBank, other.nBanks);
+	if(!empty())
+		std::memcpy(base, other.base, size());
+	return (*this);
+}
+
+void MemoryArena::allocate(const unsigned short &nB, const unsigned short &N){
+	clear();
+	if(!nB || !N)
+		return;
+	nBytesPerBank = nB;
+	nBanks = N;
+	storage.assign(size() + CACHE_LINE_SIZE - 1, 0x0);
+	std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(storage.data());
+	base = storage.data() + ((CACHE_LINE_SIZE - (addr % CACHE_LINE_SIZE)) % CACHE_LINE_SIZE);
+}
+
+void MemoryArena::clear(){
+	storage.clear();
+	storage.shrink_to_fit();
+	nBytesPerBank = 0;
+	nBanks = 0;
+	base = 0x0;
+}
@@ -155,7 +155,7 @@ bool OpcodeData::clock(LR35902 *cpu){
 	if(nCycles == nReadCycle)
 		cpu->readMemory();
 	if(nCycles == nExecuteCycle){
-		(cpu->*op->ptr)();
+		cpu->executeInstruction(*this);
 		retval = true;
 	}
 	if(nCycles == nWriteCycle)
@@ -314,12 +314,12 @@ bool OpcodeHandler::findOpcode(const std::string& mnemonic, OpcodeData& data) {
 	bool foundMatch = false;
 	for (unsigned short i = 0; i < 256; i++) {
 		if (opcodes[i].check(args.front(), type, operand1, operand2)) {
-			data.set(&opcodes[i]);
+			data.set(opcodes, (unsigned char)i, 0);
 			foundMatch = true;
 			break;
 		}
 		else if (opcodesCB[i].check(args.front(), type, operand1, operand2)) {
-			data.set(&opcodesCB[i]);
+			data.setCB(opcodesCB, (unsigned char)i, 0);
 			foundMatch = true;
 			break;
 		}
@@ -0,0 +1,139 @@
+#include <fstream>
+#include <algorithm>
+
+#include "PngEncoder.hpp"
+
+// Maximum number of bytes in a stored (uncompressed) deflate block.
+constexpr size_t MAX_STORED_BLOCK_LENGTH = 65535;
+
+// Number of bytes which may be summed before the Adler-32 sums must be reduced modulo 65521.
+constexpr size_t ADLER_BLOCK_LENGTH = 5552;
+
+constexpr uint32_t ADLER_MODULUS = 65521;
+
+const unsigned char PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+PngEncoder::PngEncoder() :
+	scanlines(),
+	output(),
+	crcTable()
+{
+	for(uint32_t i = 0; i < 256; i++){
+		uint32_t c = i;
+		for(int k = 0; k < 8; k++)
+			c = (c & 1 ? 0xEDB88320 ^ (c >> 1) : c >> 1);
+		crcTable[i] = c;
+	}
+}
+
+const std::vector<unsigned char> &PngEncoder::encode(const uint32_t *pixels, const int &W, const int &H){
+	// Raw image data, each row is preceded by its filter type (0 = none)
+	const size_t rowLength = 1 + 3 * (size_t)W;
+	scanlines.resize(rowLength * H);
+	const unsigned char *src = reinterpret_cast<const unsigned char *>(pixels);
+	unsigned char *dest = scanlines.data();
+	for(int y = 0; y < H; y++){
+		*dest++ = 0;
+		for(int x = 0; x < W; x++){
+			dest[0] = src[0];
+			dest[1] = src[1];
+			dest[2] = src[2];
+			dest += 3;
+			src += 4;
+		}
+	}
+
+	// zlib stream made of stored deflate blocks
+	const size_t nBlocks = (scanlines.empty() ? 1 : (scanlines.size() + MAX_STORED_BLOCK_LENGTH - 1) / MAX_STORED_BLOCK_LENGTH);
+	const size_t streamLength = 2 + 5 * nBlocks + scanlines.size() + 4;
+
+	output.clear();
+	output.reserve(8 + 25 + 12 + streamLength + 12);
+	output.insert(output.end(), PNG_SIGNATURE, PNG_SIGNATURE + 8);
+
+	// Image header (8-bit RGB, no interlacing)
+	size_t start = beginChunk(13, "IHDR");
+	appendUInt((uint32_t)W);
+	appendUInt((uint32_t)H);
+	output.push_back(8); // Bit depth
+	output.push_back(2); // Color type (RGB)
+	output.push_back(0); // Compression method (deflate)
+	output.push_back(0); // Filter method
+	output.push_back(0); // Interlace method (none)
+	endChunk(start);
+
+	// Image data
+	start = beginChunk((uint32_t)streamLength, "IDAT");
+	output.push_back(0x78); // Deflate with 32 kB window
+	output.push_back(0x01); // No preset dictionary, fastest compression (header is a multiple of 31)
+	size_t offset = 0;
+	for(size_t i = 0; i < nBlocks; i++){
+		size_t length = std::min(MAX_STORED_BLOCK_LENGTH, scanlines.size() - offset);
+		output.push_back(i + 1 == nBlocks ? 0x01 : 0x00); // Final block flag and block type (stored)
+		output.push_back(length & 0xFF);
+		output.push_back((length >> 8) & 0xFF);
+		output.push_back(~length & 0xFF);
+		output.push_back((~length >> 8) & 0xFF);
+		output.insert(output.end(), scanlines.begin() + offset, scanlines.begin() + offset + length);
+		offset += length;
+	}
+	appendUInt(adler32(scanlines.data(), scanlines.size()));
+	endChunk(start);
+
+	// End of image
+	start = beginChunk(0, "IEND");
+	endChunk(start);
+
+	return output;
+}
+
+bool PngEncoder::write(const std::string &fname, const uint32_t *pixels, const int &W, const int &H){
+	std::ofstream ofile(fname.c_str(), std::ios::binary);
+	if(!ofile.good())
+		return false;
+	encode(pixels, W, H);
+	ofile.write(reinterpret_cast<const char *>(output.data()), output.size());
+	return ofile.good();
+}
+
+void PngEncoder::appendUInt(const uint32_t &value){
+	output.push_back((value >> 24) & 0xFF);
+	output.push_back((value >> 16) & 0xFF);
+	output.push_back((value >> 8) & 0xFF);
+	output.push_back(value & 0xFF);
+}
+
+size_t PngEncoder::beginChunk(const uint32_t &length, const char *type){
+	appendUInt(length);
+	size_t start = output.size();
+	output.insert(output.end(), type, type + 4);
+	return start;
+}
+
+void PngEncoder::endChunk(const size_t &start){
+	appendUInt(crc32(&output[start], output.size() - start));
+}
+
+uint32_t PngEncoder::crc32(const unsigned char *data, const size_t &length) const {
+	uint32_t c = 0xFFFFFFFF;
+	for(size_t i = 0; i < length; i++)
+		c = crcTable[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+	return c ^ 0xFFFFFFFF;
+}
+
+uint32_t PngEncoder::adler32(const unsigned char *data, const size_t &length){
+	uint32_t a = 1;
+	uint32_t b = 0;
+	size_t remaining = length;
+	while(remaining > 0){
+		size_t n = std::min(remaining, ADLER_BLOCK_LENGTH);
+		remaining -= n;
+		while(n--){
+			a += *data++;
+			b += a;
+		}
+		a %= ADLER_MODULUS;
+		b %= ADLER_MODULUS;
+	}
+	return (b << 16) | a;
+}
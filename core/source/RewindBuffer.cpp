@@ -0,0 +1,188 @@
+#include <cstring>
+#include <cstdint>
+
+#include "RewindBuffer.hpp"
+
+// Runs of identical bytes shorter than this are stored as literals, since the run would cost more to encode.
+constexpr size_t MIN_ZERO_RUN = 4;
+
+/** Write a variable length (7 bits per byte) unsigned integer
+  */
+static unsigned char *writeVarInt(unsigned char *dest, size_t value){
+	while(value >= 0x80){
+		*dest++ = (unsigned char)(value | 0x80);
+		value >>= 7;
+	}
+	*dest++ = (unsigned char)value;
+	return dest;
+}
+
+/** Read a variable length (7 bits per byte) unsigned integer
+  */
+static const unsigned char *readVarInt(const unsigned char *src, size_t &value){
+	value = 0;
+	int shift = 0;
+	while(*src & 0x80){
+		value |= (size_t)(*src++ & 0x7F) << shift;
+		shift += 7;
+	}
+	value |= (size_t)(*src++) << shift;
+	return src;
+}
+
+RewindBuffer::RewindBuffer(const size_t &capacity/*=0x800000*/) :
+	storage(capacity),
+	latest(),
+	scratch(),
+	packed(),
+	codec(),
+	deltas()
+{
+}
+
+size_t RewindBuffer::getBytesUsed() const {
+	size_t nBytes = 0;
+	for(auto delta = deltas.cbegin(); delta != deltas.cend(); delta++)
+		nBytes += delta->length;
+	return nBytes;
+}
+
+void RewindBuffer::clear(){
+	latest.clear();
+	deltas.clear();
+}
+
+void RewindBuffer::push(const std::vector<unsigned char> &state){
+	if(latest.empty() || latest.size() != state.size()){ // Nothing to compare against
+		clear();
+		latest = state;
+		return;
+	}
+	size_t encodedLength = encode(state.data(), latest.data(), state.size());
+	if(encodedLength == 0){ // States are identical, record an empty difference without allocating storage
+		deltas.push_back(Delta{ getHead(), 0, 0 });
+		return;
+	}
+	packed.resize(Lz4Codec::getMaxCompressedLength(encodedLength));
+	size_t packedLength = codec.compressBlock(scratch.data(), encodedLength, packed.data());
+	bool usePacked = (packedLength < encodedLength);
+	size_t length = (usePacked ? packedLength : encodedLength);
+	size_t offset = allocate(length);
+	if(offset < storage.size()){
+		memcpy(&storage[offset], (usePacked ? packed.data() : scratch.data()), length);
+		deltas.push_back(Delta{ offset, length, (usePacked ? encodedLength : 0) });
+	}
+	else // Difference is larger than the entire buffer, older states can no longer be recovered
+		deltas.clear();
+	latest.assign(state.begin(), state.end());
+}
+
+bool RewindBuffer::pop(std::vector<unsigned char> &state){
+	if(latest.empty())
+		return false;
+	state.assign(latest.begin(), latest.end());
+	if(!deltas.empty()) // Recover the previous state
+		popDelta();
+	else
+		latest.clear();
+	return true;
+}
+
+size_t RewindBuffer::encode(const unsigned char *current, const unsigned char *previous, const size_t &length){
+	// Worst case is one token (two varints) for every MIN_ZERO_RUN+1 bytes
+	scratch.resize(3 * length + 32);
+	unsigned char *dest = scratch.data();
+	size_t i = 0;
+	while(i < length){
+		// Skip identical bytes, eight at a time where possible
+		size_t runStart = i;
+		uint64_t a, b;
+		while(i + 8 <= length){
+			memcpy(&a, &current[i], 8);
+			memcpy(&b, &previous[i], 8);
+			if(a != b)
+				break;
+			i += 8;
+		}
+		while(i < length && current[i] == previous[i])
+			i++;
+		if(i == length) // Trailing identical bytes are implied
+			break;
+		size_t nZeros = i - runStart;
+
+		// Differing bytes, up to the next long run of identical bytes
+		size_t literalStart = i;
+		size_t nEqual = 0;
+		while(i < length){
+			if(current[i] == previous[i]){
+				if(++nEqual >= MIN_ZERO_RUN)
+					break;
+			}
+			else
+				nEqual = 0;
+			i++;
+		}
+		size_t literalEnd = (i < length ? i + 1 - nEqual : i - nEqual);
+		i = literalEnd;
+
+		dest = writeVarInt(dest, nZeros);
+		dest = writeVarInt(dest, literalEnd - literalStart);
+		for(size_t j = literalStart; j < literalEnd; j++)
+			*dest++ = current[j] ^ previous[j];
+	}
+	return (size_t)(dest - scratch.data());
+}
+
+void RewindBuffer::decode(const unsigned char *src, const size_t &length){
+	const unsigned char *end = src + length;
+	unsigned char *dest = latest.data();
+	size_t nZeros, nLiterals;
+	while(src < end){
+		src = readVarInt(src, nZeros);
+		src = readVarInt(src, nLiterals);
+		dest += nZeros;
+		for(size_t j = 0; j < nLiterals; j++)
+			*dest++ ^= *src++;
+	}
+}
+
+void RewindBuffer::popDelta(){
+	const Delta &delta = deltas.back();
+	if(delta.encodedLength){ // Undo LZ4 compression first
+		scratch.resize(delta.encodedLength);
+		if(!Lz4Codec::decompressBlock(&storage[delta.offset], delta.length, scratch.data(), delta.encodedLength)){
+			clear(); // Difference was written by this buffer, so this should never happen
+			return;
+		}
+		decode(scratch.data(), delta.encodedLength);
+	}
+	else
+		decode(&storage[delta.offset], delta.length);
+	deltas.pop_back();
+}
+
+size_t RewindBuffer::getHead() const {
+	return (deltas.empty() ? 0 : deltas.back().offset + deltas.back().length);
+}
+
+size_t RewindBuffer::allocate(const size_t &length){
+	if(length > storage.size())
+		return storage.size();
+	size_t head = getHead();
+	bool wrapped = false;
+	if(head + length > storage.size()){ // Not enough room at the end of the buffer, wrap around to the start
+		wrapped = true;
+		head = 0;
+	}
+	size_t oldHead = getHead();
+	while(!deltas.empty()){
+		const Delta &oldest = deltas.front();
+		if(wrapped && oldest.offset >= oldHead) // Oldest differences at the end of the buffer are discarded first
+			deltas.pop_front();
+		else if(oldest.offset < head + length && (oldest.offset >= head || oldest.offset + oldest.length > head)) // Overlaps the new difference (empty differences included)
+			deltas.pop_front();
+		else
+			break;
+	}
+	return head;
+}
@@ -0,0 +1,89 @@
+#include <cstring>
+
+#include "SavestateReader.hpp"
+
+/** Write a little-endian 16-bit unsigned integer
+  */
+static void writeUShort(unsigned char *dest, const unsigned short &value){
+	dest[0] = value & 0xFF;
+	dest[1] = (value >> 8) & 0xFF;
+}
+
+/** Write a little-endian 32-bit unsigned integer
+  */
+static void writeUInt(unsigned char *dest, const unsigned int &value){
+	for(int i = 0; i < 4; i++)
+		dest[i] = (value >> (8 * i)) & 0xFF;
+}
+
+/** Read a little-endian 16-bit unsigned integer
+  */
+static unsigned short readUShort(const unsigned char *src){
+	return (unsigned short)(src[0] | (src[1] << 8));
+}
+
+/** Read a little-endian 32-bit unsigned integer
+  */
+static unsigned int readUInt(const unsigned char *src){
+	return (unsigned int)src[0] | ((unsigned int)src[1] << 8) | ((unsigned int)src[2] << 16) | ((unsigned int)src[3] << 24);
+}
+
+std::string SavestateChunk::getName() const {
+	std::string name(4, ' ');
+	for(int i = 0; i < 4; i++){
+		char c = (char)((id >> (8 * i)) & 0xFF);
+		name[i] = (c >= 0x20 && c < 0x7F ? c : '?');
+	}
+	return name;
+}
+
+bool SavestateChunk::read(const unsigned char *src, const size_t &length){
+	if(length < SAVESTATE_CHUNK_HEADER_LENGTH) // Truncated chunk header
+		return false;
+	id = readUInt(&src[0]);
+	version = readUShort(&src[4]);
+	this->length = readUInt(&src[6]);
+	payload = &src[SAVESTATE_CHUNK_HEADER_LENGTH];
+	return (this->length <= length - SAVESTATE_CHUNK_HEADER_LENGTH); // Payload may be truncated
+}
+
+unsigned int SavestateChunk::writeHeader(unsigned char *dest, const unsigned int &id, const unsigned short &version, const unsigned int &length){
+	writeUInt(&dest[0], id);
+	writeUShort(&dest[4], version);
+	writeUInt(&dest[6], length);
+	return SAVESTATE_CHUNK_HEADER_LENGTH;
+}
+
+bool SavestateReader::open(const unsigned char *state, const size_t &length){
+	version = 0;
+	title = 0x0;
+	chunks.clear();
+	if(length < SAVESTATE_HEADER_LENGTH || readUInt(state) != SAVESTATE_MAGIC) // Not a savestate
+		return false;
+	version = readUShort(&state[4]);
+	title = &state[6];
+	size_t offset = SAVESTATE_HEADER_LENGTH;
+	while(offset < length){
+		SavestateChunk chunk;
+		if(!chunk.read(&state[offset], length - offset))
+			return false;
+		chunks.push_back(chunk);
+		offset += SAVESTATE_CHUNK_HEADER_LENGTH + chunk.length;
+	}
+	return true;
+}
+
+const SavestateChunk *SavestateReader::find(const unsigned int &id) const {
+	for(auto chunk = chunks.cbegin(); chunk != chunks.cend(); chunk++){
+		if(chunk->id == id)
+			return &(*chunk);
+	}
+	return 0x0;
+}
+
+unsigned int SavestateReader::writeHeader(unsigned char *dest, const unsigned short &version, const char *title){
+	writeUInt(&dest[0], SAVESTATE_MAGIC);
+	writeUShort(&dest[4], version);
+	memcpy(&dest[6], title, 12);
+	return SAVESTATE_HEADER_LENGTH;
+}
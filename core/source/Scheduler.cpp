@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <functional>
+
+#include "SystemComponent.hpp"
+#include "Scheduler.hpp"
+
+constexpr unsigned long long NO_PENDING_EVENT = 0xFFFFFFFFFFFFFFFFULL;
+
+Scheduler::ScheduleEntry::ScheduleEntry(SystemComponent *ptr, const unsigned long long &cycle) :
+	comp(ptr),
+	nLastSync(cycle),
+	nDeadline(NO_PENDING_EVENT)
+{
+}
+
+Scheduler::Scheduler() :
+	nCurrentCycle(0),
+	nNextEvent(NO_PENDING_EVENT),
+	components(),
+	events()
+{
+}
+
+void Scheduler::add(SystemComponent *comp){
+	components.push_back(ScheduleEntry(comp, nCurrentCycle));
+	schedule(components.size() - 1);
+}
+
+bool Scheduler::advance(const unsigned int &nCycles){
+	const unsigned long long nTarget = nCurrentCycle + nCycles;
+	bool retval = false;
+	while(nNextEvent <= nTarget){ // Step through all events in order
+		nCurrentCycle = (nNextEvent > nCurrentCycle ? nNextEvent : nCurrentCycle);
+		if(dispatch())
+			retval = true;
+	}
+	nCurrentCycle = nTarget;
+	return retval;
+}
+
+void Scheduler::sync(){
+	for(auto entry = components.begin(); entry != components.end(); entry++)
+		syncComponent(*entry);
+}
+
+void Scheduler::reschedule(){
+	for(unsigned int i = 0; i < components.size(); i++)
+		schedule(i);
+}
+
+bool Scheduler::dispatch(){
+	bool retval = false;
+	while(!events.empty() && events.front().nCycle <= nCurrentCycle){
+		ScheduledEvent evt = events.front();
+		std::pop_heap(events.begin(), events.end(), std::greater<ScheduledEvent>());
+		events.pop_back();
+		ScheduleEntry &entry = components[evt.nIndex];
+		if(evt.nCycle != entry.nDeadline) // Stale event, component was rescheduled
+			continue;
+		entry.nDeadline = NO_PENDING_EVENT;
+		syncComponent(entry); // Clock the component up to (and including) the event
+		schedule(evt.nIndex);
+		retval = true;
+	}
+	nNextEvent = (!events.empty() ? events.front().nCycle : NO_PENDING_EVENT);
+	return retval;
+}
+
+void Scheduler::syncComponent(ScheduleEntry &entry){
+	if(entry.nLastSync >= nCurrentCycle)
+		return;
+	entry.comp->onClockAdvance((unsigned int)(nCurrentCycle - entry.nLastSync));
+	entry.nLastSync = nCurrentCycle;
+}
+
+void Scheduler::schedule(const unsigned int &index){
+	ScheduleEntry &entry = components[index];
+	unsigned int nCycles = entry.comp->getCyclesUntilNextEvent();
+	unsigned long long nDeadline = (nCycles != 0 ? entry.nLastSync + nCycles : NO_PENDING_EVENT);
+	if(nDeadline == entry.nDeadline) // Nothing to do
+		return;
+	if(events.size() >= 4 * components.size()) // Too many stale events
+		rebuild();
+	entry.nDeadline = nDeadline;
+	if(nDeadline != NO_PENDING_EVENT){
+		events.push_back(ScheduledEvent(nDeadline, index));
+		std::push_heap(events.begin(), events.end(), std::greater<ScheduledEvent>());
+	}
+	nNextEvent = (!events.empty() ? events.front().nCycle : NO_PENDING_EVENT);
+}
+
+void Scheduler::rebuild(){
+	events.clear();
+	for(unsigned int i = 0; i < components.size(); i++){
+		if(components[i].nDeadline != NO_PENDING_EVENT)
+			events.push_back(ScheduledEvent(components[i].nDeadline, i));
+	}
+	std::make_heap(events.begin(), events.end(), std::greater<ScheduledEvent>());
+}
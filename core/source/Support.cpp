@@ -1,5 +1,6 @@
 
 #include <sstream>
+#include <iomanip>
 
 #include "Support.hpp"
 
@@ -163,8 +164,10 @@ std::string ushortToStr(const unsigned short &input){
 	return stream.str();
 }
 
-std::string uintToStr(const unsigned int &input){
+std::string uintToStr(const unsigned int &input, const unsigned short &width/*=0*/){
 	std::stringstream stream;
+	if(width != 0)
+		stream << std::setw(width) << std::setfill('0');
 	stream << input;
 	return stream.str();
 }
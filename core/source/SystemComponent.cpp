@@ -1,8 +1,15 @@
 #include <iostream>
+#include <cstring>
+#include <algorithm>
 
 #include "Support.hpp"
+#include "SavestateReader.hpp"
 #include "SystemComponent.hpp"
 
+bool writeRegisterVirtual(SystemComponent *comp, const unsigned short &reg, const unsigned char &val){
+	return comp->writeRegister(reg, val);
+}
+
 void SystemComponent::connectSystemBus(SystemGBC *bus){ 
 	sys = bus; 
 	this->defineRegisters();
@@ -10,17 +17,27 @@ void SystemComponent::connectSystemBus(SystemGBC *bus){
 }
 
 void SystemComponent::initialize(const unsigned short &nB, const unsigned short &N/*=1*/){
-	mem = std::vector<std::vector<unsigned char> >(N, std::vector<unsigned char>(nB, 0x0));
+	mem.allocate(nB, N);
 	nBytes = nB;
 	nBanks = N;
 	bs = 0;
 	size = nB*N;
+	dirtyPages.assign((size + 255) / 256, 1);
 }
 
 SystemComponent::~SystemComponent(){
 	mem.clear();
 }
 
+bool SystemComponent::onClockAdvance(const unsigned int &nCycles){
+	bool retval = false;
+	for(unsigned int i = 0; i < nCycles; i++){
+		if(this->onClockUpdate())
+			retval = true;
+	}
+	return retval;
+}
+
 bool SystemComponent::write(const unsigned short &loc, const unsigned char *src){ 
 	return write(loc, bs, (*src));
 }
@@ -48,6 +65,7 @@ bool SystemComponent::write(const unsigned short &loc, const unsigned short &ban
 	}
 #endif // ifdef USE_QT_DEBUGGER
 	mem[writeBank][writeLoc-offset] = writeVal;
+	dirtyPages[(writeBank * nBytes + (writeLoc - offset)) >> 8] = 1;
 	return true;		
 }	
 
@@ -55,12 +73,14 @@ void SystemComponent::writeFast(const unsigned short &loc, const unsigned char &
 	if(readOnly)
 		return;
 	mem[bs][loc-offset] = src;
+	dirtyPages[(bs * nBytes + (loc - offset)) >> 8] = 1;
 }
 
 void SystemComponent::writeFastBank0(const unsigned short &loc, const unsigned char &src){
 	if(readOnly)
 		return;
 	mem[0][loc-offset] = src;
+	dirtyPages[(loc - offset) >> 8] = 1;
 }
 
 bool SystemComponent::read(const unsigned short &loc, unsigned char *dest){
@@ -107,13 +127,8 @@ unsigned int SystemComponent::writeMemoryToFile(std::ofstream &f){
 	if(!size)
 		return 0;
 
-	// Write memory contents to the output file.	
-	/*unsigned int nWritten = 0;	
-	for(unsigned short i = 0; i < nBanks; i++){
-		f.write((char*)&mem[i][0], nBytes);
-		nWritten += nBytes;
-	}*/
-	f.write((char*)&mem[0][0], size);
+	// Write memory contents to the output file (all banks are contiguous).
+	f.write((char*)mem.data(), size);
 
 	return size;
 }
@@ -122,74 +137,149 @@ unsigned int SystemComponent::readMemoryFromFile(std::ifstream &f){
 	if(!size)
 		return 0;
 
-	// Write memory contents to the output file.
-	/*unsigned int nRead = 0;	
-	for(unsigned short i = 0; i < nBanks; i++){
-		f.read((char*)&mem[i][0], nBytes);
-		if(f.eof() || !f.good())
-			return nRead;
-		nRead += nBytes;
-	}*/
-	f.read((char*)&mem[0][0], size);
+	// Read memory contents from the input file (all banks are contiguous).
+	f.read((char*)mem.data(), size);
+	setAllPagesDirty();
 
 	return size;
 }
 
+unsigned int SystemComponent::readMemory(const unsigned char *src, const size_t &length){
+	unsigned int nBytesCopied = (unsigned int)std::min(length, (size_t)size);
+	if(!nBytesCopied)
+		return 0;
+
+	// Copy memory contents (all banks are contiguous).
+	memcpy(mem.data(), src, nBytesCopied);
+	setAllPagesDirty();
+
+	return nBytesCopied;
+}
+
 unsigned int SystemComponent::writeSavestate(std::ofstream &f){
-	unsigned int nWritten = 0; 
-	nWritten += writeSavestateHeader(f); // Write the component header
-	for(auto val = userValues.cbegin(); val != userValues.cend(); val++){
-		f.write(static_cast<char*>(val->first), val->second);
-		nWritten += val->second;
-	}
-	if(bSaveRAM)
-		nWritten += writeMemoryToFile(f); // Write associated component RAM
+	std::vector<unsigned char> buffer(getSavestateSize());
+	unsigned int nWritten = writeSavestate(buffer.data());
+	f.write((char*)buffer.data(), nWritten);
 	return nWritten;
 }
 
 unsigned int SystemComponent::readSavestate(std::ifstream &f){
-	unsigned int nRead = 0;
-	nRead += readSavestateHeader(f); // Read component header
-	for(auto val = userValues.cbegin(); val != userValues.cend(); val++){
-		f.read(static_cast<char*>(val->first), val->second);
-		nRead += val->second;
-	}
+	std::vector<unsigned char> buffer(getSavestateSize());
+	f.read((char*)buffer.data(), buffer.size());
+	SavestateChunk chunk;
+	if(!chunk.read(buffer.data(), (size_t)f.gcount()) || !readSavestate(chunk))
+		return 0;
+	return buffer.size();
+}
+
+unsigned int SystemComponent::getSavestateSize() const {
+	unsigned int nBytesTotal = SAVESTATE_CHUNK_HEADER_LENGTH + 9; // Chunk and component headers
+	for(auto val = userValues.cbegin(); val != userValues.cend(); val++)
+		nBytesTotal += val->second;
 	if(bSaveRAM)
-		nRead += readMemoryFromFile(f); // Read associated component RAM
-	return nRead;
+		nBytesTotal += size;
+	return nBytesTotal;
 }
 
-unsigned int SystemComponent::writeSavestateHeader(std::ofstream &f){
-	f.write((char*)&nComponentID, 4);
-	f.write((char*)&readOnly, 1);
-	f.write((char*)&offset, 2);
-	f.write((char*)&nBytes, 2);
-	f.write((char*)&nBanks, 2);
-	f.write((char*)&bs, 2);
-	return 13;
+unsigned int SystemComponent::writeSavestate(unsigned char *dest, bool dirtyOnly/*=false*/){
+	unsigned int nWritten = 0; 
+	nWritten += SavestateChunk::writeHeader(dest, nComponentID, getSavestateVersion(), getSavestateSize() - SAVESTATE_CHUNK_HEADER_LENGTH);
+	nWritten += writeSavestateHeader(&dest[nWritten]); // Write the component header
+	for(auto val = userValues.cbegin(); val != userValues.cend(); val++){
+		memcpy(&dest[nWritten], val->first, val->second);
+		nWritten += val->second;
+	}
+	if(bSaveRAM && size){ // Write associated component RAM (all banks are contiguous)
+		if(dirtyOnly){ // Copy modified pages only
+			for(unsigned int page = 0; page < dirtyPages.size(); page++){
+				if(!dirtyPages[page])
+					continue;
+				unsigned int start = page << 8;
+				memcpy(&dest[nWritten + start], &mem.data()[start], std::min(256u, size - start));
+				dirtyPages[page] = 0;
+			}
+		}
+		else
+			memcpy(&dest[nWritten], mem.data(), size);
+		nWritten += size;
+	}
+	return nWritten;
 }
 
-unsigned int SystemComponent::readSavestateHeader(std::ifstream &f){
+bool SystemComponent::checkSavestate(const SavestateChunk *chunk) const {
+	if(!chunk){
+		std::cout << " [SystemComponent] Warning! Savestate contains no chunk for component name=" << sName << std::endl;
+		return false;
+	}
+	if(chunk->id != nComponentID){
+		std::cout << " [SystemComponent] Warning! Savestate chunk \"" << chunk->getName() << "\" does not belong to component name=" << sName << std::endl;
+		return false;
+	}
+	if(chunk->version != getSavestateVersion()){
+		std::cout << " [SystemComponent] Warning! Unsupported savestate version (" << chunk->version << " != " << getSavestateVersion() << ") for component name=" << sName << std::endl;
+		return false;
+	}
+	if(chunk->length != getSavestateSize() - SAVESTATE_CHUNK_HEADER_LENGTH){
+		std::cout << " [SystemComponent] Warning! Savestate chunk length (" << chunk->length << " != " << getSavestateSize() - SAVESTATE_CHUNK_HEADER_LENGTH << " B) does not match component name=" << sName << std::endl;
+		return false;
+	}
 	bool readBackReadOnly;
-	unsigned int readBackComponentID;
 	unsigned short readBackOffset;
 	unsigned short readBackBytes;
 	unsigned short readBackBanks;
-	f.read((char*)&readBackComponentID, 4);
-	f.read((char*)&readBackReadOnly, 1);
-	f.read((char*)&readBackOffset, 2);
-	f.read((char*)&readBackBytes, 2);
-	f.read((char*)&readBackBanks, 2);
+	unsigned short readBackBankSelect;
+	memcpy(&readBackReadOnly, &chunk->payload[0], 1);
+	memcpy(&readBackOffset, &chunk->payload[1], 2);
+	memcpy(&readBackBytes, &chunk->payload[3], 2);
+	memcpy(&readBackBanks, &chunk->payload[5], 2);
+	memcpy(&readBackBankSelect, &chunk->payload[7], 2);
 	if(
-		(readBackComponentID != nComponentID) ||
 		(readBackReadOnly != readOnly) ||
 		(readBackOffset != offset) ||
 		(readBackBytes != nBytes) ||
-		(readBackBanks != nBanks))
+		(readBackBanks != nBanks) ||
+		(nBanks && readBackBankSelect >= nBanks))
 	{
 		std::cout << " [SystemComponent] Warning! Signature of savestate does not match signature for component name=" << sName << std::endl;
-		std::cout << " [SystemComponent]  Unstable behavior will likely occur" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool SystemComponent::readSavestate(const SavestateChunk &chunk){
+	if(!checkSavestate(&chunk))
+		return false;
+	const unsigned char *src = chunk.payload;
+	unsigned int nRead = 7;
+	memcpy(&bs, &src[nRead], 2); // Read the bank select
+	nRead += 2;
+	for(auto val = userValues.cbegin(); val != userValues.cend(); val++){
+		memcpy(val->first, &src[nRead], val->second);
+		nRead += val->second;
+	}
+	if(bSaveRAM && size){ // Read associated component RAM (all banks are contiguous)
+		memcpy(mem.data(), &src[nRead], size);
+		setAllPagesDirty();
 	}
-	f.read((char*)&bs, 2); // Read the bank select
-	return 13;
+	return true;
+}
+
+unsigned int SystemComponent::getNumberOfDirtyPages() const {
+	unsigned int nDirty = 0;
+	for(auto page = dirtyPages.cbegin(); page != dirtyPages.cend(); page++)
+		nDirty += (*page ? 1 : 0);
+	return nDirty;
+}
+
+void SystemComponent::setAllPagesDirty(){
+	std::fill(dirtyPages.begin(), dirtyPages.end(), 1);
+}
+
+unsigned int SystemComponent::writeSavestateHeader(unsigned char *dest){
+	memcpy(&dest[0], &readOnly, 1);
+	memcpy(&dest[1], &offset, 2);
+	memcpy(&dest[3], &nBytes, 2);
+	memcpy(&dest[5], &nBanks, 2);
+	memcpy(&dest[7], &bs, 2);
+	return 9;
 }
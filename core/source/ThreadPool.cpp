@@ -0,0 +1,87 @@
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool() :
+	workers(),
+	lock(),
+	jobReady(),
+	jobDone(),
+	currentTask(0x0),
+	nTasks(0),
+	nextTask(0),
+	nFinished(0),
+	jobNumber(0),
+	stopping(false)
+{
+}
+
+ThreadPool::ThreadPool(const unsigned int &N) :
+	ThreadPool()
+{
+	resize(N);
+}
+
+ThreadPool::~ThreadPool(){
+	stop();
+}
+
+void ThreadPool::resize(const unsigned int &N){
+	stop();
+	stopping = false;
+	for(unsigned int i = 0; i < N; i++)
+		workers.push_back(std::thread(&ThreadPool::work, this));
+}
+
+void ThreadPool::run(const unsigned int &N, const std::function<void(unsigned int)> &task){
+	if(workers.empty() || N <= 1){ // Nothing to divide
+		for(unsigned int i = 0; i < N; i++)
+			task(i);
+		return;
+	}
+	std::unique_lock<std::mutex> guard(lock);
+	currentTask = &task;
+	nTasks = N;
+	nextTask = 0;
+	nFinished = 0;
+	jobNumber++;
+	jobReady.notify_all();
+
+	// The calling thread helps with the job, then waits for the workers to finish
+	runTasks(guard);
+	jobDone.wait(guard, [this]{ return (nFinished == nTasks); });
+	currentTask = 0x0;
+}
+
+void ThreadPool::stop(){
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	jobReady.notify_all();
+	for(auto worker = workers.begin(); worker != workers.end(); worker++)
+		worker->join();
+	workers.clear();
+}
+
+void ThreadPool::runTasks(std::unique_lock<std::mutex> &guard){
+	const std::function<void(unsigned int)> *task = currentTask;
+	while(currentTask && nextTask < nTasks){
+		unsigned int index = nextTask++;
+		guard.unlock();
+		(*task)(index);
+		guard.lock();
+		if(++nFinished == nTasks)
+			jobDone.notify_all();
+	}
+}
+
+void ThreadPool::work(){
+	unsigned long long lastJob = 0;
+	std::unique_lock<std::mutex> guard(lock);
+	while(true){
+		jobReady.wait(guard, [&]{ return (stopping || jobNumber != lastJob); });
+		if(stopping)
+			return;
+		lastJob = jobNumber;
+		runTasks(guard);
+	}
+}
@@ -31,6 +31,13 @@ public:
 
 	void setWindow(Window *win){ window = win; }
 
+	/** Set pointer to a packed RGBA framebuffer to draw characters into instead of drawing them to the window
+	  * @param ptr Pointer to the framebuffer (or null to draw directly to the window)
+	  * @param width Width of the framebuffer (in pixels)
+	  * @param height Height of the framebuffer (in pixels)
+	  */
+	void setFramebuffer(uint32_t *ptr, const unsigned short &width, const unsigned short &height);
+
 	void setPaletteColor(unsigned short &index, const ColorRGB &color);
 
 	void setTransparency(bool state=true){ transparency = state; }
@@ -43,6 +50,12 @@ public:
 
 protected:
 	Window *window;
+
+	uint32_t *framebuffer; ///< Pointer to packed RGBA framebuffer (not owned by the character map)
+
+	unsigned short fbWidth; ///< Width of the framebuffer (in pixels)
+
+	unsigned short fbHeight; ///< Height of the framebuffer (in pixels)
 	
 	bool transparency;
 	
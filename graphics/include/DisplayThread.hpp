@@ -0,0 +1,99 @@
+#ifndef DISPLAY_THREAD_HPP
+#define DISPLAY_THREAD_HPP
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <future>
+#include <cstdint>
+
+#include "TripleBuffer.hpp"
+#include "Graphics.hpp"
+
+class DisplayThread{
+public:
+	/** Default constructor
+	  */
+	DisplayThread();
+
+	/** Destructor
+	  * Stops the display thread (if it is running).
+	  */
+	~DisplayThread();
+
+	/** Start the display thread and open the window on it
+	  * All further calls to the window's rendering and event functions are made by the display thread, so the
+	  * window must not be accessed directly by any other thread (with the exception of its KeyStates). This
+	  * call waits until the window has been initialized.
+	  * @param win Pointer to the (uninitialized) output window
+	  * @return True if the window was opened successfully and return false otherwise
+	  */
+	bool start(Window *win);
+
+	/** Close the window and wait for the display thread to exit
+	  */
+	void stop();
+
+	/** Return true if the display thread is running and the window is open
+	  */
+	bool running() const {
+		return isRunning.load(std::memory_order_acquire);
+	}
+
+	/** Hand a completed frame off to the display thread (never blocks)
+	  * Frames which are presented faster than the display thread can draw them are dropped.
+	  * @param frame Packed RGBA framebuffer with the same dimensions as the window
+	  */
+	void present(const uint32_t *frame);
+
+	/** Get the next keyboard event received by the window
+	  * @return True if an event was retrieved and return false if there are no pending events
+	  */
+	bool getKeyEvent(KeyEvent &evt){
+		return keyEvents.pop(evt);
+	}
+
+	/** Request that the window be resized to an integer multiple of its original size
+	  * @param filter CPU upscaling filter applied to each frame
+	  * @param scale Integer pixel scaling multiplier
+	  */
+	void setUpscaleFilter(const upscaleFilter &filter, const int &scale){
+		pendingScale.store(((int)filter << 8) | (scale & 0xFF), std::memory_order_release);
+	}
+
+	/** Request that repeated key press events be enabled or disabled
+	  */
+	void setKeyRepeat(bool state){
+		pendingKeyRepeat.store(state ? 1 : 0, std::memory_order_release);
+	}
+
+private:
+	Window *window; ///< Pointer to the output window, owned by the caller but driven by the display thread
+
+	std::thread thread; ///< The display thread
+
+	std::atomic<bool> isRunning; ///< Set while the window is open
+
+	std::atomic<bool> stopRequested; ///< Set when the display thread should close the window and exit
+
+	std::atomic<int> pendingScale; ///< Requested upscaling filter (bits 8-15) and scaling factor (bits 0-7), or -1 if there is no pending request
+
+	std::atomic<int> pendingKeyRepeat; ///< Requested key repeat state (or -1 if there is no pending request)
+
+	size_t frameSize; ///< Number of pixels in each frame
+
+	TripleBuffer<std::vector<uint32_t> > frames; ///< Completed frames handed from the emulation thread to the display thread
+
+	KeyEventQueue keyEvents; ///< Keyboard events handed from the display thread to the emulation thread
+
+	/** Main loop of the display thread
+	  * @param ready Promise which receives the status of the window after it has been initialized
+	  */
+	void run(std::promise<bool> *ready);
+
+	/** Apply window changes which were requested by other threads
+	  */
+	void applyPendingRequests();
+};
+
+#endif
@@ -1,4 +1,6 @@
-#ifndef USE_SDL_RENDERER
+#if defined(USE_HEADLESS_RENDERER)
+	#include "GraphicsNone.hpp"
+#elif !defined(USE_SDL_RENDERER)
 	#include "GraphicsOpenGL.hpp"
 #else
 	#include "GraphicsSDL.hpp"
@@ -0,0 +1,192 @@
+#ifndef GRAPHICS_HPP
+#define GRAPHICS_HPP
+
+#include <vector>
+
+#include "colors.hpp"
+#include "KeyStates.hpp"
+#include "Upscaler.hpp"
+
+class GPU;
+
+/** Headless output window with no display
+  * Implements the same interface as the OpenGL window, but nothing is ever drawn. The window remains open
+  * until close() is called and keyboard events may only be injected programmatically.
+  */
+class Window{
+public:
+	/** Default constructor
+	  */
+	Window() :
+		W(0),
+		H(0),
+		nMult(1),
+		init(false),
+		gpu(0x0),
+		framebuffer(0x0)
+	{
+	}
+
+	/** Constructor taking the width and height of the window
+	  */
+	Window(const int &w, const int &h, const int& scale=1) :
+		W(w),
+		H(h),
+		nMult(scale),
+		init(false),
+		gpu(0x0),
+		framebuffer(0x0)
+	{
+	}
+
+	/** Close the window
+	  */
+	void close(){ init = false; }
+
+	/** Return true if the window is open and return false otherwise
+	  */
+	bool processEvents(){ return init; }
+
+	GPU *getGPU(){ return gpu; }
+
+	/** Get the width of the window (in pixels)
+	  */
+	int getCurrentWidth() const { return W; }
+
+	/** Get the height of the window (in pixels)
+	  */
+	int getCurrentHeight() const { return H; }
+
+	/** Get the width of the window (in pixels)
+	  */
+	int getWidth() const { return W; }
+
+	/** Get the height of the window (in pixels)
+	  */
+	int getHeight() const { return H; }
+
+	/** Get screen scale multiplier.
+	  */
+	int getScale() const { return nMult; }
+
+	/** Get a pointer to the last user keypress event
+	  */
+	KeyStates* getKeypress(){ return &keys; }
+
+	/** Return true, the window never has a display
+	  */
+	bool isHeadless() const { return true; }
+
+	/** Set pointer to the pixel processor
+	  */
+	void setGPU(GPU *ptr){ gpu = ptr; }
+
+	/** Does nothing, the window is always headless
+	  */
+	void setHeadless(bool state=true){ }
+
+	/** Set pointer to the packed RGBA framebuffer
+	  */
+	void setFramebuffer(const uint32_t *ptr){ framebuffer = ptr; }
+
+	/** Does nothing, keyboard events are never received from the user
+	  */
+	void setKeyEventQueue(KeyEventQueue *queue){ }
+
+	/** Set the integer pixel scaling multiplier (default = 1)
+	  */
+	void setScalingFactor(const int &scale){ nMult = scale; }
+
+	/** Set the integer pixel scaling multiplier
+	  * @return True if the filter supports the scaling multiplier and return false otherwise
+	  */
+	bool setUpscaleFilter(const upscaleFilter &filter, const int &scale);
+
+	/** Does nothing
+	  */
+	static void setDrawColor(ColorRGB *color, const float &alpha=1){ }
+
+	/** Does nothing
+	  */
+	static void setDrawColor(const ColorRGB &color, const float &alpha=1){ }
+
+	/** Does nothing
+	  */
+	void setCurrent(){ }
+
+	/** Does nothing
+	  */
+	static void clear(const ColorRGB &color=Colors::BLACK){ }
+
+	/** Does nothing
+	  */
+	static void drawPixel(const int &x, const int &y){ }
+
+	/** Does nothing
+	  */
+	static void drawPixel(const int *x, const int *y, const size_t &N){ }
+
+	/** Does nothing
+	  */
+	static void drawLine(const int &x1, const int &y1, const int &x2, const int &y2){ }
+
+	/** Does nothing
+	  */
+	static void drawLine(const int *x, const int *y, const size_t &N){ }
+
+	/** Does nothing
+	  */
+	static void drawRectangle(const int &x1, const int &y1, const int &x2, const int &y2){ }
+
+	/** Does nothing
+	  */
+	void render(){ }
+
+	/** Return true if the window is open and return false otherwise
+	  */
+	bool status(){ return init; }
+
+	/** Open the window
+	  */
+	void initialize(){ init = true; }
+
+	/** Set keyboard keys to behave as a stream buffer
+	  */
+	void setKeyboardStreamMode(){ keys.enableStreamMode(); }
+
+	/** Set keyboard keys to behave as button toggles
+	  */
+	void setKeyboardToggleMode(){ keys.disableStreamMode(); }
+
+	/** Does nothing, there is no key repeat
+	  */
+	void setKeyRepeat(bool state){ }
+
+	/** Set keyboard keys to behave as button toggles
+	  */
+	void setupKeyboardHandler(){ setKeyboardToggleMode(); }
+
+	/** Handle a key press
+	  */
+	void keyDown(const unsigned char &key){ keys.keyDown(key); }
+
+	/** Handle a key release
+	  */
+	void keyUp(const unsigned char &key){ keys.keyUp(key); }
+
+private:
+	int W; ///< Original width of the window (in pixels)
+	int H; ///< Original height of the window (in pixels)
+
+	int nMult; ///< Integer multiplier for window scaling
+
+	bool init; ///< Flag indicating that the window has been initialized
+
+	GPU *gpu; ///< Pointer to the graphics processor
+
+	const uint32_t *framebuffer; ///< Pointer to packed RGBA framebuffer (not owned by the window)
+
+	KeyStates keys; ///< The last key which was pressed by the user
+};
+
+#endif
@@ -2,44 +2,13 @@
 #define GRAPHICS_HPP
 
 #include <vector>
-#include <queue>
 
 #include "colors.hpp"
+#include "KeyStates.hpp"
+#include "Upscaler.hpp"
 
 class GPU;
 
-class KeyStates{
-public:
-	KeyStates();
-	
-	void enableStreamMode();
-	
-	void disableStreamMode();
-	
-	bool empty() const { return (count == 0); }
-	
-	bool check(const unsigned char &key) const { return states[key]; }
-	
-	bool poll(const unsigned char &key);
-	
-	void keyDown(const unsigned char &key);
-	
-	void keyUp(const unsigned char &key);
-	
-	bool get(char& key);
-
-	void reset();
-
-private:
-	unsigned short count; ///< Number of standard keyboard keys which are currently pressed
-
-	bool streamMode; ///< Flag to set keyboard to behave as stream buffer
-
-	std::queue<char> buffer;
-
-	bool states[256]; ///< States of keyboard keys (true indicates key is down) 
-};
-
 class Window{
 public:
 	/** Default constructor
@@ -53,7 +22,13 @@ public:
 		aspect(1),
 		nMult(1), 
 		winID(0), 
-		init(false)
+		texture(0),
+		textureSize(0),
+		init(false),
+		headless(false),
+		framebuffer(0x0),
+		keyEvents(0x0),
+		upscaler()
 	{ 
 	}
 	
@@ -67,7 +42,13 @@ public:
 		height(h),
 		aspect(float(w)/h),
 		nMult(scale), 
-		init(false)
+		texture(0),
+		textureSize(0),
+		init(false),
+		headless(false),
+		framebuffer(0x0),
+		keyEvents(0x0),
+		upscaler()
 	{
 	}
 
@@ -117,10 +98,35 @@ public:
 	  */
 	KeyStates* getKeypress(){ return &keys; }
 
+	/** Return true if the window has no display
+	  */
+	bool isHeadless() const { return headless; }
+
 	/** Set pointer to the pixel processor
 	  */
 	void setGPU(GPU *ptr){ gpu = ptr; }
 
+	/** Run the window without a display (must be called before initialize())
+	  * A headless window does not draw anything and does not receive keyboard events from the user,
+	  * but is otherwise identical to a normal window. It remains open until close() is called.
+	  */
+	void setHeadless(bool state=true){
+		if(!init)
+			headless = state;
+	}
+
+	/** Set pointer to a packed RGBA framebuffer which will be uploaded to the window on every call to render()
+	  * The framebuffer must contain W*H pixels and must remain valid for the lifetime of the window.
+	  * @param ptr Pointer to the framebuffer (or null to disable framebuffer output)
+	  */
+	void setFramebuffer(const uint32_t *ptr){ framebuffer = ptr; }
+
+	/** Set pointer to a queue which will receive all keyboard events instead of the window's KeyStates
+	  * Used when the window is driven by a different thread than the one which reads the keyboard state.
+	  * @param queue Pointer to the key event queue (or null to update the window's KeyStates directly)
+	  */
+	void setKeyEventQueue(KeyEventQueue *queue){ keyEvents = queue; }
+
 	/** Set the width of the window (in pixels)
 	  */
 	void setWidth(const int &w){ width = w; }
@@ -133,6 +139,13 @@ public:
 	  */
 	void setScalingFactor(const int &scale);
 
+	/** Select the CPU upscaling filter applied to the framebuffer and resize the window to match
+	  * @param filter Upscaling filter (the window is scaled by OpenGL if no filter is selected)
+	  * @param scale Integer pixel scaling multiplier
+	  * @return True if the filter supports the scaling multiplier and return false otherwise
+	  */
+	bool setUpscaleFilter(const upscaleFilter &filter, const int &scale);
+
 	/** Set the current draw color
 	  */
 	static void setDrawColor(ColorRGB *color, const float &alpha=1);
@@ -181,8 +194,9 @@ public:
 	static void drawRectangle(const int &x1, const int &y1, const int &x2, const int &y2);
 
 	/** Render the current frame
+	  * If a framebuffer has been set, it is uploaded to the window as a single texture.
 	  */
-	static void render();
+	void render();
 
 	/** Return true if the window has been closed and return false otherwise
 	  */
@@ -196,8 +210,24 @@ public:
 
 	void setKeyboardToggleMode();
 
+	/** Enable or disable repeated key press events while a key is held down (does not modify the KeyStates)
+	  */
+	void setKeyRepeat(bool state);
+
 	void setupKeyboardHandler();
 
+	/** Handle a key press (forwarded to the key event queue, if one is set)
+	  */
+	void keyDown(const unsigned char &key);
+
+	/** Handle a key release (forwarded to the key event queue, if one is set)
+	  */
+	void keyUp(const unsigned char &key);
+
+	/** Mark the window as closed after it was destroyed by the window manager
+	  */
+	void onClose();
+
 	virtual void paintGL();
 	
 	virtual void initializeGL();
@@ -216,10 +246,29 @@ private:
 	int nMult; ///< Integer multiplier for window scaling
 	int winID; ///< GLUT window identifier
 
+	unsigned int texture; ///< OpenGL texture used for framebuffer output
+
+	int textureSize; ///< Width and height of the framebuffer texture (in pixels)
+
 	bool init; ///< Flag indicating that the window has been initialized
 
+	bool headless; ///< Flag indicating that the window has no display
+
 	GPU *gpu; ///< Pointer to the graphics processor
 
+	const uint32_t *framebuffer; ///< Pointer to packed RGBA framebuffer (not owned by the window)
+
 	KeyStates keys; ///< The last key which was pressed by the user
+
+	KeyEventQueue *keyEvents; ///< Pointer to the queue which receives keyboard events (not owned by the window)
+
+	Upscaler upscaler; ///< CPU upscaling filter applied to the framebuffer before it is uploaded
+
+	/** Upload a frame to the framebuffer texture and draw it to the full window
+	  * @param pixels Packed RGBA frame
+	  * @param w Width of the frame (in pixels)
+	  * @param h Height of the frame (in pixels)
+	  */
+	void drawFramebuffer(const uint32_t *pixels, const int &w, const int &h);
 };
 #endif
@@ -12,6 +12,7 @@ class GPU;
 
 class SDL_Renderer;
 class SDL_Window;
+class SDL_Texture;
 class SDL_Rect;
 
 class SDL_KeyboardEvent;
@@ -51,11 +52,11 @@ class Window{
 public:
 	/** Default constructor
 	  */
-	Window() : renderer(NULL), window(NULL), W(SCREEN_WIDTH), H(SCREEN_HEIGHT), nMult(2), init(false) { }
+	Window() : renderer(NULL), window(NULL), texture(NULL), W(SCREEN_WIDTH), H(SCREEN_HEIGHT), nMult(2), init(false), framebuffer(NULL) { }
 	
 	/** Constructor taking the width and height of the window
 	  */
-	Window(const int &width, const int &height) : renderer(NULL), window(NULL), W(width), H(height), nMult(2), init(false) { }
+	Window(const int &width, const int &height) : renderer(NULL), window(NULL), texture(NULL), W(width), H(height), nMult(2), init(false), framebuffer(NULL) { }
 
 	/** Destructor
 	  */
@@ -75,6 +76,12 @@ public:
 	  */
 	KeyStates* getKeypress(){ return &lastKey; }
 	
+	/** Set pointer to a packed RGBA framebuffer which will be uploaded to the window on every call to render()
+	  * The framebuffer must contain W*H pixels and must remain valid for the lifetime of the window.
+	  * @param ptr Pointer to the framebuffer (or null to disable framebuffer output)
+	  */
+	void setFramebuffer(const uint32_t *ptr){ framebuffer = ptr; }
+
 	/** Set the width of the window (in pixels)
 	  */
 	void setWidth(const int &width){ W = width; }
@@ -119,6 +126,7 @@ public:
 	void drawLine(const int *x, const int *y, const size_t &N);
 
 	/** Render the current frame
+	  * If a framebuffer has been set, it is uploaded to the window as a single streaming texture.
 	  */
 	void render();
 
@@ -133,6 +141,7 @@ public:
 private:
 	SDL_Renderer *renderer; ///< Pointer to the SDL renderer
 	SDL_Window *window; ///< Pointer to the SDL window
+	SDL_Texture *texture; ///< Pointer to the SDL streaming texture used for framebuffer output
 
 	int W; ///< Width of the window (in pixels)
 	int H; ///< Height of the window (in pixels)
@@ -140,6 +149,8 @@ private:
 
 	bool init; ///< Flag indicating that the window has been initialized
 
+	const uint32_t *framebuffer; ///< Pointer to packed RGBA framebuffer (not owned by the window)
+
 	KeyStates lastKey; ///< The last key which was pressed by the user
 	
 	SDL_Rect *rectangle; ///< A rectangle used for drawing chunky pixels
@@ -0,0 +1,57 @@
+#ifndef KEY_STATES_HPP
+#define KEY_STATES_HPP
+
+#include <queue>
+
+#include "SpscQueue.hpp"
+
+class KeyStates{
+public:
+	KeyStates();
+	
+	void enableStreamMode();
+	
+	void disableStreamMode();
+	
+	bool empty() const { return (count == 0); }
+	
+	bool check(const unsigned char &key) const { return states[key]; }
+	
+	bool poll(const unsigned char &key);
+	
+	void keyDown(const unsigned char &key);
+	
+	void keyUp(const unsigned char &key);
+	
+	bool get(char& key);
+
+	void reset();
+
+private:
+	unsigned short count; ///< Number of standard keyboard keys which are currently pressed
+
+	bool streamMode; ///< Flag to set keyboard to behave as stream buffer
+
+	std::queue<char> buffer;
+
+	bool states[256]; ///< States of keyboard keys (true indicates key is down) 
+};
+
+class KeyEvent{
+public:
+	unsigned char key; ///< Keyboard character (or redirected special key)
+
+	bool down; ///< Set if the key was pressed and not set if it was released
+
+	/** Default constructor
+	  */
+	KeyEvent() : key(0), down(false) { }
+
+	/** Key constructor
+	  */
+	KeyEvent(const unsigned char &k, bool d) : key(k), down(d) { }
+};
+
+typedef SpscQueue<KeyEvent, 256> KeyEventQueue;
+
+#endif
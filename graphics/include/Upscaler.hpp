@@ -0,0 +1,136 @@
+#ifndef UPSCALER_HPP
+#define UPSCALER_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "ThreadPool.hpp"
+
+enum class upscaleFilter{ NONE, NEAREST, SCALE2X, SCALE3X, XBR };
+
+class Upscaler{
+public:
+	/** Default constructor
+	  * Upscaling is disabled.
+	  */
+	Upscaler();
+
+	/** Select the upscaling filter and the integer scaling factor
+	  * Supported combinations are nearest (1x to 8x), scale2x (2x), scale3x (3x), and xbr (2x to 4x).
+	  * @return True if the combination is supported and return false otherwise
+	  */
+	bool setFilter(const upscaleFilter &filt, const unsigned int &N);
+
+	/** Get the selected upscaling filter
+	  */
+	upscaleFilter getFilter() const {
+		return filter;
+	}
+
+	/** Get the selected scaling factor
+	  */
+	unsigned int getFactor() const {
+		return factor;
+	}
+
+	/** Get the name of the selected filter and scaling factor (e.g. "xbr4x")
+	  */
+	std::string getName() const ;
+
+	/** Return true if an upscaling filter is selected
+	  */
+	bool enabled() const {
+		return (filter != upscaleFilter::NONE);
+	}
+
+	/** Get the width of the most recent output frame (in pixels)
+	  */
+	int getOutputWidth() const {
+		return width * factor;
+	}
+
+	/** Get the height of the most recent output frame (in pixels)
+	  */
+	int getOutputHeight() const {
+		return height * factor;
+	}
+
+	/** Upscale a packed RGBA frame
+	  * The frame is divided into horizontal bands of rows which are filtered in parallel.
+	  * @param input Packed RGBA input frame (row-major)
+	  * @param W Width of the input frame (in pixels)
+	  * @param H Height of the input frame (in pixels)
+	  * @return Pointer to the upscaled frame, valid until the next call to process() or setFilter()
+	  */
+	const uint32_t *process(const uint32_t *input, const int &W, const int &H);
+
+	/** Parse an upscaling filter name and scaling factor
+	  * Accepted formats are "<filter><N>x" and "<filter><N>" (e.g. "xbr4x" or "nearest3"), "scale2x", "scale3x", and "none".
+	  * @param str Input string
+	  * @param filt Parsed upscaling filter
+	  * @param N Parsed scaling factor
+	  * @return True if the string names a supported filter and scaling factor and return false otherwise
+	  */
+	static bool parse(const std::string &str, upscaleFilter &filt, unsigned int &N);
+
+	/** Return true if a filter supports the specified scaling factor and return false otherwise
+	  */
+	static bool isSupported(const upscaleFilter &filt, const unsigned int &N);
+
+private:
+	upscaleFilter filter; ///< Selected upscaling filter
+
+	unsigned int factor; ///< Selected integer scaling factor
+
+	int width; ///< Width of the input frame (in pixels)
+
+	int height; ///< Height of the input frame (in pixels)
+
+	int stride; ///< Width of the padded input frame (in pixels)
+
+	std::vector<uint32_t> padded; ///< Copy of the input frame with edge pixels repeated around the border
+
+	std::vector<uint32_t> yuv; ///< YUV colors of all pixels in the padded input frame (xbr only)
+
+	std::vector<uint32_t> output; ///< Upscaled output frame
+
+	unsigned char slots[4][16]; ///< Output pixel indices of each xbr corner, indexed by rotation and bottom-right slot
+
+	int neighbors[4][21]; ///< Padded frame offsets of the xbr neighborhood, indexed by rotation
+
+	ThreadPool pool; ///< Worker threads used to filter bands of rows in parallel
+
+	/** Copy a band of input rows into the padded frame (and compute YUV colors, if needed)
+	  */
+	void prepare(const uint32_t *input, const int &y0, const int &y1);
+
+	/** Nearest neighbor upscaling of a band of input rows
+	  */
+	void nearest(const int &y0, const int &y1);
+
+	/** Scale2x (EPX) upscaling of a band of input rows
+	  */
+	void scale2x(const int &y0, const int &y1);
+
+	/** Scale3x upscaling of a band of input rows
+	  */
+	void scale3x(const int &y0, const int &y1);
+
+	/** xBR upscaling of a band of input rows
+	  */
+	void xbr(const int &y0, const int &y1);
+
+	/** Blend the four corners of one xBR output pixel block
+	  * @param src Pointer to the center pixel in the padded frame
+	  * @param lum Pointer to the center pixel in the padded YUV frame
+	  * @param block Output pixel block (factor x factor, row-major)
+	  */
+	void xbrBlock(const uint32_t *src, const uint32_t *lum, uint32_t *block) const ;
+
+	/** Compute the rotated xBR output slots and neighbor offsets
+	  */
+	void setupXBR();
+};
+
+#endif
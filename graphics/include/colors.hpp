@@ -1,6 +1,8 @@
 #ifndef COLORS_HPP
 #define COLORS_HPP
 
+#include <cstdint>
+
 #ifndef USE_SDL_RENDERER
 
 	class ColorRGB{
@@ -78,6 +80,17 @@
 	/** Conver the color to grayscale using RGB coefficients based on the sRGB convention
 	  */
 	void toGrayscale();
+
+	/** Get the color as a packed 32-bit RGBA pixel
+	  * The components are stored in memory in the order R, G, B, A regardless of the host byte order.
+	  * @param alpha Opacity of the pixel in the range [0, 1]
+	  */
+	uint32_t toRGBA(const float &alpha=1) const ;
+
+	/** Pack 8-bit color components into a 32-bit RGBA pixel
+	  * The components are stored in memory in the order R, G, B, A regardless of the host byte order.
+	  */
+	static uint32_t packRGBA(const unsigned char &red, const unsigned char &green, const unsigned char &blue, const unsigned char &alpha=255);
 	
 	/** Dump the RGB color components to stdout
 	  */
@@ -38,7 +38,7 @@ void Bitmap::dump(){
 	std::cout << std::endl;
 }
 
-CharacterMap::CharacterMap() : window(0x0) {
+CharacterMap::CharacterMap() : window(0x0), framebuffer(0x0), fbWidth(0), fbHeight(0) {
 	std::string path(TOP_DIRECTORY);
 	path += "/assets/cmap.dat";
 	loadCharacterMap(path);
@@ -48,6 +48,12 @@ CharacterMap::CharacterMap() : window(0x0) {
 	palette[3] = Colors::BLACK;
 }
 
+void CharacterMap::setFramebuffer(uint32_t *ptr, const unsigned short &width, const unsigned short &height){
+	framebuffer = ptr;
+	fbWidth = width;
+	fbHeight = height;
+}
+
 void CharacterMap::setPaletteColor(unsigned short &index, const ColorRGB &color){
 	if(index <= 3)
 		palette[index] = color;
@@ -92,6 +98,11 @@ void CharacterMap::putCharacter(const char &val, const unsigned short &x, const
 			pixelColor = cmap[(unsigned int)val].get(dx, dy);
 			if(transparency && pixelColor == 0) // Transparent
 				continue;
+			if(framebuffer){
+				if(8*x+dx < fbWidth && 8*y+dy < fbHeight)
+					framebuffer[(8*y+dy)*fbWidth + 8*x+dx] = palette[pixelColor].toRGBA();
+				continue;
+			}
 			window->setDrawColor(palette[pixelColor]);
 			window->drawPixel(8*x+dx, 8*y+dy);
 		}
@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <chrono>
+
+#include "DisplayThread.hpp"
+
+constexpr int DISPLAY_IDLE_SLEEP_US = 1000; ///< Time the display thread sleeps when no new frame is available (in microseconds)
+
+DisplayThread::DisplayThread() :
+	window(0x0),
+	thread(),
+	isRunning(false),
+	stopRequested(false),
+	pendingScale(-1),
+	pendingKeyRepeat(-1),
+	frameSize(0),
+	frames(),
+	keyEvents()
+{
+}
+
+DisplayThread::~DisplayThread(){
+	stop();
+}
+
+bool DisplayThread::start(Window *win){
+	if(thread.joinable() || !win)
+		return false;
+	window = win;
+	frameSize = (size_t)(window->getWidth() * window->getHeight());
+	frames.reset(std::vector<uint32_t>(frameSize, 0));
+	stopRequested.store(false);
+
+	// Wait for the window to open before returning
+	std::promise<bool> ready;
+	std::future<bool> status = ready.get_future();
+	thread = std::thread(&DisplayThread::run, this, &ready);
+	return status.get();
+}
+
+void DisplayThread::stop(){
+	if(!thread.joinable())
+		return;
+	stopRequested.store(true, std::memory_order_release);
+	thread.join();
+}
+
+void DisplayThread::present(const uint32_t *frame){
+	std::copy(frame, frame + frameSize, frames.getBackBuffer().begin());
+	frames.publish();
+}
+
+void DisplayThread::run(std::promise<bool> *ready){
+	// The window must be created by the thread which draws to it
+	window->setKeyEventQueue(&keyEvents);
+	window->initialize();
+	window->setupKeyboardHandler();
+	window->clear();
+	isRunning.store(window->status(), std::memory_order_release);
+	ready->set_value(window->status());
+
+	while(!stopRequested.load(std::memory_order_acquire)){
+		applyPendingRequests();
+		if(!window->processEvents()) // Window closed by the user
+			break;
+		if(frames.update()){ // Draw the newest completed frame
+			window->setFramebuffer(frames.getFrontBuffer().data());
+			window->render();
+		}
+		else{
+			std::this_thread::sleep_for(std::chrono::microseconds(DISPLAY_IDLE_SLEEP_US));
+		}
+	}
+
+	window->close();
+	window->setFramebuffer(0x0);
+	window->setKeyEventQueue(0x0);
+	isRunning.store(false, std::memory_order_release);
+}
+
+void DisplayThread::applyPendingRequests(){
+	int scale = pendingScale.exchange(-1, std::memory_order_acq_rel);
+	if(scale >= 0)
+		window->setUpscaleFilter((upscaleFilter)(scale >> 8), scale & 0xFF);
+	int repeat = pendingKeyRepeat.exchange(-1, std::memory_order_acq_rel);
+	if(repeat >= 0)
+		window->setKeyRepeat(repeat == 1);
+}
@@ -0,0 +1,12 @@
+#include "GraphicsNone.hpp"
+
+/////////////////////////////////////////////////////////////////////
+// class Window
+/////////////////////////////////////////////////////////////////////
+
+bool Window::setUpscaleFilter(const upscaleFilter &filter, const int &scale){
+	if(scale < 1 || !Upscaler::isSupported(filter, scale))
+		return false;
+	setScalingFactor(scale);
+	return true;
+}
@@ -6,6 +6,8 @@
 
 std::map<int, Window*> listOfWindows;
 
+constexpr int FRAMEBUFFER_TEXTURE_SIZE = 256; ///< Minimum power-of-two size of the framebuffer texture (for older OpenGL implementations)
+
 Window *getCurrentWindow(){
 	return listOfWindows[glutGetWindow()];
 }
@@ -21,7 +23,7 @@ void handleKeys(unsigned char key, int x, int y){
 		currentWindow->close();
 		return;
 	}
-	currentWindow->getKeypress()->keyDown(key);
+	currentWindow->keyDown(key);
 }
 
 /** Handle OpenGL keyboard key releases.
@@ -30,7 +32,7 @@ void handleKeys(unsigned char key, int x, int y){
   * @param y Y coordinate of the mouse when the key was released (not used).
   */
 void handleKeysUp(unsigned char key, int x, int y){
-	getCurrentWindow()->getKeypress()->keyUp(key);
+	getCurrentWindow()->keyUp(key);
 }
 
 /** Handle OpenGL special key presses.
@@ -131,71 +133,14 @@ void reshapeScene(GLint width, GLint height){
 	currentWindow->clear();
 }
 
-void displayFunction() {
-	// This callback does nothing, but is required on Windows
-}
-
-/////////////////////////////////////////////////////////////////////
-// class KeyStates
-/////////////////////////////////////////////////////////////////////
-
-KeyStates::KeyStates() : count(0), streamMode(false) {
-	reset();
-}
-
-void KeyStates::enableStreamMode(){
-	streamMode = true;
-	reset();
-}
-
-void KeyStates::disableStreamMode(){
-	streamMode = false;
-	reset();
-}
-
-bool KeyStates::poll(const unsigned char &key){ 
-	if(states[key]){
-		states[key] = false;
-		return true;
-	}
-	return false;
-}
-
-void KeyStates::keyDown(const unsigned char &key){
-	if(!streamMode){
-		if(!states[key]){
-			states[key] = true;
-			count++;
-		}
-	}
-	else{
-		buffer.push((char)key);
-	}
-}
-
-void KeyStates::keyUp(const unsigned char &key){
-	if(!streamMode){
-		if(states[key]){
-			states[key] = false;
-			count--;
-		}
-	}
-}
-
-bool KeyStates::get(char& key){
-	if(buffer.empty())
-		return false;
-	key = buffer.front();
-	buffer.pop();
-	return true;
+/** Handle the window being closed by the window manager.
+  */
+void handleWindowClose(){
+	getCurrentWindow()->onClose();
 }
 
-void KeyStates::reset(){
-	for(int i = 0; i < 256; i++)
-		states[i] = false;
-	while(!buffer.empty())
-		buffer.pop();
-	count = 0;
+void displayFunction() {
+	// This callback does nothing, but is required on Windows
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -207,20 +152,32 @@ Window::~Window(){
 }
 
 void Window::close(){
-	glutDestroyWindow(winID);
+	if(!init) return;
+	if(!headless)
+		glutDestroyWindow(winID);
+	texture = 0; // The texture is freed along with the window's rendering context
 	init = false;
 }
 
 bool Window::processEvents(){
 	if(!status())
 		return false;
-	glutMainLoopEvent();
+	if(!headless)
+		glutMainLoopEvent();
 	return true;
 }
 
 void Window::setScalingFactor(const int &scale){ 
 	nMult = scale; 
-	glutReshapeWindow(W*scale, H*scale);
+	if(init && !headless) // Otherwise the window is opened at the new size
+		glutReshapeWindow(W*scale, H*scale);
+}
+
+bool Window::setUpscaleFilter(const upscaleFilter &filter, const int &scale){
+	if(scale < 1 || !upscaler.setFilter(filter, scale))
+		return false;
+	setScalingFactor(scale);
+	return true;
 }
 	
 void Window::setDrawColor(ColorRGB *color, const float &alpha/*=1*/){
@@ -232,7 +189,8 @@ void Window::setDrawColor(const ColorRGB &color, const float &alpha/*=1*/){
 }
 
 void Window::setCurrent(){
-	glutSetWindow(winID);
+	if(!headless)
+		glutSetWindow(winID);
 }
 
 void Window::clear(const ColorRGB &color/*=Colors::BLACK*/){
@@ -278,9 +236,53 @@ void Window::drawRectangle(const int &x1, const int &y1, const int &x2, const in
 }
 
 void Window::render(){
+	if(headless) // Nothing to draw to
+		return;
+	if(framebuffer){
+		if(upscaler.enabled()) // Filter the frame before uploading it
+			drawFramebuffer(upscaler.process(framebuffer, W, H), upscaler.getOutputWidth(), upscaler.getOutputHeight());
+		else
+			drawFramebuffer(framebuffer, W, H);
+	}
 	glFlush();
 }
 
+void Window::drawFramebuffer(const uint32_t *pixels, const int &w, const int &h){
+	glEnable(GL_TEXTURE_2D);
+	int size = FRAMEBUFFER_TEXTURE_SIZE;
+	while(size < w || size < h)
+		size *= 2;
+	if(!texture){ // Allocate the texture on first use
+		GLuint id;
+		glGenTextures(1, &id);
+		texture = id;
+		textureSize = 0;
+	}
+	glBindTexture(GL_TEXTURE_2D, texture);
+	if(size != textureSize){ // Resize the texture to fit the frame
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		textureSize = size;
+	}
+
+	// Upload the entire frame at once
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+	// Draw a single textured quad covering the screen
+	const float u = float(w) / textureSize;
+	const float v = float(h) / textureSize;
+	glColor3f(1, 1, 1);
+	glBegin(GL_QUADS);
+		glTexCoord2f(0, 0); glVertex2i(0, 0);
+		glTexCoord2f(u, 0); glVertex2i(W, 0);
+		glTexCoord2f(u, v); glVertex2i(W, H);
+		glTexCoord2f(0, v); glVertex2i(0, H);
+	glEnd();
+	glDisable(GL_TEXTURE_2D);
+}
+
 bool Window::status(){
 	return init;
 }
@@ -288,6 +290,11 @@ bool Window::status(){
 void Window::initialize(){
 	if(init) return;
 
+	if(headless){ // No display, the window stays open until it is closed
+		init = true;
+		return;
+	}
+
 	// Dummy command line arguments
 	int dummyArgc = 1;
 
@@ -303,6 +310,10 @@ void Window::initialize(){
 	winID = glutCreateWindow("gbc");
 	listOfWindows[winID] = this;
 
+	// Return control to the caller instead of exiting when the window is closed
+	glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_CONTINUE_EXECUTION);
+	glutCloseFunc(handleWindowClose);
+
 	// Set window size handler
 	glutReshapeFunc(reshapeScene);
 
@@ -314,32 +325,58 @@ void Window::initialize(){
 
 void Window::setKeyboardStreamMode(){
 	// Enable keyboard repeat
-	glutIgnoreKeyRepeat(0);
+	setKeyRepeat(true);
 	keys.enableStreamMode();
 }
 
 void Window::setKeyboardToggleMode(){
 	// Disable keyboard repeat
-	glutIgnoreKeyRepeat(1);
+	setKeyRepeat(false);
 	keys.disableStreamMode();
 }
 
+void Window::setKeyRepeat(bool state){
+	if(!headless)
+		glutIgnoreKeyRepeat(state ? 0 : 1);
+}
+
 void Window::setupKeyboardHandler(){
-	// Set keyboard handler
-	glutKeyboardFunc(handleKeys);
-	glutSpecialFunc(handleSpecialKeys);
+	if(!headless){
+		// Set keyboard handler
+		glutKeyboardFunc(handleKeys);
+		glutSpecialFunc(handleSpecialKeys);
 
-	// Keyboard up handler
-	glutKeyboardUpFunc(handleKeysUp);
-	glutSpecialUpFunc(handleSpecialKeysUp);
+		// Keyboard up handler
+		glutKeyboardUpFunc(handleKeysUp);
+		glutSpecialUpFunc(handleSpecialKeysUp);
 
-	// Set window size handler
-	glutReshapeFunc(reshapeScene);
+		// Set window size handler
+		glutReshapeFunc(reshapeScene);
+	}
 
 	// Set keyboard keys to behave as button toggles
 	setKeyboardToggleMode();
 }
 
+void Window::keyDown(const unsigned char &key){
+	if(keyEvents) // Events are dropped if the queue is full
+		keyEvents->push(KeyEvent(key, true));
+	else
+		keys.keyDown(key);
+}
+
+void Window::keyUp(const unsigned char &key){
+	if(keyEvents)
+		keyEvents->push(KeyEvent(key, false));
+	else
+		keys.keyUp(key);
+}
+
+void Window::onClose(){
+	texture = 0; // The texture is freed along with the window's rendering context
+	init = false;
+}
+
 void Window::paintGL(){
 	this->render();
 }
@@ -51,6 +51,8 @@ void MouseEvent::decode(const SDL_MouseMotionEvent* evt){
 
 Window::~Window(){
 	//delete rectangle;
+	if(texture)
+		SDL_DestroyTexture(texture);
 	SDL_DestroyRenderer(renderer);
 	SDL_DestroyWindow(window);
 	SDL_Quit();
@@ -94,6 +96,10 @@ void Window::drawLine(const int *x, const int *y, const size_t &N){
 }
 
 void Window::render(){
+	if(framebuffer){ // Upload the entire frame at once and stretch it to fill the window
+		SDL_UpdateTexture(texture, NULL, framebuffer, W * sizeof(uint32_t));
+		SDL_RenderCopy(renderer, texture, NULL, NULL);
+	}
 	SDL_RenderPresent(renderer);
 }
 
@@ -135,6 +141,7 @@ void Window::initialize(){
 	// Open the SDL window
 	SDL_Init(SDL_INIT_VIDEO);
 	SDL_CreateWindowAndRenderer(W*nMult, H*nMult, 0, &window, &renderer);
+	texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, W, H);
 	clear();
 	
 	init = true;
@@ -0,0 +1,64 @@
+#include "KeyStates.hpp"
+
+/////////////////////////////////////////////////////////////////////
+// class KeyStates
+/////////////////////////////////////////////////////////////////////
+
+KeyStates::KeyStates() : count(0), streamMode(false) {
+	reset();
+}
+
+void KeyStates::enableStreamMode(){
+	streamMode = true;
+	reset();
+}
+
+void KeyStates::disableStreamMode(){
+	streamMode = false;
+	reset();
+}
+
+bool KeyStates::poll(const unsigned char &key){ 
+	if(states[key]){
+		states[key] = false;
+		return true;
+	}
+	return false;
+}
+
+void KeyStates::keyDown(const unsigned char &key){
+	if(!streamMode){
+		if(!states[key]){
+			states[key] = true;
+			count++;
+		}
+	}
+	else{
+		buffer.push((char)key);
+	}
+}
+
+void KeyStates::keyUp(const unsigned char &key){
+	if(!streamMode){
+		if(states[key]){
+			states[key] = false;
+			count--;
+		}
+	}
+}
+
+bool KeyStates::get(char& key){
+	if(buffer.empty())
+		return false;
+	key = buffer.front();
+	buffer.pop();
+	return true;
+}
+
+void KeyStates::reset(){
+	for(int i = 0; i < 256; i++)
+		states[i] = false;
+	while(!buffer.empty())
+		buffer.pop();
+	count = 0;
+}
@@ -0,0 +1,532 @@
+#include <algorithm>
+#include <thread>
+#include <cstring>
+#include <cstdlib>
+
+#include "Upscaler.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define UPSCALER_SSE2
+	#include <emmintrin.h>
+#endif
+
+constexpr int PADDING = 2; ///< Number of edge pixels repeated around the border of the padded frame (required by xbr)
+
+constexpr unsigned int MAX_WORKER_THREADS = 7; ///< Maximum number of upscaler worker threads
+
+constexpr unsigned int XBR_EQUAL_THRESHOLD = 155; ///< YUV distance below which two xbr colors are considered equal
+
+// Indices of the xbr neighborhood of the center pixel E, relative to the bottom-right corner
+//        B
+//     D  E  F  F4
+//     G  H  I  I4
+//        H5 I5
+enum xbrNeighbor{ NE, NI, NH, NF, NG, NC, ND, NB, NF4, NI4, NH5, NI5, NUM_NEIGHBORS };
+
+const int xbrOffsets[NUM_NEIGHBORS][2] = {
+	{0, 0}, {1, 1}, {0, 1}, {1, 0}, {-1, 1}, {1, -1}, {-1, 0}, {0, -1}, {2, 0}, {2, 1}, {0, 2}, {1, 2}
+};
+
+/** Blend two packed colors, channel by channel
+  * @param dst Original color
+  * @param src Color blended into the original color
+  * @param w Weight of the blended color (out of 256)
+  */
+inline uint32_t blend(const uint32_t &dst, const uint32_t &src, const unsigned int &w){
+	uint32_t lo = ((((dst & 0x00FF00FF) * (256 - w)) + ((src & 0x00FF00FF) * w)) >> 8) & 0x00FF00FF;
+	uint32_t hi = (((((dst >> 8) & 0x00FF00FF) * (256 - w)) + (((src >> 8) & 0x00FF00FF) * w)) >> 8) & 0x00FF00FF;
+	return (lo | (hi << 8));
+}
+
+/** Get the distance between two packed YUV colors
+  */
+inline unsigned int yuvDiff(const uint32_t &a, const uint32_t &b){
+#ifdef UPSCALER_SSE2
+	// Sum of absolute differences of the packed components
+	return (unsigned int)_mm_cvtsi128_si32(_mm_sad_epu8(_mm_cvtsi32_si128((int)a), _mm_cvtsi32_si128((int)b)));
+#else
+	return (std::abs((int)(a >> 16) - (int)(b >> 16)) +
+	        std::abs((int)((a >> 8) & 0xFF) - (int)((b >> 8) & 0xFF)) +
+	        std::abs((int)(a & 0xFF) - (int)(b & 0xFF)));
+#endif
+}
+
+/** Convert a packed RGBA color to a packed YUV color (Y in bits 16-23, U in bits 8-15, V in bits 0-7)
+  */
+inline uint32_t toYUV(const uint32_t &color){
+	const unsigned char *rgb = reinterpret_cast<const unsigned char*>(&color);
+	int y = (299 * rgb[0] + 587 * rgb[1] + 114 * rgb[2]) / 1000;
+	int u = (-169 * rgb[0] - 331 * rgb[1] + 500 * rgb[2]) / 1000 + 128;
+	int v = (500 * rgb[0] - 419 * rgb[1] - 81 * rgb[2]) / 1000 + 128;
+	return (uint32_t)((y << 16) + (u << 8) + v);
+}
+
+Upscaler::Upscaler() :
+	filter(upscaleFilter::NONE),
+	factor(1),
+	width(0),
+	height(0),
+	stride(0),
+	padded(),
+	yuv(),
+	output(),
+	slots(),
+	neighbors(),
+	pool()
+{
+}
+
+bool Upscaler::setFilter(const upscaleFilter &filt, const unsigned int &N){
+	if(!isSupported(filt, N))
+		return false;
+	filter = filt;
+	factor = (filt != upscaleFilter::NONE ? N : 1);
+	if(filter == upscaleFilter::XBR)
+		setupXBR();
+	if(enabled() && pool.getNumberOfThreads() == 0){
+		// Leave one core each for the emulation and display threads
+		unsigned int nCores = std::thread::hardware_concurrency();
+		unsigned int nWorkers = (nCores > 2 ? nCores - 2 : 0);
+		if(nWorkers)
+			pool.resize(std::min(nWorkers, MAX_WORKER_THREADS));
+	}
+	return true;
+}
+
+std::string Upscaler::getName() const {
+	std::string N = std::to_string(factor) + "x";
+	switch(filter){
+		case upscaleFilter::NEAREST:
+			return "nearest" + N;
+		case upscaleFilter::SCALE2X:
+		case upscaleFilter::SCALE3X:
+			return "scale" + N;
+		case upscaleFilter::XBR:
+			return "xbr" + N;
+		default:
+			break;
+	}
+	return "none";
+}
+
+const uint32_t *Upscaler::process(const uint32_t *input, const int &W, const int &H){
+	if(W != width || H != height){
+		width = W;
+		height = H;
+		stride = W + 2 * PADDING;
+		padded.assign(stride * (H + 2 * PADDING), 0);
+		yuv.assign(padded.size(), 0);
+		if(filter == upscaleFilter::XBR) // Neighbor offsets depend on the width of the frame
+			setupXBR();
+	}
+	output.resize(width * height * factor * factor);
+
+	// Split the frame into bands of rows (the filters never write outside of their own band)
+	const unsigned int nBands = pool.getNumberOfThreads() + 1;
+	const int rowsPerBand = (height + nBands - 1) / nBands;
+	pool.run(nBands, [&](unsigned int band){
+		int y0 = std::min((int)band * rowsPerBand, height);
+		int y1 = std::min(y0 + rowsPerBand, height);
+		if(y0 < y1)
+			prepare(input, y0, y1);
+	});
+	pool.run(nBands, [&](unsigned int band){
+		int y0 = std::min((int)band * rowsPerBand, height);
+		int y1 = std::min(y0 + rowsPerBand, height);
+		switch(filter){
+			case upscaleFilter::SCALE2X:
+				scale2x(y0, y1);
+				break;
+			case upscaleFilter::SCALE3X:
+				scale3x(y0, y1);
+				break;
+			case upscaleFilter::XBR:
+				xbr(y0, y1);
+				break;
+			default:
+				nearest(y0, y1);
+				break;
+		}
+	});
+	return output.data();
+}
+
+bool Upscaler::isSupported(const upscaleFilter &filt, const unsigned int &N){
+	switch(filt){
+		case upscaleFilter::NONE:
+			return true;
+		case upscaleFilter::NEAREST:
+			return (N >= 1 && N <= 8);
+		case upscaleFilter::SCALE2X:
+			return (N == 2);
+		case upscaleFilter::SCALE3X:
+			return (N == 3);
+		case upscaleFilter::XBR:
+			return (N >= 2 && N <= 4);
+		default:
+			break;
+	}
+	return false;
+}
+
+bool Upscaler::parse(const std::string &str, upscaleFilter &filt, unsigned int &N){
+	if(str == "none"){
+		filt = upscaleFilter::NONE;
+		N = 1;
+		return true;
+	}
+	size_t digit = str.find_first_of("0123456789");
+	if(digit == std::string::npos || digit == 0)
+		return false;
+	std::string name = str.substr(0, digit);
+	std::string number = str.substr(digit);
+	if(!number.empty() && number.back() == 'x')
+		number.pop_back();
+	if(number.empty() || number.find_first_not_of("0123456789") != std::string::npos)
+		return false;
+	N = (unsigned int)strtoul(number.c_str(), NULL, 10);
+	if(name == "nearest")
+		filt = upscaleFilter::NEAREST;
+	else if(name == "scale")
+		filt = (N == 3 ? upscaleFilter::SCALE3X : upscaleFilter::SCALE2X);
+	else if(name == "xbr")
+		filt = upscaleFilter::XBR;
+	else
+		return false;
+	return isSupported(filt, N);
+}
+
+void Upscaler::prepare(const uint32_t *input, const int &y0, const int &y1){
+	// The first and last bands also fill in the border rows
+	int first = (y0 == 0 ? -PADDING : y0);
+	int last = (y1 == height ? height + PADDING : y1);
+	for(int y = first; y < last; y++){
+		const uint32_t *src = &input[std::min(std::max(y, 0), height - 1) * width];
+		uint32_t *dest = &padded[(y + PADDING) * stride];
+		for(int x = 0; x < PADDING; x++){
+			dest[x] = src[0];
+			dest[PADDING + width + x] = src[width - 1];
+		}
+		memcpy(&dest[PADDING], src, width * sizeof(uint32_t));
+		if(filter == upscaleFilter::XBR){
+			uint32_t *lum = &yuv[(y + PADDING) * stride];
+			for(int x = 0; x < stride; x++)
+				lum[x] = toYUV(dest[x]);
+		}
+	}
+}
+
+void Upscaler::nearest(const int &y0, const int &y1){
+	const int N = (int)factor;
+	const int outWidth = width * N;
+	for(int y = y0; y < y1; y++){
+		const uint32_t *src = &padded[(y + PADDING) * stride + PADDING];
+		uint32_t *dest = &output[y * N * outWidth];
+		int x = 0;
+#ifdef UPSCALER_SSE2
+		if(N == 2){
+			for(; x + 4 <= width; x += 4){
+				__m128i pixels = _mm_loadu_si128((const __m128i*)&src[x]);
+				_mm_storeu_si128((__m128i*)&dest[2 * x], _mm_unpacklo_epi32(pixels, pixels));
+				_mm_storeu_si128((__m128i*)&dest[2 * x + 4], _mm_unpackhi_epi32(pixels, pixels));
+			}
+		}
+		else if(N == 4){
+			for(; x + 4 <= width; x += 4){
+				__m128i pixels = _mm_loadu_si128((const __m128i*)&src[x]);
+				_mm_storeu_si128((__m128i*)&dest[4 * x], _mm_shuffle_epi32(pixels, 0x00));
+				_mm_storeu_si128((__m128i*)&dest[4 * x + 4], _mm_shuffle_epi32(pixels, 0x55));
+				_mm_storeu_si128((__m128i*)&dest[4 * x + 8], _mm_shuffle_epi32(pixels, 0xAA));
+				_mm_storeu_si128((__m128i*)&dest[4 * x + 12], _mm_shuffle_epi32(pixels, 0xFF));
+			}
+		}
+#endif
+		for(; x < width; x++)
+			std::fill_n(&dest[x * N], N, src[x]);
+		for(int i = 1; i < N; i++) // Repeat the first output row
+			memcpy(&dest[i * outWidth], dest, outWidth * sizeof(uint32_t));
+	}
+}
+
+void Upscaler::scale2x(const int &y0, const int &y1){
+	const int outWidth = width * 2;
+	for(int y = y0; y < y1; y++){
+		const uint32_t *src = &padded[(y + PADDING) * stride + PADDING];
+		uint32_t *dest0 = &output[2 * y * outWidth];
+		uint32_t *dest1 = &dest0[outWidth];
+		int x = 0;
+#ifdef UPSCALER_SSE2
+		for(; x + 4 <= width; x += 4){
+			__m128i B = _mm_loadu_si128((const __m128i*)&src[x - stride]);
+			__m128i D = _mm_loadu_si128((const __m128i*)&src[x - 1]);
+			__m128i E = _mm_loadu_si128((const __m128i*)&src[x]);
+			__m128i F = _mm_loadu_si128((const __m128i*)&src[x + 1]);
+			__m128i H = _mm_loadu_si128((const __m128i*)&src[x + stride]);
+
+			// Only expand pixels where B != H and D != F
+			__m128i mask = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi32(B, H), _mm_cmpeq_epi32(D, F)), _mm_set1_epi32(-1));
+			__m128i mDB = _mm_and_si128(mask, _mm_cmpeq_epi32(D, B));
+			__m128i mBF = _mm_and_si128(mask, _mm_cmpeq_epi32(B, F));
+			__m128i mDH = _mm_and_si128(mask, _mm_cmpeq_epi32(D, H));
+			__m128i mHF = _mm_and_si128(mask, _mm_cmpeq_epi32(H, F));
+			__m128i E0 = _mm_or_si128(_mm_and_si128(mDB, D), _mm_andnot_si128(mDB, E));
+			__m128i E1 = _mm_or_si128(_mm_and_si128(mBF, F), _mm_andnot_si128(mBF, E));
+			__m128i E2 = _mm_or_si128(_mm_and_si128(mDH, D), _mm_andnot_si128(mDH, E));
+			__m128i E3 = _mm_or_si128(_mm_and_si128(mHF, F), _mm_andnot_si128(mHF, E));
+
+			// Interleave the left and right output pixels
+			_mm_storeu_si128((__m128i*)&dest0[2 * x], _mm_unpacklo_epi32(E0, E1));
+			_mm_storeu_si128((__m128i*)&dest0[2 * x + 4], _mm_unpackhi_epi32(E0, E1));
+			_mm_storeu_si128((__m128i*)&dest1[2 * x], _mm_unpacklo_epi32(E2, E3));
+			_mm_storeu_si128((__m128i*)&dest1[2 * x + 4], _mm_unpackhi_epi32(E2, E3));
+		}
+#endif
+		for(; x < width; x++){
+			const uint32_t B = src[x - stride], D = src[x - 1], E = src[x], F = src[x + 1], H = src[x + stride];
+			if(B != H && D != F){
+				dest0[2 * x]     = (D == B ? D : E);
+				dest0[2 * x + 1] = (B == F ? F : E);
+				dest1[2 * x]     = (D == H ? D : E);
+				dest1[2 * x + 1] = (H == F ? F : E);
+			}
+			else{
+				dest0[2 * x] = dest0[2 * x + 1] = E;
+				dest1[2 * x] = dest1[2 * x + 1] = E;
+			}
+		}
+	}
+}
+
+void Upscaler::scale3x(const int &y0, const int &y1){
+	const int outWidth = width * 3;
+	for(int y = y0; y < y1; y++){
+		const uint32_t *src = &padded[(y + PADDING) * stride + PADDING];
+		uint32_t *dest[3] = { &output[3 * y * outWidth], &output[(3 * y + 1) * outWidth], &output[(3 * y + 2) * outWidth] };
+		int x = 0;
+#ifdef UPSCALER_SSE2
+		uint32_t block[9][4];
+		for(; x + 4 <= width; x += 4){
+			__m128i A = _mm_loadu_si128((const __m128i*)&src[x - stride - 1]);
+			__m128i B = _mm_loadu_si128((const __m128i*)&src[x - stride]);
+			__m128i C = _mm_loadu_si128((const __m128i*)&src[x - stride + 1]);
+			__m128i D = _mm_loadu_si128((const __m128i*)&src[x - 1]);
+			__m128i E = _mm_loadu_si128((const __m128i*)&src[x]);
+			__m128i F = _mm_loadu_si128((const __m128i*)&src[x + 1]);
+			__m128i G = _mm_loadu_si128((const __m128i*)&src[x + stride - 1]);
+			__m128i H = _mm_loadu_si128((const __m128i*)&src[x + stride]);
+			__m128i I = _mm_loadu_si128((const __m128i*)&src[x + stride + 1]);
+
+			// Only expand pixels where B != H and D != F
+			const __m128i ones = _mm_set1_epi32(-1);
+			__m128i mask = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi32(B, H), _mm_cmpeq_epi32(D, F)), ones);
+			__m128i DB = _mm_and_si128(mask, _mm_cmpeq_epi32(D, B));
+			__m128i BF = _mm_and_si128(mask, _mm_cmpeq_epi32(B, F));
+			__m128i DH = _mm_and_si128(mask, _mm_cmpeq_epi32(D, H));
+			__m128i HF = _mm_and_si128(mask, _mm_cmpeq_epi32(H, F));
+			__m128i nEA = _mm_andnot_si128(_mm_cmpeq_epi32(E, A), ones);
+			__m128i nEC = _mm_andnot_si128(_mm_cmpeq_epi32(E, C), ones);
+			__m128i nEG = _mm_andnot_si128(_mm_cmpeq_epi32(E, G), ones);
+			__m128i nEI = _mm_andnot_si128(_mm_cmpeq_epi32(E, I), ones);
+			__m128i m1 = _mm_or_si128(_mm_and_si128(DB, nEC), _mm_and_si128(BF, nEA));
+			__m128i m3 = _mm_or_si128(_mm_and_si128(DB, nEG), _mm_and_si128(DH, nEA));
+			__m128i m5 = _mm_or_si128(_mm_and_si128(BF, nEI), _mm_and_si128(HF, nEC));
+			__m128i m7 = _mm_or_si128(_mm_and_si128(DH, nEI), _mm_and_si128(HF, nEG));
+			_mm_storeu_si128((__m128i*)block[0], _mm_or_si128(_mm_and_si128(DB, D), _mm_andnot_si128(DB, E)));
+			_mm_storeu_si128((__m128i*)block[1], _mm_or_si128(_mm_and_si128(m1, B), _mm_andnot_si128(m1, E)));
+			_mm_storeu_si128((__m128i*)block[2], _mm_or_si128(_mm_and_si128(BF, F), _mm_andnot_si128(BF, E)));
+			_mm_storeu_si128((__m128i*)block[3], _mm_or_si128(_mm_and_si128(m3, D), _mm_andnot_si128(m3, E)));
+			_mm_storeu_si128((__m128i*)block[4], E);
+			_mm_storeu_si128((__m128i*)block[5], _mm_or_si128(_mm_and_si128(m5, F), _mm_andnot_si128(m5, E)));
+			_mm_storeu_si128((__m128i*)block[6], _mm_or_si128(_mm_and_si128(DH, D), _mm_andnot_si128(DH, E)));
+			_mm_storeu_si128((__m128i*)block[7], _mm_or_si128(_mm_and_si128(m7, H), _mm_andnot_si128(m7, E)));
+			_mm_storeu_si128((__m128i*)block[8], _mm_or_si128(_mm_and_si128(HF, F), _mm_andnot_si128(HF, E)));
+
+			// Interleave the output pixels of all four input pixels
+			for(int i = 0; i < 4; i++){
+				for(int row = 0; row < 3; row++){
+					uint32_t *ptr = &dest[row][3 * (x + i)];
+					ptr[0] = block[3 * row][i];
+					ptr[1] = block[3 * row + 1][i];
+					ptr[2] = block[3 * row + 2][i];
+				}
+			}
+		}
+#endif
+		for(; x < width; x++){
+			const uint32_t A = src[x - stride - 1], B = src[x - stride], C = src[x - stride + 1];
+			const uint32_t D = src[x - 1], E = src[x], F = src[x + 1];
+			const uint32_t G = src[x + stride - 1], H = src[x + stride], I = src[x + stride + 1];
+			uint32_t *ptr0 = &dest[0][3 * x];
+			uint32_t *ptr1 = &dest[1][3 * x];
+			uint32_t *ptr2 = &dest[2][3 * x];
+			if(B != H && D != F){
+				ptr0[0] = (D == B ? D : E);
+				ptr0[1] = ((D == B && E != C) || (B == F && E != A) ? B : E);
+				ptr0[2] = (B == F ? F : E);
+				ptr1[0] = ((D == B && E != G) || (D == H && E != A) ? D : E);
+				ptr1[1] = E;
+				ptr1[2] = ((B == F && E != I) || (H == F && E != C) ? F : E);
+				ptr2[0] = (D == H ? D : E);
+				ptr2[1] = ((D == H && E != I) || (H == F && E != G) ? H : E);
+				ptr2[2] = (H == F ? F : E);
+			}
+			else{
+				std::fill_n(ptr0, 3, E);
+				std::fill_n(ptr1, 3, E);
+				std::fill_n(ptr2, 3, E);
+			}
+		}
+	}
+}
+
+void Upscaler::xbr(const int &y0, const int &y1){
+	const int N = (int)factor;
+	const int outWidth = width * N;
+	uint32_t block[16];
+	for(int y = y0; y < y1; y++){
+		const uint32_t *src = &padded[(y + PADDING) * stride + PADDING];
+		const uint32_t *lum = &yuv[(y + PADDING) * stride + PADDING];
+		uint32_t *dest = &output[y * N * outWidth];
+		for(int x = 0; x < width; x++){
+			xbrBlock(&src[x], &lum[x], block);
+			for(int row = 0; row < N; row++)
+				memcpy(&dest[row * outWidth + x * N], &block[row * N], N * sizeof(uint32_t));
+		}
+	}
+}
+
+void Upscaler::xbrBlock(const uint32_t *src, const uint32_t *lum, uint32_t *block) const {
+	const int N = (int)factor;
+	const uint32_t pe = src[0];
+	std::fill_n(block, N * N, pe);
+
+	// Process the bottom-right, top-right, top-left, and bottom-left corners (in that order) by rotating the neighborhood
+	for(int r = 0; r < 4; r++){
+		const int *n = neighbors[r];
+		const unsigned char *s = slots[r];
+		const uint32_t ph = src[n[NH]], pf = src[n[NF]];
+		if(pe == ph || pe == pf)
+			continue;
+		#define DF(P1, P2) yuvDiff(lum[n[P1]], lum[n[P2]])
+		#define EQ(P1, P2) (DF(P1, P2) < XBR_EQUAL_THRESHOLD)
+		unsigned int e = DF(NE, NC) + DF(NE, NG) + DF(NI, NH5) + DF(NI, NF4) + (DF(NH, NF) << 2);
+		unsigned int i = DF(NH, ND) + DF(NH, NI5) + DF(NF, NI4) + DF(NF, NB) + (DF(NE, NI) << 2);
+		uint32_t px = (DF(NE, NF) <= DF(NE, NH) ? pf : ph);
+		if(e < i && ((!EQ(NF, NB) && !EQ(NH, ND)) || (EQ(NE, NI) && !EQ(NF, NI4) && !EQ(NH, NI5)) || EQ(NE, NG) || EQ(NE, NC))){
+			const unsigned int ke = DF(NF, NG);
+			const unsigned int ki = DF(NH, NC);
+			const bool ex2 = (pe != src[n[NC]] && src[n[NB]] != src[n[NC]]);
+			const bool ex3 = (pe != src[n[NG]] && src[n[ND]] != src[n[NG]]);
+			const bool left = ((ke << 1) <= ki && ex3); // Shallow edge
+			const bool up = (ke >= (ki << 1) && ex2); // Steep edge
+			// Output slots are numbered from the top-left of the bottom-right oriented block
+			if(N == 2){
+				if(left && up){
+					block[s[3]] = blend(block[s[3]], px, 192);
+					block[s[2]] = blend(block[s[2]], px, 64);
+					block[s[1]] = block[s[2]];
+				}
+				else if(left){
+					block[s[3]] = blend(block[s[3]], px, 192);
+					block[s[2]] = blend(block[s[2]], px, 64);
+				}
+				else if(up){
+					block[s[3]] = blend(block[s[3]], px, 192);
+					block[s[1]] = blend(block[s[1]], px, 64);
+				}
+				else
+					block[s[3]] = blend(block[s[3]], px, 128);
+			}
+			else if(N == 3){
+				if(left && up){
+					block[s[7]] = blend(block[s[7]], px, 192);
+					block[s[6]] = blend(block[s[6]], px, 64);
+					block[s[5]] = block[s[7]];
+					block[s[2]] = block[s[6]];
+					block[s[8]] = px;
+				}
+				else if(left){
+					block[s[7]] = blend(block[s[7]], px, 192);
+					block[s[5]] = blend(block[s[5]], px, 64);
+					block[s[6]] = blend(block[s[6]], px, 64);
+					block[s[8]] = px;
+				}
+				else if(up){
+					block[s[5]] = blend(block[s[5]], px, 192);
+					block[s[7]] = blend(block[s[7]], px, 64);
+					block[s[2]] = blend(block[s[2]], px, 64);
+					block[s[8]] = px;
+				}
+				else{
+					block[s[8]] = blend(block[s[8]], px, 224);
+					block[s[5]] = blend(block[s[5]], px, 32);
+					block[s[7]] = blend(block[s[7]], px, 32);
+				}
+			}
+			else{
+				if(left && up){
+					block[s[13]] = blend(block[s[13]], px, 192);
+					block[s[12]] = blend(block[s[12]], px, 64);
+					block[s[15]] = block[s[14]] = block[s[11]] = px;
+					block[s[10]] = block[s[3]] = block[s[12]];
+					block[s[7]] = block[s[13]];
+				}
+				else if(left){
+					block[s[11]] = blend(block[s[11]], px, 192);
+					block[s[13]] = blend(block[s[13]], px, 192);
+					block[s[10]] = blend(block[s[10]], px, 64);
+					block[s[12]] = blend(block[s[12]], px, 64);
+					block[s[14]] = block[s[15]] = px;
+				}
+				else if(up){
+					block[s[14]] = blend(block[s[14]], px, 192);
+					block[s[7]] = blend(block[s[7]], px, 192);
+					block[s[10]] = blend(block[s[10]], px, 64);
+					block[s[3]] = blend(block[s[3]], px, 64);
+					block[s[11]] = block[s[15]] = px;
+				}
+				else{
+					block[s[11]] = blend(block[s[11]], px, 128);
+					block[s[14]] = blend(block[s[14]], px, 128);
+					block[s[15]] = px;
+				}
+			}
+		}
+		else if(e <= i){ // Weak edge, only soften the corner pixel
+			const int corner = N * N - 1;
+			block[s[corner]] = blend(block[s[corner]], px, (N == 2 ? 64 : 128));
+		}
+		#undef DF
+		#undef EQ
+	}
+}
+
+void Upscaler::setupXBR(){
+	const int N = (int)factor;
+	for(int r = 0; r < 4; r++){
+		// Rotate the neighborhood by 90 degrees counter-clockwise for each corner, (x, y) -> (y, -x)
+		for(int i = 0; i < NUM_NEIGHBORS; i++){
+			int dx = xbrOffsets[i][0];
+			int dy = xbrOffsets[i][1];
+			for(int j = 0; j < r; j++){
+				int tmp = dx;
+				dx = dy;
+				dy = -tmp;
+			}
+			neighbors[r][i] = dy * stride + dx;
+		}
+		// Rotate the output slots about the center of the block (coordinates are doubled to keep them integral)
+		for(int row = 0; row < N; row++){
+			for(int col = 0; col < N; col++){
+				int cx = 2 * col - (N - 1);
+				int cy = 2 * row - (N - 1);
+				for(int j = 0; j < r; j++){
+					int tmp = cx;
+					cx = cy;
+					cy = -tmp;
+				}
+				slots[r][row * N + col] = (unsigned char)(((cy + N - 1) / 2) * N + (cx + N - 1) / 2);
+			}
+		}
+	}
+}
@@ -102,6 +102,24 @@ ColorRGB& ColorRGB::operator /= (const float &rhs){
 	return ((*this) = (*this) / rhs);
 }
 
+uint32_t ColorRGB::toRGBA(const float &alpha/*=1*/) const {
+#ifdef USE_SDL_RENDERER
+	return packRGBA(r, g, b, toUChar(alpha));
+#else
+	return packRGBA(toUChar(r), toUChar(g), toUChar(b), toUChar(alpha));
+#endif
+}
+
+uint32_t ColorRGB::packRGBA(const unsigned char &red, const unsigned char &green, const unsigned char &blue, const unsigned char &alpha/*=255*/){
+	uint32_t retval;
+	unsigned char *ptr = reinterpret_cast<unsigned char*>(&retval);
+	ptr[0] = red;
+	ptr[1] = green;
+	ptr[2] = blue;
+	ptr[3] = alpha;
+	return retval;
+}
+
 void ColorRGB::dump() const {
 	std::cout << "r=" << (int)r << ", g=" << (int)g << ", b=" << (int)b << std::endl;
 }
@@ -0,0 +1,96 @@
+#ifndef BLOCK_CACHE_HPP
+#define BLOCK_CACHE_HPP
+
+#include <vector>
+#include <unordered_map>
+
+/** Compiled native code for a translated block
+  * @param cpu Pointer to the CPU which executes the block
+  * @param state Pointer to the CPU state of the block currently being executed
+  */
+typedef void (*NativeBlockFunc)(void *cpu, void *state);
+
+class TranslatedInstruction{
+public:
+	unsigned short nPC; ///< Memory address of the first byte of the instruction
+
+	unsigned char nBytes; ///< Length of the instruction in bytes (including the CB prefix)
+
+	unsigned char nIndex; ///< Opcode index
+
+	unsigned char d8; ///< 8-bit immediate data
+
+	unsigned char d16h; ///< High 8 bits of 16-bit immediate data
+
+	unsigned char d16l; ///< Low 8 bits of 16-bit immediate data
+
+	bool cbPrefix; ///< Set if the opcode is a CB prefix opcode
+
+	/** Default constructor
+	  */
+	TranslatedInstruction() :
+		nPC(0),
+		nBytes(0),
+		nIndex(0),
+		d8(0),
+		d16h(0),
+		d16l(0),
+		cbPrefix(false)
+	{
+	}
+};
+
+class TranslatedBlock{
+public:
+	unsigned int nExecutions; ///< Number of times the block was interpreted before being translated
+
+	std::vector<TranslatedInstruction> instructions; ///< Pre-decoded straight-line instructions, ending with a control flow instruction
+
+	NativeBlockFunc nativeCode; ///< Compiled native code for the block (or null if the block is not compiled)
+
+	bool compiled; ///< Set if the block has been passed to the native code compiler
+
+	/** Default constructor
+	  */
+	TranslatedBlock() :
+		nExecutions(0),
+		instructions(),
+		nativeCode(0x0),
+		compiled(false)
+	{
+	}
+
+	/** Return true if the block has been translated
+	  */
+	bool translated() const {
+		return !instructions.empty();
+	}
+};
+
+class BlockCache{
+public:
+	/** Default constructor
+	  */
+	BlockCache();
+
+	/** Get the block beginning at the specified address, creating a new (untranslated) block if one does not exist
+	  * Only blocks in cartridge ROM are cached since ROM may not be modified by the running program.
+	  * @param pc Memory address of the first instruction of the block
+	  * @param romBank Currently selected cartridge ROM bank
+	  * @return Pointer to the block, or null if blocks at the specified address are not cached
+	  */
+	TranslatedBlock *get(const unsigned short &pc, const unsigned short &romBank);
+
+	/** Get the number of translated blocks
+	  */
+	unsigned int getNumberOfBlocks() const ;
+
+	/** Remove all blocks
+	  */
+	void clear();
+
+private:
+	std::unordered_map<unsigned int, TranslatedBlock> blocks; ///< Map of blocks keyed by ROM bank and address
+};
+
+#endif
@@ -3,14 +3,20 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include <cstdint>
 
 #include "colors.hpp"
-#include "ColorGBC.hpp"
 #include "SystemComponent.hpp"
 #include "SpriteAttributes.hpp"
+#include "TileCache.hpp"
+#include "ScanlineCompositor.hpp"
+#include "Upscaler.hpp"
+#include "KeyStates.hpp"
 
 class Register;
 class Window;
+class DisplayThread;
 class ConsoleGBC;
 
 class GPU : public SystemComponent {
@@ -69,10 +75,12 @@ public:
 	unsigned short drawNextScanline(SpriteHandler *oam);
 
 	/** Draw the current screen buffer
+	  * When the display thread is in use, the frame is handed off to it and this call never blocks.
 	  */
 	void render();
 
 	/** Process OpenGL window events
+	  * When the display thread is in use, keyboard events received by the display thread are applied to the window's KeyStates.
 	  */
 	void processEvents();
 
@@ -82,10 +90,78 @@ public:
 		return window.get(); 
 	}
 
+	/** Get pointer to the packed RGBA framebuffer (160x144 pixels, row-major)
+	  */
+	const uint32_t *getFramebuffer() const {
+		return framebuffer.data();
+	}
+
+	/** Mark the cached tile bitmap containing a VRAM address in the currently selected bank as modified
+	  * Should be called whenever VRAM is written to without using write().
+	  * @param loc Memory address which was written to [0x8000,0xA000)
+	  */
+	void invalidateTile(const unsigned short &loc){
+		tiles.invalidate(loc - offset, bs);
+	}
+
+	/** Mark all cached tile bitmaps as modified
+	  * Should be called whenever the contents of VRAM are replaced (e.g. when loading a savestate).
+	  */
+	void invalidateTileCache(){
+		tiles.clear();
+	}
+
+	/** Get a hash of the current contents of the framebuffer
+	  * Identical frames always produce identical hashes, regardless of the compositing method used.
+	  */
+	unsigned long long getFrameHash() const ;
+
+	/** Get the name of the method used to mix the drawing layers
+	  */
+	std::string getCompositorMethod() const {
+		return compositor.getMethod();
+	}
+
+	/** Mark the scanline sprite lists as out of date
+	  * Should be called whenever the contents of OAM are replaced (e.g. when loading a savestate).
+	  */
+	void invalidateSpriteIndex(){
+		spriteIndexHeight = 0;
+	}
+
 	/** Get the status of the OpenGL window
 	  */
 	bool getWindowStatus();
 
+	/** Return true if the output window has no display
+	  */
+	bool isHeadless() const {
+		return headless;
+	}
+
+	/** Run without a display (must be called before initialize())
+	  * No window is opened, frames are only written to the framebuffer.
+	  */
+	void setHeadless(bool state=true){
+		headless = state;
+	}
+
+	/** Queue a keyboard event to be applied to the window's KeyStates on the next call to processEvents()
+	  * May be called by a single thread other than the emulation thread.
+	  * @return True if the event was queued and return false if the queue is full
+	  */
+	bool injectKeyEvent(const KeyEvent &evt){
+		return injectedKeys.push(evt);
+	}
+
+	/** Set keyboard keys to behave as a stream buffer (with key repeat)
+	  */
+	void setKeyboardStreamMode();
+
+	/** Set keyboard keys to behave as button toggles (without key repeat)
+	  */
+	void setKeyboardToggleMode();
+
 	/** Get the number of sprites drawn on the most recent LCD scanline
 	  */
 	unsigned char getSpritesDrawn() const {
@@ -108,6 +184,23 @@ public:
 	  */
 	void setPixelScale(const unsigned int &n);
 
+	/** Set the pixel scaling factor and the CPU upscaling filter
+	  * @param str Integer scaling factor (scaled by OpenGL) or upscaling filter name (e.g. "scale2x" or "xbr4x")
+	  * @return True if the filter and scaling factor are supported and return false otherwise
+	  */
+	bool setPixelScale(const std::string &str);
+
+	/** Enable or disable CGB LCD color correction for GBC palette colors
+	  * The 15-bit color correction table is computed the first time correction is enabled.
+	  * Only colors written to the palettes after this call are affected.
+	  */
+	void setColorCorrection(bool state=true);
+
+	/** Recompute all RGB palette colors from the current palette data
+	  * Should be called whenever palette data is replaced (e.g. when loading a savestate).
+	  */
+	void refreshPalettes();
+
 	/** Print a string to the interpreter console
 	  */
 	void print(const std::string &str, const unsigned char &x, const unsigned char &y);
@@ -127,6 +220,12 @@ public:
 private:
 	bool winDisplayEnable; ///< Set to true if the window layer is enabled and is on screen
 
+	bool headless; ///< Set if no window is opened
+
+	unsigned int pixelScale; ///< Integer pixel scaling factor of the output window
+
+	upscaleFilter pixelFilter; ///< CPU upscaling filter applied to the output window
+
 	unsigned char nSpritesDrawn; ///< Number of sprites drawn on the most recent scanline
 
 	unsigned char bgPaletteIndex; ///< Current index in the background palette data array
@@ -141,19 +240,47 @@ private:
 
 	ColorRGB cgbPaletteColor[16][4]; ///< RGB colors for GBC background and sprite palettes 0-7
 
+	uint32_t cgbPaletteRGBA[16][4]; ///< Packed RGBA colors for GBC background and sprite palettes 0-7
+
+	bool useColorCorrection; ///< Set if GBC palette colors are passed through the color correction table
+
+	bool paletteTableCGB; ///< Set if the packed RGBA palette table was built for GBC mode
+
+	std::vector<uint32_t> colorCorrectionTable; ///< Corrected packed RGBA colors for all 15-bit GBC colors
+
+	std::vector<uint32_t> framebuffer; ///< Packed RGBA LCD framebuffer, uploaded to the window once per frame
+
 	std::unique_ptr<Window> window; ///< Pointer to the main renderer window
+
+	std::unique_ptr<DisplayThread> displayThread; ///< Thread which owns the window's rendering context (null if rendering synchronously)
+
+	KeyEventQueue injectedKeys; ///< Keyboard events injected programmatically
 	
 	std::unique_ptr<ConsoleGBC> console; ///< Pointer to the console object used for printing text.
 	
-	ColorGBC currentLineSprite[256]; ///< Pixel color and palette information for the current sprite layer scanline
+	LayerLine currentLineSprite; ///< Pixel color and palette information for the current sprite layer scanline
 	
-	ColorGBC currentLineWindow[256]; ///< Pixel color and palette information for the current window layer scanline
+	LayerLine currentLineWindow; ///< Pixel color and palette information for the current window layer scanline
 	
-	ColorGBC currentLineBackground[256]; ///< Pixel color and palette information for the current background layer scanline
+	LayerLine currentLineBackground; ///< Pixel color and palette information for the current background layer scanline
+
+	ScanlineCompositor compositor; ///< Mixes the background, window, and sprite layers into LCD screen pixels
+
+	uint32_t paletteRGBA[64]; ///< Packed RGBA colors of all palettes, indexed by (4 * palette number + color index)
 
 	bool userLayerEnable[3]; ///< Flags for the three render layers.
 
-	std::vector<SpriteAttributes> sprites; ///< List of all currently active sprites
+	SpriteAttributes spriteTable[40]; ///< Decoded attributes of all sprites in OAM
+
+	unsigned char lineSprites[144][10]; ///< OAM indices of the sprites on each LCD scanline, in drawing priority order
+
+	unsigned char lineSpriteCount[144]; ///< Number of sprites on each LCD scanline
+
+	unsigned char spriteIndexHeight; ///< Sprite height (in pixels) used to build the scanline sprite lists (0 if the lists must be rebuilt)
+
+	bool spriteIndexCGB; ///< Set if the scanline sprite lists were built for GBC mode
+
+	TileCache tiles; ///< Decoded tile bitmaps for both VRAM banks
 
 	/** Retrieve the color of a pixel in a tile bitmap.
 	  * @param index The start address of the tile in VRAM [0x0000,0x1800].
@@ -172,14 +299,20 @@ private:
 	  * @param line Array of all pixels for the currnt scanline.
 	  * @return The number of pixels drawn.
 	  */
-	unsigned char drawTile(const unsigned char &x, const unsigned char &y, const unsigned char &x0, const unsigned short &offset, ColorGBC *line);
+	unsigned char drawTile(const unsigned char &x, const unsigned char &y, const unsigned char &x0, const unsigned short &offset, LayerLine &line);
 
-	/** Draw the current sprite.
-	  * @param y The current LCD screen scanline [0,144).
+	/** Draw one line of a sprite.
+	  * @param row The vertical pixel row of the sprite to draw, where the top-most row is denoted as row=0.
 	  * @param oam The currently selected sprite to draw.
-	  * @return Returns true if the current scanline passes through the sprite and return false otherwise.
 	  */	
-	bool drawSprite(const unsigned char &y, const SpriteAttributes &oam);
+	void drawSprite(const unsigned char &row, const SpriteAttributes &oam);
+
+	/** Decode all modified sprites and rebuild the lists of sprites on each LCD scanline.
+	  * Sprites are selected for each scanline in OAM order (up to 10 per line) and are then
+	  * sorted by drawing priority.
+	  * @param oam Pointer to the system sprite manager
+	  */
+	void updateSpriteIndex(SpriteHandler *oam);
 	
 	/** Get the real RGB values for a 15-bit GBC format color.
 	  * @param low The low byte (RED and lower 3 bits of GREEN) of the GBC color.
@@ -187,6 +320,23 @@ private:
 	  */
 	ColorRGB getColorRGB(const unsigned char &low, const unsigned char &high);
 	
+	/** Get the packed RGBA color for a 15-bit GBC format color (with color correction, if enabled).
+	  * @param low The low byte (RED and lower 3 bits of GREEN) of the GBC color.
+	  * @param high The high byte (upper 2 bits of GREEN and BLUE) of the GBC color.
+	  */
+	uint32_t getColorRGBA(const unsigned char &low, const unsigned char &high);
+
+	/** Rebuild the packed RGBA palette table used for scanline output.
+	  * In GBC mode the table contains all background and sprite palettes. In DMG mode it contains
+	  * the BGP, OBP0, and OBP1 palettes mapped onto the four DMG colors.
+	  */
+	void updatePaletteTable();
+
+	/** Update one DMG palette in the packed RGBA palette table (DMG mode only).
+	  * @param index DMG palette index (0: BGP, 1: OBP0, 2: OBP1)
+	  */
+	void updateDmgPalette(const unsigned char &index);
+
 	/** Update true RGB background palette by converting GBC format colors.
 	  * The color pointed to by the current bgPaletteIndex (register 0xFF68) will be udpated.
 	  */
@@ -200,6 +350,13 @@ private:
 	/** Return true if the window layer is enabled and is on screen
 	  */
 	bool checkWindowVisible();
+
+	/** Mark the cached tile bitmap containing the VRAM address being written to as modified
+	  */
+	bool preWriteAction() override {
+		tiles.invalidate(writeLoc - offset, writeBank);
+		return true;
+	}
 	
 	/** Add elements to a list of values which will be written to / read from an emulator savestate
 	  */
@@ -0,0 +1,85 @@
+#ifndef INSTRUCTION_CACHE_HPP
+#define INSTRUCTION_CACHE_HPP
+
+#include <vector>
+
+class Opcode;
+
+class DecodedInstruction{
+public:
+	Opcode *op; ///< Pointer to the decoded opcode (or null if the entry is not valid)
+
+	unsigned char nIndex; ///< Opcode index
+
+	unsigned char d8; ///< 8-bit immediate data
+
+	unsigned char d16h; ///< High 8 bits of 16-bit immediate data
+
+	unsigned char d16l; ///< Low 8 bits of 16-bit immediate data
+
+	bool cbPrefix; ///< Set if the opcode is a CB prefix opcode
+
+	/** Default constructor
+	  */
+	DecodedInstruction() :
+		op(0x0),
+		nIndex(0),
+		d8(0),
+		d16h(0),
+		d16l(0),
+		cbPrefix(false)
+	{
+	}
+
+	/** Return true if the entry contains a decoded instruction
+	  */
+	bool valid() const {
+		return (op != 0x0);
+	}
+};
+
+class InstructionCache{
+public:
+	/** Default constructor
+	  */
+	InstructionCache();
+
+	/** Get the cache entry for the instruction beginning at the specified address
+	  * Only instructions in cartridge ROM, work RAM (WRAM), and high RAM (HRAM) are cached.
+	  * @param pc Memory address of the first byte of the instruction
+	  * @param romBank Currently selected cartridge ROM bank
+	  * @param wramBank Currently selected WRAM bank
+	  * @return Pointer to the cache entry, or null if instructions at the specified address are not cached
+	  */
+	DecodedInstruction *get(const unsigned short &pc, const unsigned short &romBank, const unsigned short &wramBank);
+
+	/** Store a decoded instruction in the cache
+	  * Instructions which cross a 4 kB memory page boundary are not stored.
+	  * @param pc Memory address of the first byte of the instruction
+	  * @param nBytes Length of the instruction in bytes
+	  * @param romBank Currently selected cartridge ROM bank
+	  * @param wramBank Currently selected WRAM bank
+	  * @param instr Decoded instruction
+	  */
+	void store(const unsigned short &pc, const unsigned short &nBytes, const unsigned short &romBank, const unsigned short &wramBank, const DecodedInstruction &instr);
+
+	/** Invalidate all cached instructions which contain the specified memory address
+	  * Should be called whenever WRAM or HRAM is written to.
+	  * @param loc Memory address which was written to
+	  * @param wramBank Currently selected WRAM bank
+	  */
+	void invalidate(const unsigned short &loc, const unsigned short &wramBank);
+
+	/** Invalidate all cached instructions
+	  */
+	void clear();
+
+private:
+	std::vector<std::vector<DecodedInstruction> > rom; ///< Decoded ROM instructions for each 16 kB ROM bank (allocated as banks are executed)
+
+	std::vector<DecodedInstruction> wram; ///< Decoded WRAM instructions (bank 0 followed by banks 1-7)
+
+	std::vector<DecodedInstruction> hram; ///< Decoded HRAM instructions
+};
+
+#endif
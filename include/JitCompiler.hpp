@@ -0,0 +1,169 @@
+#ifndef JIT_COMPILER_HPP
+#define JIT_COMPILER_HPP
+
+#include <vector>
+#include <cstdint>
+
+#include "BlockCache.hpp"
+
+class Opcode;
+
+/** Location of the CPU registers and the CPU callbacks used by compiled blocks
+  * Register locations are byte offsets from the start of the CPU object which is passed to the compiled block.
+  */
+class JitLayout{
+public:
+	int regOffset[8]; ///< Offsets of the 8-bit registers, indexed by LR35902 operand encoding (B C D E H L - A)
+
+	int offsetF; ///< Offset of the flags register
+
+	int offsetSP; ///< Offset of the 16-bit stack pointer
+
+	Opcode *opcodes; ///< Standard opcode table
+
+	Opcode *opcodesCB; ///< CB prefix opcode table
+
+	/** Execute one instruction of the block through the CPU
+	  * @return True if the block must be exited
+	  */
+	bool (*step)(void *state, unsigned int index);
+
+	/** Prepare to execute a segment of native instructions
+	  * @return 0 if the native code should be run, 1 if the segment was already executed by the CPU, or 2 if the block must be exited
+	  */
+	int (*enterSegment)(void *state, unsigned int first, unsigned int count, unsigned int nCycles);
+
+	/** Advance the system clock and update the CPU after a segment of native instructions has been run
+	  */
+	void (*leaveSegment)(void *state, unsigned int first, unsigned int count, unsigned int nCycles);
+
+	/** Write a native instruction to the instruction trace before it is run (or null if tracing is disabled)
+	  */
+	void (*trace)(void *state, unsigned int index);
+
+	/** Default constructor
+	  */
+	JitLayout() :
+		regOffset(),
+		offsetF(0),
+		offsetSP(0),
+		opcodes(0x0),
+		opcodesCB(0x0),
+		step(0x0),
+		enterSegment(0x0),
+		leaveSegment(0x0),
+		trace(0x0)
+	{
+	}
+};
+
+/** Native x86-64 code generator for translated blocks of LR35902 instructions
+  * Instructions which only operate on CPU registers (8-bit and 16-bit loads, arithmetic, logic, rotates, shifts, and
+  * bit operations) are compiled into native code which updates the registers and the flags in place. Runs of these
+  * instructions are grouped into segments, and the system clock is advanced once at the end of each segment. All
+  * other instructions (memory accesses, control flow, and anything with side effects) are executed by calling back
+  * into the CPU. Compiled code is only generated on x86-64 hosts which support executable memory mappings.
+  */
+class JitCompiler{
+public:
+	/** Default constructor
+	  */
+	JitCompiler();
+
+	/** Destructor
+	  */
+	~JitCompiler();
+
+	/** Return true if native code may be generated on the host
+	  */
+	static bool isSupported();
+
+	/** Set the location of the CPU registers and callbacks
+	  */
+	void setLayout(const JitLayout &layout_){
+		layout = layout_;
+	}
+
+	/** Get the total size of all generated code (in bytes)
+	  */
+	size_t getCodeSize() const ;
+
+	/** Compile a translated block to native code
+	  * @return Pointer to the compiled block, or null if the block contains no instructions which benefit from compilation
+	  */
+	NativeBlockFunc compile(const TranslatedBlock *block);
+
+	/** Release all generated code
+	  * Pointers to previously compiled blocks are no longer valid.
+	  */
+	void clear();
+
+private:
+	class CodeChunk{
+	public:
+		unsigned char *base; ///< Start of the executable memory mapping
+
+		size_t size; ///< Size of the mapping (in bytes)
+
+		size_t used; ///< Number of bytes of the mapping which contain code
+	};
+
+	JitLayout layout; ///< Location of the CPU registers and callbacks
+
+	std::vector<CodeChunk> chunks; ///< Executable memory mappings holding compiled blocks
+
+	std::vector<unsigned char> code; ///< Code buffer for the block currently being compiled
+
+	std::vector<size_t> exitJumps; ///< Code buffer offsets of jumps to the block epilogue
+
+	/** Return true if an instruction only operates on CPU registers and may be compiled to native code
+	  */
+	bool isNative(const TranslatedInstruction &instr) const ;
+
+	/** Get the number of machine cycles taken by an instruction
+	  */
+	unsigned short getCycles(const TranslatedInstruction &instr) const ;
+
+	/** Copy the code buffer into executable memory
+	  * @return Pointer to the start of the code, or null if executable memory could not be allocated
+	  */
+	NativeBlockFunc install();
+
+	void emit(const std::vector<unsigned char> &bytes);
+
+	void emit32(const uint32_t &value);
+
+	void emit64(const uint64_t &value);
+
+	/** Emit an instruction with a [rbx + disp32] memory operand (CPU register access)
+	  */
+	void emitMem(const unsigned char &opcode, const unsigned char &reg, const int &offset);
+
+	/** Emit a call to a CPU callback (first argument is the block state)
+	  */
+	void emitCall(const void *func, const unsigned int &arg1, const unsigned int &arg2=0, const unsigned int &arg3=0);
+
+	/** Emit a conditional jump to the block epilogue
+	  */
+	void emitExitJump(const unsigned char &condition);
+
+	/** Convert the host flags saved by LAHF into LR35902 flags (Z, H, and C) in AL
+	  */
+	void emitFlagsFromHost();
+
+	/** Set the LR35902 zero flag from AL, combined with the flags in CL (if combine is set), and store them
+	  */
+	void emitStoreZeroFlag(const unsigned char &extraFlags, bool combine);
+
+	/** Copy the LR35902 carry flag into the host carry flag
+	  */
+	void emitLoadCarry();
+
+	/** Emit native code for a single instruction
+	  */
+	void emitInstruction(const TranslatedInstruction &instr);
+
+	void emitInstructionCB(const TranslatedInstruction &instr);
+};
+
+#endif
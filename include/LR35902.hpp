@@ -3,9 +3,13 @@
 
 #include <string>
 #include <map>
+#include <fstream>
 
 #include "Opcode.hpp"
 #include "SystemComponent.hpp"
+#include "InstructionCache.hpp"
+#include "BlockCache.hpp"
+#include "JitCompiler.hpp"
 
 extern const unsigned char FLAG_Z_BIT;
 extern const unsigned char FLAG_S_BIT;
@@ -18,6 +22,7 @@ extern const unsigned char FLAG_H_MASK;
 extern const unsigned char FLAG_C_MASK;
 
 class LR35902;
+class Scheduler;
 
 typedef unsigned short (LR35902::*addrGetFunc)() const;
 typedef unsigned char (LR35902::*regGet8bit)() const;
@@ -29,6 +34,8 @@ class LR35902 : public SystemComponent {
 public:
 	enum class cpuRegister{A, B, C, D, E, F, H, L, AF, BC, DE, HL, PC, SP};
 
+	enum class flagOperation{NONE, ADD, SUB, INC, DEC};
+
 	LR35902() : 
 		SystemComponent("CPU", 0x20555043), // "CPU "
 		halfCarry(false), 
@@ -41,13 +48,31 @@ public:
 		H(0),
 		L(0), 
 		F(0), 
+		lastFlagOperation(flagOperation::NONE),
+		flagArg1(0),
+		flagArg2(0),
+		flagResult(0),
+		flagCarry(false),
 	    d8(0),
 		d16h(0),
 		d16l(0), 
 		memoryValue(0),
 		memoryAddress(0),
 		SP(0), 
-		PC(0) { }
+		PC(0),
+		nInstructions(0),
+		useBlockEngine(false),
+		useJitEngine(false),
+		blockStart(true),
+		blockTerminator(),
+		idleLoopUnsafe(),
+		idleLoopValid(false),
+		idleLoopTainted(true),
+		idleLoopDetected(false),
+		idleLoopStart(0),
+		idleLoopSP(0),
+		idleLoopState(0),
+		nIdleCycles(0) { }
 
 	void initialize();
 
@@ -62,12 +87,65 @@ public:
 	  */
 	bool onClockUpdate() override ;
 
+	/** Execute whole instructions until at least the specified number of machine cycles have elapsed.
+	  * The system clock is advanced along with the CPU, but other components are only synchronized
+	  * mid-instruction for memory accesses which are sensitive to timing (VRAM, OAM, and I/O registers).
+	  * Execution stops early if the CPU is halted or stopped, if emulation is paused, if a scheduled system 
+	  * event occurs, or if an I/O register is written to. If an idle loop is detected, the system clock is
+	  * advanced directly to the next scheduled event (up to a total of nCycles machine cycles).
+	  * @param nCycles Number of machine cycles to execute
+	  * @return The number of machine cycles which were executed
+	  */
+	unsigned int run(const unsigned int &nCycles);
+
+	/** Execute an instruction using the dispatch method selected at build time.
+	  * Instructions are dispatched through the opcode function pointer table by default, or through an
+	  * inlined switch statement (CPU_DISPATCH=Switch) or computed goto jump table (CPU_DISPATCH=Goto).
+	  * @param data Decoded instruction to execute
+	  */
+	void executeInstruction(const OpcodeData &data);
+
+	/** Get the name of the instruction dispatch method selected at build time ("table", "switch", or "goto")
+	  */
+	static std::string getDispatchMethod();
+
+	/** Get the total number of machine cycles skipped by fast-forwarding through idle loops
+	  */
+	unsigned long long getIdleCycleCount() const {
+		return nIdleCycles;
+	}
+
+	/** Get the total number of instructions executed since the CPU was started
+	  */
+	unsigned long long getInstructionCount() const { return nInstructions; }
+
+	/** Enable or disable the block translation engine
+	  * When enabled, frequently executed straight-line blocks of ROM instructions are translated into lists 
+	  * of pre-decoded instructions which are executed without re-fetching or re-decoding them from memory.
+	  */
+	void setBlockEngine(bool state=true){ useBlockEngine = state; }
+
+	/** Enable or disable the native code compiler for translated blocks (enables the block engine)
+	  * When enabled, runs of register-only instructions in translated blocks are compiled into native x86-64 code.
+	  * @return True if native code generation is supported by the host and return false otherwise
+	  */
+	bool setJitEngine(bool state=true);
+
+	/** Open an output file and write the address, mnemonic, and CPU register state of every executed instruction to it
+	  * Traces may be compared between CPU engines to verify that they execute identically.
+	  * @param fname Path to the output trace file
+	  * @return True if the file was opened successfully and return false otherwise
+	  */
+	bool openTraceFile(const std::string &fname);
+
 	Opcode *getOpcodes(){ return opcodes.getOpcodes(); }
 	
 	Opcode *getOpcodesCB(){ return opcodes.getOpcodesCB(); }
 
 	OpcodeData *getLastOpcode(){ return &lastOpcode; }
 
+	InstructionCache *getInstructionCache(){ return &cache; }
+
 	std::string getInstruction() const { return lastOpcode.getInstruction(); }
 
 	unsigned short getAddress_C() const { return (0xFF00 + C); }
@@ -94,7 +172,7 @@ public:
 	unsigned char getC() const { return C; }
 	unsigned char getD() const { return D; }
 	unsigned char getE() const { return E; }
-	unsigned char getF() const { return F; }
+	unsigned char getF() const { return (lastFlagOperation == flagOperation::NONE ? F : computeFlags()); }
 	unsigned char getH() const { return H; }
 	unsigned char getL() const { return L; }
 
@@ -114,7 +192,7 @@ public:
 	void setC(const unsigned char &val){ C = val; }
 	void setD(const unsigned char &val){ D = val; }
 	void setE(const unsigned char &val){ E = val; }
-	void setF(const unsigned char &val){ F = val; }
+	void setF(const unsigned char &val){ F = val; lastFlagOperation = flagOperation::NONE; }
 	void setH(const unsigned char &val){ H = val; }
 	void setL(const unsigned char &val){ L = val; }
 
@@ -138,6 +216,16 @@ public:
 
 	bool findOpcode(const std::string& mnemonic, OpcodeData& data);
 
+	/** Write the flags produced by the most recent arithmetic operation into the flags register
+	  * Must be called before the flags register is accessed directly (e.g. through a pointer or a savestate).
+	  */
+	void evaluateFlags();
+
+	/** Discard the recorded idle loop state, so that idle loop detection starts over on the next backwards jump
+	  * Must be called whenever the CPU or memory state is replaced (e.g. when a savestate is loaded).
+	  */
+	void resetIdleLoop();
+
 protected:
 	bool halfCarry;
 	bool fullCarry;
@@ -150,7 +238,14 @@ protected:
 	unsigned char H; ///< H register
 	unsigned char L; ///< L register
 
-	unsigned char F; ///< Flags register
+	unsigned char F; ///< Flags register (only valid when there is no pending flag operation)
+
+	// Lazy flag evaluation
+	flagOperation lastFlagOperation; ///< Most recent arithmetic operation whose flags have not been written to F
+	unsigned char flagArg1; ///< First operand of the pending flag operation
+	unsigned char flagArg2; ///< Second operand of the pending flag operation
+	unsigned short flagResult; ///< Un-truncated result of the pending flag operation
+	bool flagCarry; ///< Carry flag preserved by a pending INC or DEC
 
 	// Immediate data
 	unsigned char d8; ///< 8-bit immediate data
@@ -163,17 +258,146 @@ protected:
 
 	unsigned short SP; ///< Stack Pointer (16-bit)
 	unsigned short PC; ///< Program Counter (16-bit)
+
+	unsigned long long nInstructions; ///< Total number of instructions executed
 	
 	OpcodeData lastOpcode; ///< Pointer to the last read opcode.
 
 	OpcodeHandler opcodes;
 
+	InstructionCache cache; ///< Cache of decoded instructions
+
+	BlockCache blocks; ///< Cache of translated instruction blocks
+
+	bool useBlockEngine; ///< Set if hot blocks of ROM instructions will be translated and executed as blocks
+
+	bool useJitEngine; ///< Set if translated blocks will be compiled to native code
+
+	JitCompiler jit; ///< Native code compiler for translated blocks
+
+	bool blockStart; ///< Set if the next instruction is the first instruction of a new block
+
+	bool blockTerminator[256]; ///< Set for all standard opcodes which end a block (control flow instructions)
+
+	bool idleLoopUnsafe[256]; ///< Set for all standard opcodes which may not appear in an idle loop (stack and interrupt control)
+
+	bool idleLoopValid; ///< Set if the state at the start of the most recent loop iteration has been recorded
+
+	bool idleLoopTainted; ///< Set if the current loop iteration wrote to memory or read an unscheduled timer register
+
+	bool idleLoopDetected; ///< Set if the last loop iteration was identical to the previous iteration
+
+	unsigned short idleLoopStart; ///< Target address of the most recent backwards jump
+
+	unsigned short idleLoopSP; ///< Stack pointer at the start of the most recent loop iteration
+
+	unsigned long long idleLoopState; ///< Packed 8-bit registers at the start of the most recent loop iteration
+
+	unsigned long long nIdleCycles; ///< Total number of machine cycles skipped while in idle loops
+
+	std::ofstream traceFile; ///< Output instruction trace file
+
 	std::map<std::string, regGet8bit> rget8; ///< Map of 8-bit register getters
 	std::map<std::string, regSet8bit> rset8; ///< Map of 8-bit register setters
 	
 	std::map<std::string, regGet16bit> rget16; ///< Map of 16-bit register getters
 	std::map<std::string, regSet16bit> rset16; ///< Map of 16-bit register setters
 
+	/** Check for pending interrupts and call the interrupt vectors of any which are enabled
+	  */
+	void checkInterrupts();
+
+	/** Perform the memory accesses of the current instruction and execute it, then advance the system clock to the end of the instruction
+	  * @param scheduler Pointer to the system event scheduler
+	  * @param nCyclesElapsed Number of machine cycles of the instruction which have already been clocked
+	  * @param stopRunning Set to true if a scheduled system event occurred or if an I/O register was written to
+	  * @return The total number of machine cycles of the instruction
+	  */
+	unsigned short completeInstruction(Scheduler *scheduler, const unsigned short &nCyclesElapsed, bool &stopRunning);
+
+	/** Decode a straight-line block of ROM instructions starting at the specified address
+	  * The block ends with the first control flow instruction, or at the end of the 4 kB memory page containing the
+	  * first instruction, so that no block spans more than one ROM bank or memory region.
+	  * @return True if at least one instruction was translated
+	  */
+	bool translateBlock(TranslatedBlock *block, const unsigned short &pc);
+
+	/** Execute a translated block of instructions
+	  * The system clock is advanced along with each instruction. Execution exits the block early if a scheduled system
+	  * event occurs, or if an I/O register, the interrupt enable register, or the cartridge MBC is written to.
+	  * @return The number of machine cycles which were executed
+	  */
+	unsigned int runBlock(const TranslatedBlock *block, Scheduler *scheduler, bool &stopRunning);
+
+	/** Set the current opcode, immediate data, and program counter from a translated instruction
+	  */
+	void setBlockInstruction(const TranslatedInstruction &instr);
+
+	/** Execute one instruction of a translated block
+	  * @param index Index of the instruction within the block
+	  * @param nCyclesRun Incremented by the number of machine cycles which were executed
+	  * @return True if execution must return to the interpreter before the next instruction of the block
+	  */
+	bool stepBlock(const TranslatedBlock *block, const unsigned int &index, Scheduler *scheduler, bool &stopRunning, unsigned int &nCyclesRun);
+
+	/** Pass the location of the CPU registers and the block callbacks to the native code compiler
+	  */
+	void updateJitLayout();
+
+	/** State of the translated block currently being executed by compiled native code
+	  */
+	class JitState{
+	public:
+		LR35902 *cpu; ///< CPU executing the block
+
+		const TranslatedBlock *block; ///< Block being executed
+
+		Scheduler *scheduler; ///< System event scheduler
+
+		bool *stopRunning; ///< Set if a scheduled system event occurred or if an I/O register was written to
+
+		unsigned int nCyclesRun; ///< Number of machine cycles executed by the block
+
+		JitState(LR35902 *cpu_, const TranslatedBlock *block_, Scheduler *scheduler_, bool *stopRunning_) :
+			cpu(cpu_),
+			block(block_),
+			scheduler(scheduler_),
+			stopRunning(stopRunning_),
+			nCyclesRun(0)
+		{
+		}
+	};
+
+	/** Native code callback which executes one instruction of the block through the CPU
+	  */
+	static bool jitStep(void *state, unsigned int index);
+
+	/** Native code callback which checks whether a segment of register instructions may run natively
+	  * Segments only run natively if no system event will occur before the end of the segment, since the system clock
+	  * is advanced once at the end. Otherwise the instructions are executed one at a time through the CPU.
+	  */
+	static int jitEnterSegment(void *state, unsigned int first, unsigned int count, unsigned int nCycles);
+
+	/** Native code callback which advances the system clock past a segment of native instructions
+	  */
+	static void jitLeaveSegment(void *state, unsigned int first, unsigned int count, unsigned int nCycles);
+
+	/** Native code callback which writes a native instruction to the instruction trace
+	  */
+	static void jitTrace(void *state, unsigned int index);
+
+	/** Write the address, mnemonic, and register state of the last executed instruction to the trace file
+	  */
+	void traceInstruction();
+
+	/** Check whether the last instruction completed an iteration of an idle loop
+	  * A short backwards jump completes an idle loop iteration if it returns to the same address as the previous
+	  * jump with identical register state, and no memory was written in between. The result of the next iteration
+	  * may then only change when a scheduled system event occurs.
+	  * @return True if an idle loop was detected
+	  */
+	bool checkIdleLoop();
+
 	void acknowledgeVBlankInterrupt();
 
 	void acknowledgeLcdInterrupt();
@@ -186,13 +410,17 @@ protected:
 
 	void callInterruptVector(const unsigned char &offset);
 
-	bool getFlagZ() const { return ((F & FLAG_Z_MASK) != 0); }
+	/** Compute the value of the flags register, including the flags of any pending arithmetic operation
+	  */
+	unsigned char computeFlags() const ;
+
+	bool getFlagZ() const { return (lastFlagOperation == flagOperation::NONE ? ((F & FLAG_Z_MASK) != 0) : ((flagResult & 0xFF) == 0)); }
 	
-	bool getFlagS() const { return ((F & FLAG_S_MASK) != 0); }
+	bool getFlagS() const { return ((getF() & FLAG_S_MASK) != 0); }
 	
-	bool getFlagH() const { return ((F & FLAG_H_MASK) != 0); }
+	bool getFlagH() const { return ((getF() & FLAG_H_MASK) != 0); }
 	
-	bool getFlagC() const { return ((F & FLAG_C_MASK) != 0); }
+	bool getFlagC() const ;
 
 	void setFlag(const unsigned char &bit, bool state=true);
 
@@ -266,9 +494,21 @@ protected:
 
 	void ret_cc();
 
-	unsigned char getCarriesAdd(const unsigned char &arg1, const unsigned char &arg2, bool adc=false);
+	/** Perform an 8-bit addition and defer evaluation of its flags
+	  * @param arg1 First operand
+	  * @param arg2 Second operand
+	  * @param carry Carry in (ADC)
+	  * @return The lower 8 bits of the result
+	  */
+	unsigned char addLazy(const unsigned char &arg1, const unsigned char &arg2, bool carry=false);
 
-	unsigned char getCarriesSub(const unsigned char &arg1, const unsigned char &arg2, bool sbc=false);
+	/** Perform an 8-bit subtraction and defer evaluation of its flags
+	  * @param arg1 First operand
+	  * @param arg2 Second operand
+	  * @param carry Borrow in (SBC)
+	  * @return The lower 8 bits of the result
+	  */
+	unsigned char subLazy(const unsigned char &arg1, const unsigned char &arg2, bool carry=false);
 
 	void sla_d8(unsigned char *arg);
 
@@ -288,6 +528,10 @@ protected:
 
 	void NOP(){ }
 
+	// PREFIX CB
+
+	void PREFIX_CB(){ } // CB prefix opcodes are decoded by evaluate()
+
 	// INC BC[DE|HL]
 
 	void INC_BC(){ inc_d16(&B, &C); }
@@ -644,7 +888,7 @@ protected:
 	void PUSH_BC(){ push_d16(B, C); }
 	void PUSH_DE(){ push_d16(D, E); }
 	void PUSH_HL(){ push_d16(H, L); }
-	void PUSH_AF(){ push_d16(A, F); }
+	void PUSH_AF(){ push_d16(A, getF()); }
 
 	// POP BC[DE|HL|AF]
 
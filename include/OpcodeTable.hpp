@@ -0,0 +1,544 @@
+#ifndef OPCODE_TABLE_HPP
+#define OPCODE_TABLE_HPP
+
+/** List of LR35902 instruction handlers, indexed by opcode.
+  * Each entry expands to OPCODE(index, handler) where handler is the name of the LR35902 member function
+  * which implements the instruction.
+  */
+#define LR35902_OPCODE_TABLE(OPCODE) \
+	OPCODE(0, NOP) \
+	OPCODE(1, LD_BC_d16) \
+	OPCODE(2, LD_aBC_A) \
+	OPCODE(3, INC_BC) \
+	OPCODE(4, INC_B) \
+	OPCODE(5, DEC_B) \
+	OPCODE(6, LD_B_d8) \
+	OPCODE(7, RLCA) \
+	OPCODE(8, LD_a16_SP) \
+	OPCODE(9, ADD_HL_BC) \
+	OPCODE(10, LD_A_aBC) \
+	OPCODE(11, DEC_BC) \
+	OPCODE(12, INC_C) \
+	OPCODE(13, DEC_C) \
+	OPCODE(14, LD_C_d8) \
+	OPCODE(15, RRCA) \
+	OPCODE(16, STOP_0) \
+	OPCODE(17, LD_DE_d16) \
+	OPCODE(18, LD_aDE_A) \
+	OPCODE(19, INC_DE) \
+	OPCODE(20, INC_D) \
+	OPCODE(21, DEC_D) \
+	OPCODE(22, LD_D_d8) \
+	OPCODE(23, RLA) \
+	OPCODE(24, JR_r8) \
+	OPCODE(25, ADD_HL_DE) \
+	OPCODE(26, LD_A_aDE) \
+	OPCODE(27, DEC_DE) \
+	OPCODE(28, INC_E) \
+	OPCODE(29, DEC_E) \
+	OPCODE(30, LD_E_d8) \
+	OPCODE(31, RRA) \
+	OPCODE(32, JR_NZ_r8) \
+	OPCODE(33, LD_HL_d16) \
+	OPCODE(34, LDI_aHL_A) \
+	OPCODE(35, INC_HL) \
+	OPCODE(36, INC_H) \
+	OPCODE(37, DEC_H) \
+	OPCODE(38, LD_H_d8) \
+	OPCODE(39, DAA) \
+	OPCODE(40, JR_Z_r8) \
+	OPCODE(41, ADD_HL_HL) \
+	OPCODE(42, LDI_A_aHL) \
+	OPCODE(43, DEC_HL) \
+	OPCODE(44, INC_L) \
+	OPCODE(45, DEC_L) \
+	OPCODE(46, LD_L_d8) \
+	OPCODE(47, CPL) \
+	OPCODE(48, JR_NC_r8) \
+	OPCODE(49, LD_SP_d16) \
+	OPCODE(50, LDD_aHL_A) \
+	OPCODE(51, INC_SP) \
+	OPCODE(52, INC_aHL) \
+	OPCODE(53, DEC_aHL) \
+	OPCODE(54, LD_aHL_d8) \
+	OPCODE(55, SCF) \
+	OPCODE(56, JR_C_r8) \
+	OPCODE(57, ADD_HL_SP) \
+	OPCODE(58, LDD_A_aHL) \
+	OPCODE(59, DEC_SP) \
+	OPCODE(60, INC_A) \
+	OPCODE(61, DEC_A) \
+	OPCODE(62, LD_A_d8) \
+	OPCODE(63, CCF) \
+	OPCODE(64, LD_B_B) \
+	OPCODE(65, LD_B_C) \
+	OPCODE(66, LD_B_D) \
+	OPCODE(67, LD_B_E) \
+	OPCODE(68, LD_B_H) \
+	OPCODE(69, LD_B_L) \
+	OPCODE(70, LD_B_aHL) \
+	OPCODE(71, LD_B_A) \
+	OPCODE(72, LD_C_B) \
+	OPCODE(73, LD_C_C) \
+	OPCODE(74, LD_C_D) \
+	OPCODE(75, LD_C_E) \
+	OPCODE(76, LD_C_H) \
+	OPCODE(77, LD_C_L) \
+	OPCODE(78, LD_C_aHL) \
+	OPCODE(79, LD_C_A) \
+	OPCODE(80, LD_D_B) \
+	OPCODE(81, LD_D_C) \
+	OPCODE(82, LD_D_D) \
+	OPCODE(83, LD_D_E) \
+	OPCODE(84, LD_D_H) \
+	OPCODE(85, LD_D_L) \
+	OPCODE(86, LD_D_aHL) \
+	OPCODE(87, LD_D_A) \
+	OPCODE(88, LD_E_B) \
+	OPCODE(89, LD_E_C) \
+	OPCODE(90, LD_E_D) \
+	OPCODE(91, LD_E_E) \
+	OPCODE(92, LD_E_H) \
+	OPCODE(93, LD_E_L) \
+	OPCODE(94, LD_E_aHL) \
+	OPCODE(95, LD_E_A) \
+	OPCODE(96, LD_H_B) \
+	OPCODE(97, LD_H_C) \
+	OPCODE(98, LD_H_D) \
+	OPCODE(99, LD_H_E) \
+	OPCODE(100, LD_H_H) \
+	OPCODE(101, LD_H_L) \
+	OPCODE(102, LD_H_aHL) \
+	OPCODE(103, LD_H_A) \
+	OPCODE(104, LD_L_B) \
+	OPCODE(105, LD_L_C) \
+	OPCODE(106, LD_L_D) \
+	OPCODE(107, LD_L_E) \
+	OPCODE(108, LD_L_H) \
+	OPCODE(109, LD_L_L) \
+	OPCODE(110, LD_L_aHL) \
+	OPCODE(111, LD_L_A) \
+	OPCODE(112, LD_aHL_B) \
+	OPCODE(113, LD_aHL_C) \
+	OPCODE(114, LD_aHL_D) \
+	OPCODE(115, LD_aHL_E) \
+	OPCODE(116, LD_aHL_H) \
+	OPCODE(117, LD_aHL_L) \
+	OPCODE(118, HALT) \
+	OPCODE(119, LD_aHL_A) \
+	OPCODE(120, LD_A_B) \
+	OPCODE(121, LD_A_C) \
+	OPCODE(122, LD_A_D) \
+	OPCODE(123, LD_A_E) \
+	OPCODE(124, LD_A_H) \
+	OPCODE(125, LD_A_L) \
+	OPCODE(126, LD_A_aHL) \
+	OPCODE(127, LD_A_A) \
+	OPCODE(128, ADD_A_B) \
+	OPCODE(129, ADD_A_C) \
+	OPCODE(130, ADD_A_D) \
+	OPCODE(131, ADD_A_E) \
+	OPCODE(132, ADD_A_H) \
+	OPCODE(133, ADD_A_L) \
+	OPCODE(134, ADD_A_aHL) \
+	OPCODE(135, ADD_A_A) \
+	OPCODE(136, ADC_A_B) \
+	OPCODE(137, ADC_A_C) \
+	OPCODE(138, ADC_A_D) \
+	OPCODE(139, ADC_A_E) \
+	OPCODE(140, ADC_A_H) \
+	OPCODE(141, ADC_A_L) \
+	OPCODE(142, ADC_A_aHL) \
+	OPCODE(143, ADC_A_A) \
+	OPCODE(144, SUB_B) \
+	OPCODE(145, SUB_C) \
+	OPCODE(146, SUB_D) \
+	OPCODE(147, SUB_E) \
+	OPCODE(148, SUB_H) \
+	OPCODE(149, SUB_L) \
+	OPCODE(150, SUB_aHL) \
+	OPCODE(151, SUB_A) \
+	OPCODE(152, SBC_A_B) \
+	OPCODE(153, SBC_A_C) \
+	OPCODE(154, SBC_A_D) \
+	OPCODE(155, SBC_A_E) \
+	OPCODE(156, SBC_A_H) \
+	OPCODE(157, SBC_A_L) \
+	OPCODE(158, SBC_A_aHL) \
+	OPCODE(159, SBC_A_A) \
+	OPCODE(160, AND_B) \
+	OPCODE(161, AND_C) \
+	OPCODE(162, AND_D) \
+	OPCODE(163, AND_E) \
+	OPCODE(164, AND_H) \
+	OPCODE(165, AND_L) \
+	OPCODE(166, AND_aHL) \
+	OPCODE(167, AND_A) \
+	OPCODE(168, XOR_B) \
+	OPCODE(169, XOR_C) \
+	OPCODE(170, XOR_D) \
+	OPCODE(171, XOR_E) \
+	OPCODE(172, XOR_H) \
+	OPCODE(173, XOR_L) \
+	OPCODE(174, XOR_aHL) \
+	OPCODE(175, XOR_A) \
+	OPCODE(176, OR_B) \
+	OPCODE(177, OR_C) \
+	OPCODE(178, OR_D) \
+	OPCODE(179, OR_E) \
+	OPCODE(180, OR_H) \
+	OPCODE(181, OR_L) \
+	OPCODE(182, OR_aHL) \
+	OPCODE(183, OR_A) \
+	OPCODE(184, CP_B) \
+	OPCODE(185, CP_C) \
+	OPCODE(186, CP_D) \
+	OPCODE(187, CP_E) \
+	OPCODE(188, CP_H) \
+	OPCODE(189, CP_L) \
+	OPCODE(190, CP_aHL) \
+	OPCODE(191, CP_A) \
+	OPCODE(192, RET_NZ) \
+	OPCODE(193, POP_BC) \
+	OPCODE(194, JP_NZ_d16) \
+	OPCODE(195, JP_d16) \
+	OPCODE(196, CALL_NZ_a16) \
+	OPCODE(197, PUSH_BC) \
+	OPCODE(198, ADD_A_d8) \
+	OPCODE(199, RST_00H) \
+	OPCODE(200, RET_Z) \
+	OPCODE(201, RET) \
+	OPCODE(202, JP_Z_d16) \
+	OPCODE(203, PREFIX_CB) \
+	OPCODE(204, CALL_Z_a16) \
+	OPCODE(205, CALL_a16) \
+	OPCODE(206, ADC_A_d8) \
+	OPCODE(207, RST_08H) \
+	OPCODE(208, RET_NC) \
+	OPCODE(209, POP_DE) \
+	OPCODE(210, JP_NC_d16) \
+	OPCODE(211, NOP) \
+	OPCODE(212, CALL_NC_a16) \
+	OPCODE(213, PUSH_DE) \
+	OPCODE(214, SUB_d8) \
+	OPCODE(215, RST_10H) \
+	OPCODE(216, RET_C) \
+	OPCODE(217, RETI) \
+	OPCODE(218, JP_C_d16) \
+	OPCODE(219, NOP) \
+	OPCODE(220, CALL_C_a16) \
+	OPCODE(221, NOP) \
+	OPCODE(222, SBC_A_d8) \
+	OPCODE(223, RST_18H) \
+	OPCODE(224, LDH_a8_A) \
+	OPCODE(225, POP_HL) \
+	OPCODE(226, LD_aC_A) \
+	OPCODE(227, NOP) \
+	OPCODE(228, NOP) \
+	OPCODE(229, PUSH_HL) \
+	OPCODE(230, AND_d8) \
+	OPCODE(231, RST_20H) \
+	OPCODE(232, ADD_SP_r8) \
+	OPCODE(233, JP_aHL) \
+	OPCODE(234, LD_a16_A) \
+	OPCODE(235, NOP) \
+	OPCODE(236, NOP) \
+	OPCODE(237, NOP) \
+	OPCODE(238, XOR_d8) \
+	OPCODE(239, RST_28H) \
+	OPCODE(240, LDH_A_a8) \
+	OPCODE(241, POP_AF) \
+	OPCODE(242, LD_A_aC) \
+	OPCODE(243, DI) \
+	OPCODE(244, NOP) \
+	OPCODE(245, PUSH_AF) \
+	OPCODE(246, OR_d8) \
+	OPCODE(247, RST_30H) \
+	OPCODE(248, LD_HL_SP_r8) \
+	OPCODE(249, LD_SP_HL) \
+	OPCODE(250, LD_A_a16) \
+	OPCODE(251, EI) \
+	OPCODE(252, NOP) \
+	OPCODE(253, NOP) \
+	OPCODE(254, CP_d8) \
+	OPCODE(255, RST_38H)
+
+/** List of LR35902 CB prefix instruction handlers, indexed by opcode (the byte following the 0xCB prefix).
+  */
+#define LR35902_OPCODE_TABLE_CB(OPCODE) \
+	OPCODE(0, RLC_B) \
+	OPCODE(1, RLC_C) \
+	OPCODE(2, RLC_D) \
+	OPCODE(3, RLC_E) \
+	OPCODE(4, RLC_H) \
+	OPCODE(5, RLC_L) \
+	OPCODE(6, RLC_aHL) \
+	OPCODE(7, RLC_A) \
+	OPCODE(8, RRC_B) \
+	OPCODE(9, RRC_C) \
+	OPCODE(10, RRC_D) \
+	OPCODE(11, RRC_E) \
+	OPCODE(12, RRC_H) \
+	OPCODE(13, RRC_L) \
+	OPCODE(14, RRC_aHL) \
+	OPCODE(15, RRC_A) \
+	OPCODE(16, RL_B) \
+	OPCODE(17, RL_C) \
+	OPCODE(18, RL_D) \
+	OPCODE(19, RL_E) \
+	OPCODE(20, RL_H) \
+	OPCODE(21, RL_L) \
+	OPCODE(22, RL_aHL) \
+	OPCODE(23, RL_A) \
+	OPCODE(24, RR_B) \
+	OPCODE(25, RR_C) \
+	OPCODE(26, RR_D) \
+	OPCODE(27, RR_E) \
+	OPCODE(28, RR_H) \
+	OPCODE(29, RR_L) \
+	OPCODE(30, RR_aHL) \
+	OPCODE(31, RR_A) \
+	OPCODE(32, SLA_B) \
+	OPCODE(33, SLA_C) \
+	OPCODE(34, SLA_D) \
+	OPCODE(35, SLA_E) \
+	OPCODE(36, SLA_H) \
+	OPCODE(37, SLA_L) \
+	OPCODE(38, SLA_aHL) \
+	OPCODE(39, SLA_A) \
+	OPCODE(40, SRA_B) \
+	OPCODE(41, SRA_C) \
+	OPCODE(42, SRA_D) \
+	OPCODE(43, SRA_E) \
+	OPCODE(44, SRA_H) \
+	OPCODE(45, SRA_L) \
+	OPCODE(46, SRA_aHL) \
+	OPCODE(47, SRA_A) \
+	OPCODE(48, SWAP_B) \
+	OPCODE(49, SWAP_C) \
+	OPCODE(50, SWAP_D) \
+	OPCODE(51, SWAP_E) \
+	OPCODE(52, SWAP_H) \
+	OPCODE(53, SWAP_L) \
+	OPCODE(54, SWAP_aHL) \
+	OPCODE(55, SWAP_A) \
+	OPCODE(56, SRL_B) \
+	OPCODE(57, SRL_C) \
+	OPCODE(58, SRL_D) \
+	OPCODE(59, SRL_E) \
+	OPCODE(60, SRL_H) \
+	OPCODE(61, SRL_L) \
+	OPCODE(62, SRL_aHL) \
+	OPCODE(63, SRL_A) \
+	OPCODE(64, BIT_0_B) \
+	OPCODE(65, BIT_0_C) \
+	OPCODE(66, BIT_0_D) \
+	OPCODE(67, BIT_0_E) \
+	OPCODE(68, BIT_0_H) \
+	OPCODE(69, BIT_0_L) \
+	OPCODE(70, BIT_0_aHL) \
+	OPCODE(71, BIT_0_A) \
+	OPCODE(72, BIT_1_B) \
+	OPCODE(73, BIT_1_C) \
+	OPCODE(74, BIT_1_D) \
+	OPCODE(75, BIT_1_E) \
+	OPCODE(76, BIT_1_H) \
+	OPCODE(77, BIT_1_L) \
+	OPCODE(78, BIT_1_aHL) \
+	OPCODE(79, BIT_1_A) \
+	OPCODE(80, BIT_2_B) \
+	OPCODE(81, BIT_2_C) \
+	OPCODE(82, BIT_2_D) \
+	OPCODE(83, BIT_2_E) \
+	OPCODE(84, BIT_2_H) \
+	OPCODE(85, BIT_2_L) \
+	OPCODE(86, BIT_2_aHL) \
+	OPCODE(87, BIT_2_A) \
+	OPCODE(88, BIT_3_B) \
+	OPCODE(89, BIT_3_C) \
+	OPCODE(90, BIT_3_D) \
+	OPCODE(91, BIT_3_E) \
+	OPCODE(92, BIT_3_H) \
+	OPCODE(93, BIT_3_L) \
+	OPCODE(94, BIT_3_aHL) \
+	OPCODE(95, BIT_3_A) \
+	OPCODE(96, BIT_4_B) \
+	OPCODE(97, BIT_4_C) \
+	OPCODE(98, BIT_4_D) \
+	OPCODE(99, BIT_4_E) \
+	OPCODE(100, BIT_4_H) \
+	OPCODE(101, BIT_4_L) \
+	OPCODE(102, BIT_4_aHL) \
+	OPCODE(103, BIT_4_A) \
+	OPCODE(104, BIT_5_B) \
+	OPCODE(105, BIT_5_C) \
+	OPCODE(106, BIT_5_D) \
+	OPCODE(107, BIT_5_E) \
+	OPCODE(108, BIT_5_H) \
+	OPCODE(109, BIT_5_L) \
+	OPCODE(110, BIT_5_aHL) \
+	OPCODE(111, BIT_5_A) \
+	OPCODE(112, BIT_6_B) \
+	OPCODE(113, BIT_6_C) \
+	OPCODE(114, BIT_6_D) \
+	OPCODE(115, BIT_6_E) \
+	OPCODE(116, BIT_6_H) \
+	OPCODE(117, BIT_6_L) \
+	OPCODE(118, BIT_6_aHL) \
+	OPCODE(119, BIT_6_A) \
+	OPCODE(120, BIT_7_B) \
+	OPCODE(121, BIT_7_C) \
+	OPCODE(122, BIT_7_D) \
+	OPCODE(123, BIT_7_E) \
+	OPCODE(124, BIT_7_H) \
+	OPCODE(125, BIT_7_L) \
+	OPCODE(126, BIT_7_aHL) \
+	OPCODE(127, BIT_7_A) \
+	OPCODE(128, RES_0_B) \
+	OPCODE(129, RES_0_C) \
+	OPCODE(130, RES_0_D) \
+	OPCODE(131, RES_0_E) \
+	OPCODE(132, RES_0_H) \
+	OPCODE(133, RES_0_L) \
+	OPCODE(134, RES_0_aHL) \
+	OPCODE(135, RES_0_A) \
+	OPCODE(136, RES_1_B) \
+	OPCODE(137, RES_1_C) \
+	OPCODE(138, RES_1_D) \
+	OPCODE(139, RES_1_E) \
+	OPCODE(140, RES_1_H) \
+	OPCODE(141, RES_1_L) \
+	OPCODE(142, RES_1_aHL) \
+	OPCODE(143, RES_1_A) \
+	OPCODE(144, RES_2_B) \
+	OPCODE(145, RES_2_C) \
+	OPCODE(146, RES_2_D) \
+	OPCODE(147, RES_2_E) \
+	OPCODE(148, RES_2_H) \
+	OPCODE(149, RES_2_L) \
+	OPCODE(150, RES_2_aHL) \
+	OPCODE(151, RES_2_A) \
+	OPCODE(152, RES_3_B) \
+	OPCODE(153, RES_3_C) \
+	OPCODE(154, RES_3_D) \
+	OPCODE(155, RES_3_E) \
+	OPCODE(156, RES_3_H) \
+	OPCODE(157, RES_3_L) \
+	OPCODE(158, RES_3_aHL) \
+	OPCODE(159, RES_3_A) \
+	OPCODE(160, RES_4_B) \
+	OPCODE(161, RES_4_C) \
+	OPCODE(162, RES_4_D) \
+	OPCODE(163, RES_4_E) \
+	OPCODE(164, RES_4_H) \
+	OPCODE(165, RES_4_L) \
+	OPCODE(166, RES_4_aHL) \
+	OPCODE(167, RES_4_A) \
+	OPCODE(168, RES_5_B) \
+	OPCODE(169, RES_5_C) \
+	OPCODE(170, RES_5_D) \
+	OPCODE(171, RES_5_E) \
+	OPCODE(172, RES_5_H) \
+	OPCODE(173, RES_5_L) \
+	OPCODE(174, RES_5_aHL) \
+	OPCODE(175, RES_5_A) \
+	OPCODE(176, RES_6_B) \
+	OPCODE(177, RES_6_C) \
+	OPCODE(178, RES_6_D) \
+	OPCODE(179, RES_6_E) \
+	OPCODE(180, RES_6_H) \
+	OPCODE(181, RES_6_L) \
+	OPCODE(182, RES_6_aHL) \
+	OPCODE(183, RES_6_A) \
+	OPCODE(184, RES_7_B) \
+	OPCODE(185, RES_7_C) \
+	OPCODE(186, RES_7_D) \
+	OPCODE(187, RES_7_E) \
+	OPCODE(188, RES_7_H) \
+	OPCODE(189, RES_7_L) \
+	OPCODE(190, RES_7_aHL) \
+	OPCODE(191, RES_7_A) \
+	OPCODE(192, SET_0_B) \
+	OPCODE(193, SET_0_C) \
+	OPCODE(194, SET_0_D) \
+	OPCODE(195, SET_0_E) \
+	OPCODE(196, SET_0_H) \
+	OPCODE(197, SET_0_L) \
+	OPCODE(198, SET_0_aHL) \
+	OPCODE(199, SET_0_A) \
+	OPCODE(200, SET_1_B) \
+	OPCODE(201, SET_1_C) \
+	OPCODE(202, SET_1_D) \
+	OPCODE(203, SET_1_E) \
+	OPCODE(204, SET_1_H) \
+	OPCODE(205, SET_1_L) \
+	OPCODE(206, SET_1_aHL) \
+	OPCODE(207, SET_1_A) \
+	OPCODE(208, SET_2_B) \
+	OPCODE(209, SET_2_C) \
+	OPCODE(210, SET_2_D) \
+	OPCODE(211, SET_2_E) \
+	OPCODE(212, SET_2_H) \
+	OPCODE(213, SET_2_L) \
+	OPCODE(214, SET_2_aHL) \
+	OPCODE(215, SET_2_A) \
+	OPCODE(216, SET_3_B) \
+	OPCODE(217, SET_3_C) \
+	OPCODE(218, SET_3_D) \
+	OPCODE(219, SET_3_E) \
+	OPCODE(220, SET_3_H) \
+	OPCODE(221, SET_3_L) \
+	OPCODE(222, SET_3_aHL) \
+	OPCODE(223, SET_3_A) \
+	OPCODE(224, SET_4_B) \
+	OPCODE(225, SET_4_C) \
+	OPCODE(226, SET_4_D) \
+	OPCODE(227, SET_4_E) \
+	OPCODE(228, SET_4_H) \
+	OPCODE(229, SET_4_L) \
+	OPCODE(230, SET_4_aHL) \
+	OPCODE(231, SET_4_A) \
+	OPCODE(232, SET_5_B) \
+	OPCODE(233, SET_5_C) \
+	OPCODE(234, SET_5_D) \
+	OPCODE(235, SET_5_E) \
+	OPCODE(236, SET_5_H) \
+	OPCODE(237, SET_5_L) \
+	OPCODE(238, SET_5_aHL) \
+	OPCODE(239, SET_5_A) \
+	OPCODE(240, SET_6_B) \
+	OPCODE(241, SET_6_C) \
+	OPCODE(242, SET_6_D) \
+	OPCODE(243, SET_6_E) \
+	OPCODE(244, SET_6_H) \
+	OPCODE(245, SET_6_L) \
+	OPCODE(246, SET_6_aHL) \
+	OPCODE(247, SET_6_A) \
+	OPCODE(248, SET_7_B) \
+	OPCODE(249, SET_7_C) \
+	OPCODE(250, SET_7_D) \
+	OPCODE(251, SET_7_E) \
+	OPCODE(252, SET_7_H) \
+	OPCODE(253, SET_7_L) \
+	OPCODE(254, SET_7_aHL) \
+	OPCODE(255, SET_7_A)
+
+/** Return true if the opcode indices of a table run from zero to (length-1) with no gaps
+  * Tables are expanded by position (e.g. into computed goto jump tables), so a missing entry would shift
+  * every following opcode onto the wrong handler.
+  */
+constexpr bool opcodeTableIsComplete(const unsigned short *indices, const unsigned short &length, const unsigned short &position=0){
+	return (position == length || (indices[position] == position && opcodeTableIsComplete(indices, length, position + 1)));
+}
+
+#define OPCODE_TABLE_INDEX(index, handler) index,
+constexpr unsigned short LR35902_OPCODE_INDICES[] = { LR35902_OPCODE_TABLE(OPCODE_TABLE_INDEX) };
+constexpr unsigned short LR35902_OPCODE_INDICES_CB[] = { LR35902_OPCODE_TABLE_CB(OPCODE_TABLE_INDEX) };
+#undef OPCODE_TABLE_INDEX
+
+static_assert(sizeof(LR35902_OPCODE_INDICES) / sizeof(unsigned short) == 256 && opcodeTableIsComplete(LR35902_OPCODE_INDICES, 256), 
+              "LR35902_OPCODE_TABLE must list opcodes 0 to 255 in order");
+static_assert(sizeof(LR35902_OPCODE_INDICES_CB) / sizeof(unsigned short) == 256 && opcodeTableIsComplete(LR35902_OPCODE_INDICES_CB, 256), 
+              "LR35902_OPCODE_TABLE_CB must list opcodes 0 to 255 in order");
+
+#endif
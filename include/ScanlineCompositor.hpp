@@ -0,0 +1,135 @@
+#ifndef SCANLINE_COMPOSITOR_HPP
+#define SCANLINE_COMPOSITOR_HPP
+
+#include <string>
+#include <cstdint>
+
+constexpr unsigned short LAYER_LINE_WIDTH = 256; ///< Width of a background layer scanline (in pixels)
+
+constexpr unsigned short SCREEN_LINE_WIDTH = 160; ///< Width of an LCD screen scanline (in pixels)
+
+class LayerLine{
+public:
+	unsigned char color[LAYER_LINE_WIDTH]; ///< Pixel color index [0,3]
+
+	unsigned char palette[LAYER_LINE_WIDTH]; ///< Pixel palette number
+
+	unsigned char priority[LAYER_LINE_WIDTH]; ///< Pixel priority flag (0 or 1)
+
+	unsigned char visible[LAYER_LINE_WIDTH]; ///< Pixel visibility flag (0 or 1)
+
+	/** Default constructor
+	  */
+	LayerLine();
+
+	/** Set the color of a background or window layer pixel (always visible)
+	  */
+	void setColorBG(const unsigned char &x, const unsigned char &c, const unsigned char &pal, bool prio=true){
+		color[x] = c;
+		palette[x] = pal;
+		priority[x] = (prio ? 1 : 0);
+		visible[x] = 1;
+	}
+
+	/** Set the color of a sprite layer pixel (color 0 is always transparent)
+	  */
+	void setColorOBJ(const unsigned char &x, const unsigned char &c, const unsigned char &pal, bool prio=true){
+		color[x] = c;
+		palette[x] = pal;
+		priority[x] = (prio ? 1 : 0);
+		visible[x] = (c != 0 ? 1 : 0);
+	}
+
+	/** Reset a pixel to color 0 of palette 0 (not visible)
+	  */
+	void reset(const unsigned char &x){
+		color[x] = 0;
+		palette[x] = 0;
+		priority[x] = 0;
+		visible[x] = 0;
+	}
+
+	/** Reset all pixels
+	  */
+	void reset();
+};
+
+class ScanlineCompositor{
+public:
+	/** Default constructor
+	  * Selects the fastest compositing method supported by the host CPU.
+	  */
+	ScanlineCompositor();
+
+	/** Set flags which control how the sprite layer is mixed with the background and window layers
+	  * @param objPriority If set, sprites with the OAM priority bit set are drawn behind background colors 1-3
+	  * @param bgPriority If set, background tiles with the priority attribute set are drawn above all sprites
+	  */
+	void setPriorityMode(bool objPriority, bool bgPriority){
+		useObjPriority = objPriority;
+		useBgPriority = bgPriority;
+	}
+
+	/** Select which layer is visible for each pixel on the scanline and output the resulting colors
+	  * @param background Background layer scanline
+	  * @param window Window layer scanline (indexed by LCD screen pixel)
+	  * @param sprites Sprite layer scanline
+	  * @param scroll Horizontal offset of the LCD screen in the background and sprite layer scanlines (SCX)
+	  * @param windowStart First LCD screen pixel covered by the window layer (or 160 or greater if the window is not visible)
+	  * @param palette Array of 64 packed RGBA colors indexed by (4 * palette number + color index)
+	  * @param output Array of 160 packed RGBA pixels
+	  */
+	void composite(const LayerLine &background, const LayerLine &window, const LayerLine &sprites, const unsigned char &scroll, const short &windowStart, const uint32_t *palette, uint32_t *output);
+
+	/** Get the name of the selected compositing method
+	  */
+	std::string getMethod() const ;
+
+	/** Get the palette table index selected for each pixel of the most recent scanline
+	  */
+	const unsigned char *getColorIndices() const {
+		return colorIndex;
+	}
+
+	/** Select a compositing method by name (scalar, sse2, or avx2)
+	  * @return True if the method is supported by this build and the host CPU, otherwise return false
+	  */
+	bool setMethod(const std::string &name);
+
+private:
+	enum class compositeMethod{ SCALAR, SSE2, AVX2 };
+
+	compositeMethod method; ///< Compositing method used for all scanlines
+
+	bool useObjPriority; ///< Sprites with the OAM priority bit set are drawn behind background colors 1-3
+
+	bool useBgPriority; ///< Background tiles with the priority attribute set are drawn above all sprites
+
+	unsigned char bgColor[SCREEN_LINE_WIDTH]; ///< Visible portion of the background layer color indices
+	unsigned char bgPalette[SCREEN_LINE_WIDTH]; ///< Visible portion of the background layer palette numbers
+	unsigned char bgPriority[SCREEN_LINE_WIDTH]; ///< Visible portion of the background layer priority flags
+	unsigned char objColor[SCREEN_LINE_WIDTH]; ///< Visible portion of the sprite layer color indices
+	unsigned char objPalette[SCREEN_LINE_WIDTH]; ///< Visible portion of the sprite layer palette numbers
+	unsigned char objPriority[SCREEN_LINE_WIDTH]; ///< Visible portion of the sprite layer priority flags
+	unsigned char objVisible[SCREEN_LINE_WIDTH]; ///< Visible portion of the sprite layer visibility flags
+
+	unsigned char colorIndex[SCREEN_LINE_WIDTH]; ///< Selected palette table index for each pixel
+
+	/** Copy the visible portion of the background and sprite layer scanlines into contiguous arrays
+	  */
+	void unwrap(const LayerLine &background, const LayerLine &sprites, const unsigned char &scroll);
+
+	/** Select the visible layer for each pixel and compute palette table indices (one pixel at a time)
+	  */
+	void mixScalar(const LayerLine &window, const unsigned char &windowStart);
+
+	/** Select the visible layer for each pixel and compute palette table indices (16 pixels at a time)
+	  */
+	void mixSSE2(const LayerLine &window, const unsigned char &windowStart);
+
+	/** Select the visible layer for each pixel, compute palette table indices, and output colors (32 pixels at a time)
+	  */
+	void mixAVX2(const LayerLine &window, const unsigned char &windowStart, const uint32_t *palette, uint32_t *output);
+};
+
+#endif
@@ -135,6 +135,14 @@ public:
 	bool readRegister(const unsigned short &reg, unsigned char &val) override;
 
 	bool onClockUpdate() override;
+
+	/** Clock the audio units and frame sequencer for multiple system clock ticks at once
+	  */
+	bool onClockAdvance(const unsigned int &nCycles) override;
+
+	/** Get the number of system clock ticks until the next 512 Hz frame sequencer tick
+	  */
+	unsigned int getCyclesUntilNextEvent() override;
 	
 	void defineRegisters() override;
 
@@ -59,6 +59,13 @@ public:
 		return (oamIndex == index); 
 	}
 	
+	/** Return true if the sprite is positioned horizontally off screen
+	  * Such sprites are not drawn, but still count towards the limit of 10 sprites per scanline.
+	  */
+	bool offscreenX() const {
+		return (xPos == 0 || xPos >= 168);
+	}
+
 	/** Get sprite layering priority for DMG sprites
 	  * When sprites with differing X position overlap, the one whose positino is lower will have priority. 
 	  * If their X position is the same, priority is assigned based on table ordering.
@@ -86,10 +93,11 @@ public:
 	  */
 	SpriteAttributes getSpriteAttributes(const unsigned char &index);
 	
-	/** Decode the attributes of the next modified sprite and add it to a vector of sprite attributes
+	/** Decode the attributes of the next modified sprite and store them in a table of sprite attributes
+	  * @param sprites Array of attributes for all 40 sprites, indexed by OAM sprite index
 	  * @return True if there was at least one modified sprite in the list
 	  */
-	bool updateNextSprite(std::vector<SpriteAttributes> &sprites);
+	bool updateNextSprite(SpriteAttributes *sprites);
 	
 	/** Return true if the attributes of at least one sprite have been modified
 	  */
@@ -15,6 +15,19 @@ public:
 	double getFramerate() const { 
 		return framerate; 
 	}
+
+	/** Get the target wall clock time between successive frames (in microseconds)
+	  */
+	double getFramePeriod() const { 
+		return framePeriod; 
+	}
+
+	/** Get the wall clock time spent on the most recently completed frame, excluding time spent waiting for the next VSync (in microseconds)
+	  * The time is measured from the end of one VSync wait to the start of the next and includes rendering.
+	  */
+	double getFrameWorkTime() const { 
+		return frameWorkTime; 
+	}
 	
 	/** Set the target framerate multiplier
 	  * @param freq Framerate multiplier where a multiplier of 1.0 corresponds to normal output framerate of 59.7 fps
@@ -89,6 +102,18 @@ public:
 	  * @return True if the system has entered vertical blank (VBlank) interval, and false otherwise
 	  */
 	bool onClockUpdate() override ;
+
+	/** Perform multiple system clock ticks at once
+	  * All ticks but the last are skipped without checking for LCD driver mode changes, so the
+	  * number of ticks must not exceed the value returned by getCyclesUntilNextEvent().
+	  * @return True if the system has entered vertical blank (VBlank) interval, and false otherwise
+	  */
+	bool onClockAdvance(const unsigned int &nCycles) override ;
+
+	/** Get the number of system clock ticks until the next LCD driver event
+	  * LCD driver events include mode changes, scanline increments, and the start of the next frame.
+	  */
+	unsigned int getCyclesUntilNextEvent() override ;
 	
 	/** Sleep until the start of the next VSync cycle (i.e. wait until the start of the next frame)
 	  * Useful for maintaining desired framerate without advancing the system clock.
@@ -100,6 +125,13 @@ public:
 	  */
 	void resetScanline();
 
+	/** Get the version number of the savestate layout
+	  * Version 2 no longer stores the measured framerate, frame period, and clock rate (host doubles).
+	  */
+	unsigned short getSavestateVersion() const override {
+		return 2;
+	}
+
 private:
 	bool vsync; ///< Set if LCD driver is in vertical blank interval
 
@@ -119,6 +151,8 @@ private:
 	
 	double framePeriod; ///< Wall clock time between successive frames (microseconds)
 
+	double frameWorkTime; ///< Wall clock time spent on the previous frame, not including the VSync wait (microseconds)
+
 	hrclock::time_point timeOfInitialization; ///< Time that the system clock was initialized
 	
 	hrclock::time_point timeOfLastVSync; ///< Time at which the screen was last refreshed
@@ -7,6 +7,9 @@
 
 #include "SystemComponent.hpp"
 #include "SystemRegisters.hpp"
+#include "Scheduler.hpp"
+#include "HighResTimer.hpp"
+#include "FrameSkipController.hpp"
 
 #ifdef USE_QT_DEBUGGER
 	class MainWindow;
@@ -24,6 +27,8 @@ class WorkRam;
 class SystemClock;
 class SystemTimer;
 class LR35902;
+class ImageWriter;
+class RewindBuffer;
 
 class ComponentList{
 public:
@@ -230,6 +235,12 @@ public:
 	bool debugModeEnabled() const {
 		return debugMode;
 	}
+
+	/** Return true if the boot ROM is currently executing and return false otherwise
+	  */
+	bool bootSequenceActive() const {
+		return bootSequence;
+	}
 	
 	/** Attempt to read a byte from system memory and return the result
 	  * If address is not readable, behavior is undefined.
@@ -310,6 +321,12 @@ public:
 		return wram.get();
 	}
 	
+	/** Get pointer to the system event scheduler
+	  */
+	Scheduler* getScheduler(){
+		return &scheduler;
+	}
+
 	/** Get pointer to the list of system components
 	  */
 	ComponentList* getListOfComponents(){
@@ -373,9 +390,22 @@ public:
 	  * Larger frame skip values will yield higher frame-rates at the cost of decreased smoothness.
 	  */
 	void setFrameSkip(const unsigned short &frames){
-		frameSkip = frames;
+		frameSkip = (frames > 1 ? frames : 1);
+		autoFrameSkip = false;
 	}
 
+	/** Set the frame-skip from a string
+	  * Accepted values are an integer frame-skip N, "auto", or "auto<M>" where M is the maximum frame-skip (default 4).
+	  * @return True if the string is a valid frame-skip and return false otherwise
+	  */
+	bool setFrameSkip(const std::string &str);
+
+	/** Enable or disable automatic frame-skip
+	  * When enabled, frame-skip is adjusted each frame to hold the target framerate based on the measured
+	  * wall time spent emulating and rendering each frame.
+	  */
+	void setAutoFrameSkip(bool state=true);
+
 	/** Set the system path directory to use for loading ROM files
 	  */
 	void setRomPath(const std::string &path){
@@ -418,6 +448,10 @@ public:
 	  */
 	void setFramerateMultiplier(const float& freq);
 
+	/** Print the number of CPU instructions executed per second since the start of the CPU benchmark and the hash of the last frame
+	  */
+	void printBenchmarkResults();
+
 	/** Clear the current program counter breakpoint
 	  */
 	void clearBreakpoint();
@@ -458,6 +492,32 @@ public:
 	  */
 	void addDummyRegister(SystemComponent* comp, const unsigned char &reg);
 
+	/** Set the handler called after a system register is written
+	  * By default, registers with an associated system component call its virtual writeRegister() method.
+	  * @param reg Register index (as addr = 0xff00 + reg)
+	  * @param func Write handler, or null if writes to the register require no action
+	  */
+	void setRegisterWriteHandler(const unsigned char &reg, registerWriteFunc func){
+		registerHandlers[reg].write = func;
+	}
+
+	/** Set the handler called after a system register is read
+	  * By default, reading a register returns its value without calling a handler.
+	  * @param reg Register index (as addr = 0xff00 + reg)
+	  * @param func Read handler, or null if reads from the register require no action
+	  */
+	void setRegisterReadHandler(const unsigned char &reg, registerReadFunc func){
+		registerHandlers[reg].read = func;
+	}
+
+	/** Set the handler used to check whether a system register may currently be written
+	  * @param reg Register index (as addr = 0xff00 + reg)
+	  * @param func Check handler, or null if the register is always writable
+	  */
+	void setRegisterCheckHandler(const unsigned char &reg, registerCheckFunc func){
+		registerHandlers[reg].check = func;
+	}
+
 	/** Zero the specified system register
 	  * @param reg Register index (as addr = 0xff00 + reg)
 	  */
@@ -472,11 +532,13 @@ public:
 	bool dumpVRAM(const std::string &fname);
 	
 	/** Write cartridge save RAM to a file
+	  * The file is LZ4 compressed if COMPRESS_SRAM is set in the config file.
 	  * @return True if cartridge supports save RAM and it is written successfully
 	  */	
 	bool saveSRAM(const std::string &fname);
 	
 	/** Copy cartridge save RAM from a file
+	  * Compressed files are detected automatically.
 	  * @return True if cartridge supports save RAM and it is copied successfully
 	  */
 	bool loadSRAM(const std::string &fname);
@@ -550,11 +612,30 @@ public:
 	  */
 	bool reset();
 
-	/** Save the current frame buffer as an image
-	  * Not implemented.
+	/** Save the current frame buffer as a PNG image
+	  * The frame is copied and written by a background thread, so emulation is never stalled. Images are named
+	  * after the input ROM followed by the first unused screenshot number (e.g. "rom_0001.png").
+	  * @return True if the frame was queued to be written and return false if the writer is busy
 	  */
 	bool screenshot();
 
+	/** Write every Nth emulated frame to a PNG image (disabled if N is zero)
+	  * Images are named after the input ROM followed by the frame number (e.g. "rom_frame000120.png").
+	  * Frames which are not drawn due to frame-skip are not written. Emulation waits for the background
+	  * writer if it falls behind, so that no frames are lost.
+	  */
+	void setFrameDumpInterval(const unsigned int &N){
+		frameDumpInterval = N;
+	}
+
+	/** Enable or disable rewinding
+	  * While enabled, a snapshot of the system is taken every N frames. Holding backspace steps backwards
+	  * through the snapshots, one snapshot per frame.
+	  * @param interval Number of frames between snapshots (disabled if zero)
+	  * @param capacity Size of the compressed snapshot history (in bytes)
+	  */
+	void setRewind(const unsigned int &interval, const size_t &capacity=0x800000);
+
 	/** Write a savestate file
 	  * If filename not specified, the current input ROM filename plus extension ".sav" is used.
 	  * @param fname Savestate filename
@@ -569,6 +650,28 @@ public:
 	  */
 	bool quickload(const std::string& fname="");
 
+	/** Get the size of a savestate of the current system (in bytes)
+	  */
+	size_t getSavestateSize() const ;
+
+	/** Write the full state of the system to a memory buffer
+	  * The layout is identical to the layout of savestate files written by quicksave(). Passing the same buffer
+	  * to successive calls avoids any memory allocation.
+	  * @param state Output buffer, resized to the size of the savestate
+	  * @param incremental If set, only memory pages modified since the previous incremental save are copied, so the
+	  *                    buffer must hold the state written by that save. All pages are copied by the first incremental
+	  *                    save after loadState(). Ignored if the buffer size does not match the savestate size.
+	  * @return The number of bytes written to the buffer
+	  */
+	size_t saveState(std::vector<unsigned char> &state, bool incremental=false);
+
+	/** Restore the full state of the system from a memory buffer written by saveState()
+	  * @param state Input savestate buffer
+	  * @param length Length of the input buffer (in bytes)
+	  * @return True if the state was restored and return false if the buffer is not a savestate for the loaded ROM
+	  */
+	bool loadState(const unsigned char *state, const size_t &length);
+
 	/** Write cartridge save RAM to a file
 	  * The current input ROM filename plus extension ".sram" is used.
 	  * @return True if cartridge supports save RAM and it is written successfully
@@ -599,6 +702,18 @@ public:
 		userQuitting = true;
 	}
 
+	/** Press a keyboard key, as if it were pressed in the output window
+	  * Intended for driving the emulator without a display. Keys may be injected by a single thread other than
+	  * the emulation thread and are applied on the next frame.
+	  * @return True if the key was queued and return false if the key queue is full
+	  */
+	bool pressKey(const unsigned char &key);
+
+	/** Release a keyboard key, as if it were released in the output window
+	  * @return True if the key was queued and return false if the key queue is full
+	  */
+	bool releaseKey(const unsigned char &key);
+
 	/** Resume emulation until just after the next CPU instruction finishes execution
 	  * Does not resume audio output.
 	  */	
@@ -622,6 +737,13 @@ public:
 	/** Lock read / write access to VRAM and / or OAM
 	  */
 	void lockMemory(bool lockVRAM, bool lockOAM);
+
+	/** Update the memory page table for a region of the system memory map
+	  * Should be called whenever a component switches memory banks or its memory becomes (in)accessible.
+	  * @param locL Lowest 16-bit system memory address of the region
+	  * @param locH Highest 16-bit system memory address of the region
+	  */
+	void updateMemoryPages(const unsigned short &locL, const unsigned short &locH);
 	
 private:
 	SystemComponent dummyComponent; ///< Dummy system component used to organize system registers
@@ -630,6 +752,12 @@ private:
 	
 	unsigned short frameSkip; ///< The value N for drawing every 1 out of N frames (or the number of frames to skip between rendered frames plus 1)
 
+	bool autoFrameSkip; ///< Set if frame-skip is adjusted automatically to hold the target framerate
+
+	bool frameRendered; ///< Set if the previous frame was rendered
+
+	FrameSkipController frameSkipper; ///< Automatic frame-skip controller
+
 	bool verboseMode; ///< Verbosity flag
 	
 	bool debugMode; ///< Debug flag
@@ -649,6 +777,8 @@ private:
 	bool userQuitting; ///< Set if user has issued the command to quit
 	
 	bool autoLoadExtRam; ///< Set if external cartridge RAM (SRAM) will not be loaded at boot
+
+	bool compressExtRam; ///< Set if external cartridge RAM (SRAM) files will be written with LZ4 compression
 	
 	bool initSuccessful; ///< Set if all components were initialized successfully
 	
@@ -682,6 +812,24 @@ private:
 	
 	bool pauseAfterNextVBlank; ///< Set if emulator will pause execution after the next frame is rendered
 
+	double benchmarkLength; ///< Length of the CPU benchmark in seconds (disabled if zero)
+
+	unsigned int benchmarkFrames; ///< Number of emulated frames since power on after which the CPU benchmark stops (disabled if zero)
+
+	unsigned long long benchmarkInstructions; ///< CPU instruction count at the start of the CPU benchmark
+
+	HighResTimer benchmarkTimer; ///< Wall clock timer for the CPU benchmark
+
+	unsigned int frameNumber; ///< Number of frames emulated since power on
+
+	unsigned int frameDumpInterval; ///< Write every Nth frame to a PNG image (disabled if zero)
+
+	unsigned int screenshotIndex; ///< Number of the next screenshot image
+
+	unsigned int rewindInterval; ///< Number of frames between rewind snapshots (disabled if zero)
+
+	std::vector<unsigned char> rewindState; ///< Savestate buffer for rewind snapshots
+
 	SoundManager* audioInterface; ///< Pointer to sound output interface
 
 	std::unique_ptr<SerialController> serial; ///< Pointer to serial I/O controller
@@ -707,6 +855,10 @@ private:
 	std::unique_ptr<SystemTimer> timer; ///< Pointer to system timer
 	
 	std::unique_ptr<LR35902> cpu; ///< Pointer to LR35902 emulator
+
+	std::unique_ptr<ImageWriter> imageWriter; ///< Background PNG writer for screenshots and frame dumps (created on first use)
+
+	std::unique_ptr<RewindBuffer> rewindBuffer; ///< History of compressed snapshots for rewinding (null if rewinding is disabled)
 	
 #ifdef USE_QT_DEBUGGER
 	MainWindow* gui; ///< Pointer to Qt gui debugger (if available)
@@ -722,6 +874,8 @@ private:
 	unsigned short memoryAccessRead[2]; ///< Memory address read access region
 
 	std::vector<Register> registers; ///< System control registers
+
+	RegisterHandler registerHandlers[128]; ///< Write / read handlers for each system register (0xff00 to 0xff80)
 	
 	unsigned short bootLength; ///< Size of the boot ROM (bytes)
 	
@@ -729,6 +883,14 @@ private:
 
 	std::unique_ptr<ComponentList> subsystems; ///< List of all system component pointers 
 
+	unsigned char *readPages[256]; ///< Direct read pointers for each 256 byte memory page (null if reads require a handler)
+
+	unsigned char *writePages[256]; ///< Direct write pointers for each 256 byte memory page (null if writes require a handler)
+
+	unsigned char *writeDirty[256]; ///< Pointers to the component RAM modified flag for each directly writable memory page
+
+	Scheduler scheduler; ///< System event scheduler used to clock components only when they have work to do
+
 	/** Write to a system register 
 	  * Note: The true register value will be AND-ed together with its writable bit bitmask
 	  * @param reg 16-bit register address (ff00 to ff80)
@@ -745,9 +907,52 @@ private:
 	  */
 	bool readRegister(const unsigned short &reg, unsigned char &val);
 	
+	/** Write a byte to a memory location which is not directly mapped by the memory page table
+	  * @param loc 16-bit system memory address
+	  * @param src Value to write
+	  * @return True if the value was written successfully, otherwise return false
+	  */
+	bool writeMemoryHandler(const unsigned short &loc, const unsigned char &src);
+
+	/** Read a byte from a memory location which is not directly mapped by the memory page table
+	  * @param loc 16-bit system memory address
+	  * @param dest Reference to read value into
+	  * @return True if the value was read successfully, otherwise return false
+	  */
+	bool readMemoryHandler(const unsigned short &loc, unsigned char &dest);
+
+	/** Get direct read and write pointers to the start of a 256 byte memory page
+	  * Pointers are null for pages which require a memory handler.
+	  * @param page Memory page index (upper byte of 16-bit system memory address)
+	  * @param readPtr Reference to the read pointer for the page
+	  * @param writePtr Reference to the write pointer for the page
+	  * @param dirtyPtr Reference to the pointer to the modified flag of the component RAM page mapped for writing
+	  */
+	void mapMemoryPage(const unsigned short &page, unsigned char* &readPtr, unsigned char* &writePtr, unsigned char* &dirtyPtr);
+
 	/** Check for pressed / held keyboard keys
 	  */
 	void checkSystemKeys();
+
+	/** Return true if the current frame is drawn
+	  * Frames are drawn when they are not skipped by frame-skip, or when they will be written to an image.
+	  */
+	bool drawingFrame() const ;
+
+	/** Update automatic frame-skip using the wall time spent on the previous frame
+	  */
+	void updateFrameSkip();
+
+	/** Queue the current frame buffer to be written to a PNG image
+	  * @param fname Output image filename
+	  * @param wait If set, wait for the background writer when it is busy. Otherwise the frame is dropped.
+	  * @return True if the frame was queued and return false if it was dropped
+	  */
+	bool writeFrame(const std::string &fname, bool wait);
+
+	/** Take a rewind snapshot, or restore the previous snapshot if the rewind key is held
+	  */
+	void updateRewind();
 };
 
 #endif
@@ -23,6 +23,15 @@ public:
 	bool readRegister(const unsigned short &reg, unsigned char &val) override ;
 	
 	bool onClockUpdate() override ;
+
+	/** Advance the divider and timer counters by multiple system clock ticks at once
+	  */
+	bool onClockAdvance(const unsigned int &nCycles) override ;
+
+	/** Get the number of system clock ticks until the timer counter (TIMA) overflows
+	  * Returns zero if the timer is disabled.
+	  */
+	unsigned int getCyclesUntilNextEvent() override ;
 	
 	void defineRegisters() override ;
 	
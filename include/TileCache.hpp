@@ -0,0 +1,56 @@
+#ifndef TILE_CACHE_HPP
+#define TILE_CACHE_HPP
+
+constexpr unsigned short TILE_CACHE_TILES = 384; ///< Number of 8x8 pixel tile bitmaps in each VRAM bank
+
+constexpr unsigned short TILE_CACHE_BANKS = 2; ///< Number of VRAM banks
+
+class TileCache{
+public:
+	/** Default constructor
+	  */
+	TileCache();
+
+	/** Get a row of decoded pixel colors for a tile bitmap, decoding the tile first if it has been modified
+	  * @param vram Pointer to the start of the VRAM bank containing the tile
+	  * @param index The start address of the tile in VRAM [0x0000,0x1800)
+	  * @param row The vertical pixel row in the tile [0,7] where the top-most row is denoted as row=0
+	  * @param bank The VRAM bank number [0,1]
+	  * @param hflip If set, return the horizontally flipped row
+	  * @return Pointer to 8 pixel colors in the range [0,3], ordered from the left-most to the right-most pixel
+	  */
+	const unsigned char *getRow(const unsigned char *vram, const unsigned short &index, const unsigned char &row, const unsigned char &bank, bool hflip=false){
+		const unsigned short tile = index / 16;
+		if(dirty[bank][tile])
+			decode(vram, tile, bank);
+		return &pixels[bank][hflip ? 1 : 0][tile][8 * row];
+	}
+
+	/** Mark the tile containing the specified VRAM address as modified
+	  * Should be called whenever VRAM tile data is written to.
+	  * @param index Offset of the modified byte from the start of VRAM
+	  * @param bank The VRAM bank number [0,1]
+	  */
+	void invalidate(const unsigned short &index, const unsigned char &bank){
+		if(index < 16 * TILE_CACHE_TILES)
+			dirty[bank][index / 16] = true;
+	}
+
+	/** Mark all tiles as modified
+	  */
+	void clear();
+
+private:
+	bool dirty[TILE_CACHE_BANKS][TILE_CACHE_TILES]; ///< Flags indicating tiles which must be decoded before use
+
+	unsigned char pixels[TILE_CACHE_BANKS][2][TILE_CACHE_TILES][64]; ///< Decoded tile colors (normal and horizontally flipped) for each VRAM bank
+
+	/** Decode the two bitplanes of a tile bitmap into 2-bit pixel colors
+	  * @param vram Pointer to the start of the VRAM bank containing the tile
+	  * @param tile The tile number [0,384)
+	  * @param bank The VRAM bank number [0,1]
+	  */
+	void decode(const unsigned char *vram, const unsigned short &tile, const unsigned char &bank);
+};
+
+#endif
@@ -0,0 +1,29 @@
+#include "BlockCache.hpp"
+
+constexpr unsigned short ROM_BANK_SIZE = 0x4000;
+constexpr unsigned short ROM_HIGH      = 0x8000;
+
+BlockCache::BlockCache() :
+	blocks()
+{
+}
+
+TranslatedBlock *BlockCache::get(const unsigned short &pc, const unsigned short &romBank){
+	if(pc >= ROM_HIGH) // Code in RAM may be modified, it is always interpreted
+		return 0x0;
+	unsigned int key = ((pc < ROM_BANK_SIZE ? 0 : (unsigned int)romBank) << 16) + pc;
+	return &blocks[key];
+}
+
+unsigned int BlockCache::getNumberOfBlocks() const {
+	unsigned int retval = 0;
+	for(auto block = blocks.cbegin(); block != blocks.cend(); block++){
+		if(block->second.translated())
+			retval++;
+	}
+	return retval;
+}
+
+void BlockCache::clear(){
+	blocks.clear();
+}
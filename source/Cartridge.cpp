@@ -3,11 +3,13 @@
 
 #include "Support.hpp"
 #include "SystemRegisters.hpp"
+#include "SystemGBC.hpp"
 #include "Cartridge.hpp"
 
 constexpr unsigned short ROM_ZERO_LOW = 0x0000;
 constexpr unsigned short ROM_SWAP_LOW = 0x4000;
 constexpr unsigned short ROM_HIGH     = 0x8000;
+constexpr unsigned short SRAM_HIGH    = 0xBFFF;
 
 /////////////////////////////////////////////////////////////////////
 // class Cartridge
@@ -64,7 +66,9 @@ bool Cartridge::writeRegister(const unsigned short &reg, const unsigned char &va
 		// No MBC registers
 		return false;
 	}
-	else if(mbcType == CartMBC::MBC1){ // MBC1 (1-3)
+	unsigned short prevRomBank = bs;
+	unsigned short prevRamBank = ram.getBankSelect();
+	if(mbcType == CartMBC::MBC1){ // MBC1 (1-3)
 		// RAM enabled
 		extRamEnabled = (mbcRegisters[0].getBits(0, 3) == 0x0a);
 
@@ -110,6 +114,8 @@ bool Cartridge::writeRegister(const unsigned short &reg, const unsigned char &va
 		// RAM bank
 		ram.setBank(mbcRegisters[3].getBits(0, 3));
 	}
+	if(bs != prevRomBank || ram.getBankSelect() != prevRamBank) // Swap banks in the system memory map
+		sys->updateMemoryPages(ROM_SWAP_LOW, SRAM_HIGH);
 	return true;
 }
 
@@ -143,6 +143,7 @@ void ConsoleGBC::handle(const char& c, bool flag/*=true*/){
 void ConsoleGBC::handleInput(){
 	//handle user input commands here
 	LR35902 *cpu = sys->getCPU();
+	cpu->evaluateFlags(); // The expression parser reads the flags register directly
 	Register* reg = 0x0;
 	std::vector<std::string> args;
 	std::string userinput = toLowercase(line);
@@ -164,6 +164,12 @@ void DmaController::defineRegisters(){
 	sys->addSystemRegister(this, 0x53, rHDMA3, "HDMA3", "33333000"); // Destination high
 	sys->addSystemRegister(this, 0x54, rHDMA4, "HDMA4", "00003333"); // Destination low
 	sys->addSystemRegister(this, 0x55, rHDMA5, "HDMA5", "33333333"); // Length/mode/start
+
+	// Only writes to DMA and HDMA5 start (or stop) a transfer
+	sys->setRegisterWriteHandler(0x46, writeComponentRegister<DmaController>);
+	for(unsigned char reg = 0x51; reg <= 0x54; reg++)
+		sys->setRegisterWriteHandler(reg, 0x0);
+	sys->setRegisterWriteHandler(0x55, writeComponentRegister<DmaController>);
 }
 
 void DmaController::userAddSavestateValues(){
@@ -4,7 +4,7 @@
 #include "SystemGBC.hpp"
 #include "Support.hpp"
 #include "Graphics.hpp"
-#include "ColorGBC.hpp"
+#include "DisplayThread.hpp"
 #include "Console.hpp"
 #include "GPU.hpp"
 #include "SystemClock.hpp"
@@ -20,6 +20,9 @@ constexpr int SCREEN_HEIGHT_PIXELS = 144;
 GPU::GPU() : 
 	SystemComponent("GPU", 0x20555050, 8192, 2, VRAM_LOW), // "PPU " (2 8kB banks of VRAM)
 	winDisplayEnable(false),
+	headless(false),
+	pixelScale(2),
+	pixelFilter(upscaleFilter::NONE),
 	nSpritesDrawn(0),
 	bgPaletteIndex(0),
 	objPaletteIndex(0),
@@ -27,37 +30,65 @@ GPU::GPU() :
 	bgPaletteData(),
 	objPaletteData(),
 	cgbPaletteColor(),
+	cgbPaletteRGBA(),
+	useColorCorrection(false),
+	paletteTableCGB(false),
+	colorCorrectionTable(),
+	framebuffer(SCREEN_WIDTH_PIXELS * SCREEN_HEIGHT_PIXELS, 0),
 	window(),
+	displayThread(),
+	injectedKeys(),
 	console(),
 	currentLineSprite(),
 	currentLineWindow(),
 	currentLineBackground(),
+	compositor(),
+	paletteRGBA(),
 	userLayerEnable{ true, true, true },
-	sprites()
+	spriteTable(),
+	lineSprites(),
+	lineSpriteCount(),
+	spriteIndexHeight(0),
+	spriteIndexCGB(false),
+	tiles()
 {
 }
 
 GPU::~GPU(){
+	displayThread.reset(); // Close the window before it is destroyed
 }
 
 void GPU::initialize(){
 	// Create a new window
-	window = std::unique_ptr<Window>(new Window(SCREEN_WIDTH_PIXELS, SCREEN_HEIGHT_PIXELS, 2));
+	window = std::unique_ptr<Window>(new Window(SCREEN_WIDTH_PIXELS, SCREEN_HEIGHT_PIXELS, pixelScale));
+	window->setUpscaleFilter(pixelFilter, pixelScale);
 #ifdef USE_OPENGL 
 	// Create a link to the LCD driver
 	window->setGPU(this);
 #endif
+	window->setFramebuffer(framebuffer.data());
 
 	// Setup the ascii character map for text output
 	console = std::unique_ptr<ConsoleGBC>(new ConsoleGBC());
 	console->setWindow(window.get());
+	console->setFramebuffer(framebuffer.data(), SCREEN_WIDTH_PIXELS, SCREEN_HEIGHT_PIXELS);
 	console->setSystem(sys);
 	console->setTransparency(false);
 
 	// Setup the window
-	window->initialize();
-	window->setupKeyboardHandler();
-	window->clear();
+	window->setHeadless(headless);
+#ifdef USE_DISPLAY_THREAD
+	if(!window->isHeadless()){ // Presentation and window events are handled by a separate thread
+		displayThread = std::unique_ptr<DisplayThread>(new DisplayThread());
+		displayThread->start(window.get());
+	}
+#endif
+	if(!displayThread){
+		window->initialize();
+		window->setupKeyboardHandler();
+		if(!window->isHeadless())
+			window->clear();
+	}
 
 	// Set default palettes
 	if(bGBCMODE){ // Gameboy Color palettes (all white at startup)
@@ -71,6 +102,10 @@ void GPU::initialize(){
 		cgbPaletteColor[0][2] = Colors::GB_DKGREEN;
 		cgbPaletteColor[0][3] = Colors::GB_DKSTGREEN;
 	}
+	for(int i = 0; i < 16; i++)
+		for(int j = 0; j < 4; j++)
+			cgbPaletteRGBA[i][j] = cgbPaletteColor[i][j].toRGBA();
+	updatePaletteTable();
 }
 
 /** Retrieve the color of a pixel in a tile bitmap.
@@ -96,12 +131,11 @@ unsigned char GPU::getBitmapPixel(const unsigned short &index, const unsigned ch
   * @return The number of pixels drawn.
   */
 unsigned char GPU::drawTile(const unsigned char &x, const unsigned char &y, const unsigned char &x0,
-                            const unsigned short &offset, ColorGBC *line){
+                            const unsigned short &offset, LayerLine &line){
 	unsigned char tileY, tileX;
 	unsigned char pixelY, pixelX;
 	unsigned char tileID;
 	unsigned char tileAttr;
-	unsigned char pixelColor;
 	unsigned short bmpLow;
 	
 	tileY = y / 8; // Current vertical BG tile [0,32)
@@ -140,16 +174,14 @@ unsigned char GPU::drawTile(const unsigned char &x, const unsigned char &y, cons
 	}
 	
 	// Draw the specified line
+	const unsigned char bank = (bgBankNumber ? 1 : 0);
+	const unsigned char *tileRow = tiles.getRow(mem[bank], bmpLow, pixelY, bank, bgHorizontalFlip);
 	unsigned char rx = x;
 	for(unsigned char dx = pixelX; dx <= 7; dx++){
-		if(bGBCMODE){ // Gameboy Color palettes
-			pixelColor = getBitmapPixel(bmpLow, (!bgHorizontalFlip ? (7-dx) : dx), pixelY, (bgBankNumber ? 1 : 0));
-			line[rx].setColorBG(pixelColor, bgPaletteNumber, bgPriority);
-		}
-		else{ // Original gameboy palettes
-			pixelColor = getBitmapPixel(bmpLow, (7-dx), pixelY);
-			line[rx].setColorBG(pixelColor, 0);
-		}
+		if(bGBCMODE) // Gameboy Color palettes
+			line.setColorBG(rx, tileRow[dx], bgPaletteNumber, bgPriority);
+		else // Original gameboy palettes
+			line.setColorBG(rx, tileRow[dx], 0);
 		rx++;
 	}
 	
@@ -157,21 +189,13 @@ unsigned char GPU::drawTile(const unsigned char &x, const unsigned char &y, cons
 	return (7-pixelX)+1;
 }
 
-/** Draw the current sprite.
-  * @param y The current LCD screen scanline [0,256).
+/** Draw one line of a sprite.
+  * @param row The vertical pixel row of the sprite to draw, where the top-most row is denoted as row=0.
   * @param oam The currently selected sprite to draw.
-  * @return Returns true if the current scanline passes through the sprite and return false otherwise.
   */
-bool GPU::drawSprite(const unsigned char &y, const SpriteAttributes &oam){
+void GPU::drawSprite(const unsigned char &row, const SpriteAttributes &oam){
 	unsigned char xp = oam.xPos-8+rSCX->getValue(); // Top left
-	unsigned char yp = oam.yPos-16+rSCY->getValue(); // Top left
-
-	// Check that the current scanline goes through the sprite
-	if(y < yp || y >= yp+(!rLCDC->bit2() ? 8 : 16))
-		return false;
-
-	unsigned char pixelY = y - yp; // Vertical pixel in the tile
-	unsigned char pixelColor;
+	unsigned char pixelY = row; // Vertical pixel in the tile
 	unsigned short bmpLow;
 	
 	// Retrieve the background tile ID from OAM
@@ -193,21 +217,54 @@ bool GPU::drawSprite(const unsigned char &y, const SpriteAttributes &oam){
 	}
 	
 	// Draw the specified line
+	const unsigned char bank = (bGBCMODE && oam.gbcVramBank ? 1 : 0);
+	const unsigned char *tileRow = tiles.getRow(mem[bank], bmpLow, pixelY, bank, oam.xFlip);
 	for(unsigned short dx = 0; dx < 8; dx++){
-		if(!currentLineSprite[xp].getColor()){
-			if(bGBCMODE){ // Gameboy Color sprite palettes (OBP0-7)
-				pixelColor = getBitmapPixel(bmpLow, (!oam.xFlip ? (7-dx) : dx), pixelY, (oam.gbcVramBank ? 1 : 0));
-				currentLineSprite[xp].setColorOBJ(pixelColor, oam.gbcPalette+8, oam.objPriority);
-			}
-			else{ // Original gameboy sprite palettes (OBP0-1)
-				pixelColor = getBitmapPixel(bmpLow, (!oam.xFlip ? (7-dx) : dx), pixelY);
-				currentLineSprite[xp].setColorOBJ(pixelColor, (oam.ngbcPalette ? 2 : 1), oam.objPriority);
-			}
+		if(!currentLineSprite.color[xp]){
+			if(bGBCMODE) // Gameboy Color sprite palettes (OBP0-7)
+				currentLineSprite.setColorOBJ(xp, tileRow[dx], oam.gbcPalette+8, oam.objPriority);
+			else // Original gameboy sprite palettes (OBP0-1)
+				currentLineSprite.setColorOBJ(xp, tileRow[dx], (oam.ngbcPalette ? 2 : 1), oam.objPriority);
 		}
 		xp++;
 	}
-	
-	return true;
+}
+
+void GPU::updateSpriteIndex(SpriteHandler *oam){
+	const unsigned char height = (!rLCDC->bit2() ? 8 : 16);
+	if(spriteIndexHeight == 0 || spriteIndexCGB != bGBCMODE){ // Decode all sprites
+		for(unsigned char i = 0; i < 40; i++)
+			spriteTable[i] = oam->getSpriteAttributes(i);
+		oam->reset(); // Ignore pending updates
+	}
+	else{ // Decode modified sprites only
+		while(oam->updateNextSprite(spriteTable)){
+		}
+	}
+
+	// Select up to 10 sprites for each scanline, in OAM order. Only the Y position is checked, sprites which
+	// are horizontally off screen still use up one of the 10 slots (they are skipped when drawing).
+	for(unsigned short y = 0; y < SCREEN_HEIGHT_PIXELS; y++)
+		lineSpriteCount[y] = 0;
+	for(unsigned char i = 0; i < 40; i++){
+		int top = spriteTable[i].yPos - 16; // Top scanline of the sprite (may be off screen)
+		for(int y = std::max(top, 0); y < std::min(top + height, SCREEN_HEIGHT_PIXELS); y++){
+			if(lineSpriteCount[y] < MAX_SPRITES_PER_LINE)
+				lineSprites[y][lineSpriteCount[y]++] = i;
+		}
+	}
+
+	// Sort sprites by priority.
+	if(!bGBCMODE){ // GBC sprite priority is assigned based solely on table ordering
+		for(unsigned short y = 0; y < SCREEN_HEIGHT_PIXELS; y++){
+			std::stable_sort(&lineSprites[y][0], &lineSprites[y][lineSpriteCount[y]], [this](const unsigned char &s1, const unsigned char &s2){ 
+				return SpriteAttributes::compareDMG(spriteTable[s1], spriteTable[s2]); 
+			});
+		}
+	}
+
+	spriteIndexHeight = height;
+	spriteIndexCGB = bGBCMODE;
 }
 
 void GPU::drawConsole(){
@@ -254,13 +311,13 @@ void GPU::drawTileMaps(Window *win){
 void GPU::drawLayer(Window *win, bool mapSelect/*=true*/){
 	win->setCurrent();
 	unsigned char pixelX;
-	ColorGBC line[256];
+	LayerLine line;
 	for(unsigned short y = 0; y < 256; y++){
 		pixelX = 0;
 		for(unsigned short tx = 0; tx <= 32; tx++) // Draw the layer
 			pixelX += drawTile(pixelX, (unsigned char)y, 0, (mapSelect ? 0x1C00 : 0x1800), line);
-		for(unsigned short px = 0; px <= 256; px++){ // Draw the tile
-			switch(line[px].getColor()){
+		for(unsigned short px = 0; px < 256; px++){ // Draw the tile
+			switch(line.color[px]){
 				case 0:
 					win->setDrawColor(Colors::WHITE);
 					break;
@@ -282,8 +339,6 @@ void GPU::drawLayer(Window *win, bool mapSelect/*=true*/){
 }
 
 unsigned short GPU::drawNextScanline(SpriteHandler *oam){
-	window->setCurrent();
-
 	// The pixel clock delay is dependent upon the number of sprites drawn on a given
 	//  scanline, the background scroll register SCX, and the state of the window layer.
 	unsigned short nPauseTicks = 0;
@@ -291,19 +346,18 @@ unsigned short GPU::drawNextScanline(SpriteHandler *oam){
 	// Here (ry) is the real vertical coordinate on the background
 	// and (rLY) is the current scanline.
 	unsigned char ry = rLY->getValue() + rSCY->getValue();
+
+	// Output pixels for the current scanline
+	uint32_t *currentLineOutput = &framebuffer[rLY->getValue() * SCREEN_WIDTH_PIXELS];
 	
 	if(!rLCDC->bit7()){ // Screen disabled (draw a "white" line)
-		if(bGBCMODE)
-			window->setDrawColor(Colors::WHITE);
-		else
-			window->setDrawColor(cgbPaletteColor[0][0]);
-		window->drawLine(0, rLY->getValue(), 159, rLY->getValue());
+		std::fill(currentLineOutput, currentLineOutput + SCREEN_WIDTH_PIXELS, (bGBCMODE ? Colors::WHITE.toRGBA() : cgbPaletteRGBA[0][0]));
 		return 0;
 	}
 
 	unsigned char rx = rSCX->getValue(); // This will automatically handle screen wrapping
 	for(unsigned short x = 0; x < 160; x++) // Reset the sprite line
-		currentLineSprite[rx++].reset();
+		currentLineSprite.reset(rx++);
 
 	// A non-zero scroll (SCX) will delay the clock SCX % 8 ticks.		
 	nPauseTicks += rx % 8;
@@ -316,7 +370,7 @@ unsigned short GPU::drawNextScanline(SpriteHandler *oam){
 	}
 	else{ // Background disabled (white)
 		for(unsigned short x = 0; x < 160; x++) // Draw a "white" line
-			currentLineBackground[rx++].reset();
+			currentLineBackground.reset(rx++);
 	}
 
 	// Handle the window layer
@@ -341,113 +395,38 @@ unsigned short GPU::drawNextScanline(SpriteHandler *oam){
 	rx = rSCX->getValue();
 	if(rLCDC->bit1() && userLayerEnable[2]){
 		nSpritesDrawn = 0;
-		if(oam->modified()){
-			// Gather sprite attributes from OAM
-			while(oam->updateNextSprite(sprites)){
-			}
-			// Sort sprites by priority.
-			std::sort(sprites.begin(), sprites.end(), (bGBCMODE ? SpriteAttributes::compareCGB : SpriteAttributes::compareDMG));
+		if(oam->modified() || spriteIndexHeight != (!rLCDC->bit2() ? 8 : 16) || spriteIndexCGB != bGBCMODE){
+			// Sprite attributes or sprite size changed, rebuild the list of sprites on each scanline
+			updateSpriteIndex(oam);
 		}
-		if(!sprites.empty()){
-			// Search for sprites which overlap this scanline
-			// Get the number of sprites on this scanline
-			// Each sprite pauses the clock for N = 11 - min(5, (x + SCX) mod 8)
-			for(auto sp = sprites.cbegin(); sp != sprites.cend(); sp++){
-				if(drawSprite(ry, *sp)){ // Draw the line of the sprite
-					nPauseTicks += 11 - std::min(5, (sp->xPos + rx) % 8);
-					if(++nSpritesDrawn >= MAX_SPRITES_PER_LINE) // Max sprites per line
-						break;
-				}
-			}
+		// Each sprite pauses the clock for N = 11 - min(5, (x + SCX) mod 8)
+		const unsigned char y = rLY->getValue();
+		for(unsigned char i = 0; i < lineSpriteCount[y]; i++){
+			const SpriteAttributes &sp = spriteTable[lineSprites[y][i]];
+			if(sp.offscreenX()) // Selected for the scanline, but not visible
+				continue;
+			drawSprite(y - (sp.yPos - 16), sp); // Draw the line of the sprite
+			nPauseTicks += 11 - std::min(5, (sp.xPos + rx) % 8);
+			nSpritesDrawn++;
 		}
 	}
 	
 	// Render the current scanline
-	rx = rSCX->getValue(); // This will automatically handle screen wrapping
-	ColorGBC *currentPixel;
-	ColorRGB *currentPixelRGB; // Real RGB color of the current pixel
-	unsigned char layerSelect = 0;
-	for(unsigned short x = 0; x < 160; x++){ // Draw the scanline
-		// Determine what layer should be drawn
-		// CGB:
-		//  LCDC bit 0 - 0=Sprites always on top of BG/WIN, 1=BG/WIN have priority
-		//  Tile attr priority bit - 0=Use OAM priority bit, 1=BG Priority
-		//  OAM sprite priority bit - 0=OBJ Above BG, 1=OBJ Behind BG color 1-3
-		// DMG:
-		//  LCDC bit 0 - 0=Off (white), 1=On
-		//  OAM sprite priority bit - 0=OBJ Above BG, 1=OBJ Behind BG color 1-3
-		// 
-		if(bGBCMODE){
-			if(rLCDC->bit0()){ // BG/WIN priority
-				if(currentLineBackground[rx].getPriority()){ // BG priority (tile attributes)
-					if(windowVisible && x >= (rWX->getValue()-7)) // Draw window
-						layerSelect = 1;
-					else // Draw background
-						layerSelect = 0;
-				}
-				else if(currentLineSprite[rx].visible()){ // Use OAM priority bit
-					if(currentLineSprite[rx].getPriority() && currentLineBackground[rx].getColor()){ // OBJ behind BG color 1-3
-						if(windowVisible && x >= (rWX->getValue()-7)) // Draw window
-								layerSelect = 1;
-							else // Draw background
-								layerSelect = 0;
-					}
-					else // OBJ above BG (except for color 0 which is always transparent)
-						layerSelect = 2;
-				}
-				else{ // Draw background or window
-					if(windowVisible && x >= (rWX->getValue()-7)) // Draw window
-						layerSelect = 1;
-					else // Draw background
-						layerSelect = 0;
-				}
-			}
-			else{ // Sprites always on top (if visible)
-				if(currentLineSprite[rx].visible()) // Draw sprite
-					layerSelect = 2;
-				else if(windowVisible && x >= (rWX->getValue()-7)) // Draw window
-					layerSelect = 1;
-				else // Draw background
-					layerSelect = 0;
-			}
-		}
-		else{
-			if(currentLineSprite[rx].visible()){ // Use OAM priority bit
-				if(currentLineSprite[rx].getPriority() && currentLineBackground[rx].getColor()){ // OBJ behind BG color 1-3
-					if(windowVisible && x >= (rWX->getValue()-7)) // Draw window
-							layerSelect = 1;
-						else // Draw background
-							layerSelect = 0;
-				}
-				else // OBJ above BG (except for color 0 which is always transparent)
-					layerSelect = 2;
-			}
-			else if(windowVisible && x >= (rWX->getValue()-7)) // Draw window
-				layerSelect = 1;
-			else // Draw background
-				layerSelect = 0;
-		}
-		switch(layerSelect){
-			case 0: // Draw background
-				currentPixel = &currentLineBackground[rx];
-				break;
-			case 1: // Draw window
-				currentPixel = &currentLineWindow[x];
-				break;
-			case 2: // Draw sprite
-				currentPixel = &currentLineSprite[rx];
-				break;
-			default:
-				break;
-		}
-		if(bGBCMODE)
-			currentPixelRGB = &cgbPaletteColor[currentPixel->getPalette()][currentPixel->getColor()];
-		else
-			currentPixelRGB = &cgbPaletteColor[0][dmgPaletteColor[currentPixel->getPalette()][currentPixel->getColor()]];
-		window->setDrawColor(currentPixelRGB);
-		window->drawPixel(x, rLY->getValue());
-		rx++;
-	}
+	// CGB:
+	//  LCDC bit 0 - 0=Sprites always on top of BG/WIN, 1=BG/WIN have priority
+	//  Tile attr priority bit - 0=Use OAM priority bit, 1=BG Priority
+	//  OAM sprite priority bit - 0=OBJ Above BG, 1=OBJ Behind BG color 1-3
+	// DMG:
+	//  LCDC bit 0 - 0=Off (white), 1=On
+	//  OAM sprite priority bit - 0=OBJ Above BG, 1=OBJ Behind BG color 1-3
+	if(paletteTableCGB != bGBCMODE) // Emulation mode changed, palette table must be rebuilt
+		updatePaletteTable();
+	if(bGBCMODE)
+		compositor.setPriorityMode(rLCDC->bit0(), rLCDC->bit0());
+	else
+		compositor.setPriorityMode(true, false);
+	short windowStart = (windowVisible ? rWX->getValue()-7 : SCREEN_WIDTH_PIXELS);
+	compositor.composite(currentLineBackground, currentLineWindow, currentLineSprite, rSCX->getValue(), windowStart, paletteRGBA, currentLineOutput);
 	
 	// Return the number of pixel clock ticks to delay HBlank interval
 	return nPauseTicks;
@@ -455,6 +434,11 @@ unsigned short GPU::drawNextScanline(SpriteHandler *oam){
 
 void GPU::render(){	
 	// Update the screen
+	if(displayThread){
+		if(rLCDC->bit7())
+			displayThread->present(framebuffer.data());
+		return;
+	}
 	window->setCurrent();
 	if(rLCDC->bit7() && window->status()){ // Check for events
 		window->render();
@@ -462,14 +446,62 @@ void GPU::render(){
 }
 
 void GPU::processEvents(){
+	KeyStates *keys = window->getKeypress();
+	KeyEvent evt;
+	while(injectedKeys.pop(evt)){ // Apply keyboard events injected programmatically
+		if(evt.down)
+			keys->keyDown(evt.key);
+		else
+			keys->keyUp(evt.key);
+	}
+	if(displayThread){ // Apply keyboard events received by the display thread
+		while(displayThread->getKeyEvent(evt)){
+			if(evt.down)
+				keys->keyDown(evt.key);
+			else
+				keys->keyUp(evt.key);
+		}
+		return;
+	}
 	window->setCurrent();
 	window->processEvents();
 }
 
+unsigned long long GPU::getFrameHash() const {
+	// 64-bit FNV-1a hash of all pixels
+	unsigned long long hash = 0xCBF29CE484222325ULL;
+	const unsigned char *ptr = reinterpret_cast<const unsigned char*>(framebuffer.data());
+	for(size_t i = 0; i < framebuffer.size() * sizeof(uint32_t); i++){
+		hash ^= ptr[i];
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
 bool GPU::getWindowStatus(){
+	if(displayThread)
+		return displayThread->running();
 	return window->status();
 }
 
+void GPU::setKeyboardStreamMode(){
+	if(displayThread){
+		displayThread->setKeyRepeat(true);
+		window->getKeypress()->enableStreamMode();
+	}
+	else
+		window->setKeyboardStreamMode();
+}
+
+void GPU::setKeyboardToggleMode(){
+	if(displayThread){
+		displayThread->setKeyRepeat(false);
+		window->getKeypress()->disableStreamMode();
+	}
+	else
+		window->setKeyboardToggleMode();
+}
+
 unsigned char GPU::getDmgPaletteColorHex(const unsigned short &index) const {
 	return dmgPaletteColor[index/4][index%4];
 }
@@ -483,7 +515,62 @@ unsigned short GPU::getObjPaletteColorHex(const unsigned short &index) const {
 }
 
 void GPU::setPixelScale(const unsigned int &n){
-	window->setScalingFactor(n);
+	if(n == 0)
+		return;
+	pixelScale = n;
+	pixelFilter = upscaleFilter::NONE;
+	if(displayThread)
+		displayThread->setUpscaleFilter(pixelFilter, n);
+	else if(window)
+		window->setUpscaleFilter(pixelFilter, n);
+}
+
+bool GPU::setPixelScale(const std::string &str){
+	if(!str.empty() && str.find_first_not_of("0123456789") == std::string::npos){ // Integer scaling factor
+		unsigned int n = strtoul(str.c_str(), NULL, 10);
+		setPixelScale(n);
+		return (n != 0);
+	}
+	upscaleFilter filter;
+	unsigned int n;
+	if(!Upscaler::parse(str, filter, n))
+		return false;
+	pixelScale = n;
+	pixelFilter = filter;
+	if(displayThread)
+		displayThread->setUpscaleFilter(pixelFilter, n);
+	else if(window)
+		window->setUpscaleFilter(pixelFilter, n);
+	return true;
+}
+
+void GPU::setColorCorrection(bool state/*=true*/){
+	useColorCorrection = state;
+	if(!useColorCorrection || !colorCorrectionTable.empty())
+		return;
+	// Approximate the colors of the GBC LCD, which are washed out and bleed into one another
+	colorCorrectionTable.resize(32768);
+	for(unsigned int color = 0; color < 32768; color++){
+		unsigned int r = color & 0x1F;
+		unsigned int g = (color & 0x3E0) >> 5;
+		unsigned int b = (color & 0x7C00) >> 10;
+		unsigned int rp = std::min(960u, r * 26 + g * 4 + b * 2) >> 2;
+		unsigned int gp = std::min(960u, g * 24 + b * 8) >> 2;
+		unsigned int bp = std::min(960u, r * 6 + g * 4 + b * 22) >> 2;
+		colorCorrectionTable[color] = ColorRGB::packRGBA(rp, gp, bp);
+	}
+}
+
+void GPU::refreshPalettes(){
+	if(bGBCMODE){
+		for(unsigned char i = 0; i < 64; i += 2){
+			cgbPaletteColor[i/8][(i%8)/2] = getColorRGB(bgPaletteData[i], bgPaletteData[i+1]);
+			cgbPaletteRGBA[i/8][(i%8)/2] = getColorRGBA(bgPaletteData[i], bgPaletteData[i+1]);
+			cgbPaletteColor[i/8+8][(i%8)/2] = getColorRGB(objPaletteData[i], objPaletteData[i+1]);
+			cgbPaletteRGBA[i/8+8][(i%8)/2] = getColorRGBA(objPaletteData[i], objPaletteData[i+1]);
+		}
+	}
+	updatePaletteTable();
 }
 
 void GPU::print(const std::string &str, const unsigned char &x, const unsigned char &y){
@@ -525,6 +612,7 @@ bool GPU::writeRegister(const unsigned short &reg, const unsigned char &val){
 			dmgPaletteColor[0][1] = rBGP->getBits(2,3);
 			dmgPaletteColor[0][2] = rBGP->getBits(4,5);
 			dmgPaletteColor[0][3] = rBGP->getBits(6,7); 
+			updateDmgPalette(0);
 			break;
 		case 0xFF48: // OBP0 (Object palette 0 data, non-gbc mode only)
 			// See BGP above
@@ -532,6 +620,7 @@ bool GPU::writeRegister(const unsigned short &reg, const unsigned char &val){
 			dmgPaletteColor[1][1] = rOBP0->getBits(2,3); 
 			dmgPaletteColor[1][2] = rOBP0->getBits(4,5); 
 			dmgPaletteColor[1][3] = rOBP0->getBits(6,7); 
+			updateDmgPalette(1);
 			break;
 		case 0xFF49: // OBP1 (Object palette 1 data, non-gbc mode only)
 			// See BGP above
@@ -539,6 +628,7 @@ bool GPU::writeRegister(const unsigned short &reg, const unsigned char &val){
 			dmgPaletteColor[2][1] = rOBP1->getBits(2,3);
 			dmgPaletteColor[2][2] = rOBP1->getBits(4,5);
 			dmgPaletteColor[2][3] = rOBP1->getBits(6,7);
+			updateDmgPalette(2);
 			break;
 		case 0xFF4A: // WY (Window Y Position)
 			checkWindowVisible();
@@ -548,6 +638,7 @@ bool GPU::writeRegister(const unsigned short &reg, const unsigned char &val){
 			break;
 		case 0xFF4F: // VBK (VRAM bank select, gbc mode)
 			bs = rVBK->bit0() ? 1 : 0;
+			sys->updateMemoryPages(VRAM_LOW, VRAM_HIGH-1); // Swap VRAM bank in the system memory map
 			break;
 		case 0xFF68: // BGPI (Background palette index, gbc mode)
 			bgPaletteIndex = rBGPI->getBits(0,5); // Index in the BG palette byte array
@@ -643,7 +734,12 @@ void GPU::updateBackgroundPalette(){
 		lowByte = bgPaletteData[bgPaletteIndex];
 		highByte = bgPaletteData[bgPaletteIndex+1];
 	}
-	cgbPaletteColor[bgPaletteIndex/8][(bgPaletteIndex%8)/2] = getColorRGB(lowByte, highByte);
+	unsigned char palette = bgPaletteIndex/8;
+	unsigned char color = (bgPaletteIndex%8)/2;
+	cgbPaletteColor[palette][color] = getColorRGB(lowByte, highByte);
+	cgbPaletteRGBA[palette][color] = getColorRGBA(lowByte, highByte);
+	if(bGBCMODE)
+		paletteRGBA[4*palette+color] = cgbPaletteRGBA[palette][color];
 }
 
 /** Update true RGB sprite palette by converting GBC format colors.
@@ -659,7 +755,38 @@ void GPU::updateObjectPalette(){
 		lowByte = objPaletteData[objPaletteIndex];
 		highByte = objPaletteData[objPaletteIndex+1];	
 	}
-	cgbPaletteColor[objPaletteIndex/8+8][(objPaletteIndex%8)/2] = getColorRGB(lowByte, highByte);
+	unsigned char palette = objPaletteIndex/8+8;
+	unsigned char color = (objPaletteIndex%8)/2;
+	cgbPaletteColor[palette][color] = getColorRGB(lowByte, highByte);
+	cgbPaletteRGBA[palette][color] = getColorRGBA(lowByte, highByte);
+	if(bGBCMODE)
+		paletteRGBA[4*palette+color] = cgbPaletteRGBA[palette][color];
+}
+
+uint32_t GPU::getColorRGBA(const unsigned char &low, const unsigned char &high){
+	if(useColorCorrection)
+		return colorCorrectionTable[(low + (high << 8)) & 0x7FFF];
+	return getColorRGB(low, high).toRGBA();
+}
+
+void GPU::updatePaletteTable(){
+	if(bGBCMODE){ // Gameboy Color palettes (BG 0-7 followed by OBJ 0-7)
+		for(unsigned short i = 0; i < 16; i++)
+			for(unsigned short j = 0; j < 4; j++)
+				paletteRGBA[4*i+j] = cgbPaletteRGBA[i][j];
+	}
+	else{ // Original gameboy palettes (BGP, OBP0, OBP1)
+		for(unsigned char i = 0; i < 3; i++)
+			updateDmgPalette(i);
+	}
+	paletteTableCGB = bGBCMODE;
+}
+
+void GPU::updateDmgPalette(const unsigned char &index){
+	if(bGBCMODE) // DMG palettes are not used in GBC mode
+		return;
+	for(unsigned short j = 0; j < 4; j++)
+		paletteRGBA[4*index+j] = cgbPaletteRGBA[0][dmgPaletteColor[index][j]];
 }
 
 void GPU::defineRegisters(){
@@ -680,6 +807,14 @@ void GPU::defineRegisters(){
 	sys->addSystemRegister(this, 0x69, rBGPD, "BGPD", "33333333");
 	sys->addSystemRegister(this, 0x6A, rOBPI, "OBPI", "33333303");
 	sys->addSystemRegister(this, 0x6B, rOBPD, "OBPD", "33333333");
+
+	// Call the GPU register handler directly, writes to STAT, SCY, SCX, LYC, and WLY require no action
+	const unsigned char activeRegisters[] = { 0x40, 0x44, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4F, 0x68, 0x69, 0x6A, 0x6B };
+	const unsigned char passiveRegisters[] = { 0x41, 0x42, 0x43, 0x45, 0x4C };
+	for(auto reg : activeRegisters)
+		sys->setRegisterWriteHandler(reg, writeComponentRegister<GPU>);
+	for(auto reg : passiveRegisters)
+		sys->setRegisterWriteHandler(reg, 0x0);
 }
 
 bool GPU::checkWindowVisible(){	
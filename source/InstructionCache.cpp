@@ -0,0 +1,73 @@
+#include "InstructionCache.hpp"
+
+constexpr unsigned short ROM_BANK_SIZE   = 0x4000;
+constexpr unsigned short WRAM_BANK_SIZE  = 0x1000;
+constexpr unsigned short WRAM_ZERO_LOW   = 0xC000;
+constexpr unsigned short WRAM_SWAP_LOW   = 0xD000;
+constexpr unsigned short WRAM_ECHO_LOW   = 0xE000;
+constexpr unsigned short WRAM_ECHO_HIGH  = 0xFE00;
+constexpr unsigned short HRAM_LOW        = 0xFF80;
+constexpr unsigned short HRAM_HIGH       = 0xFFFF;
+
+constexpr unsigned short WRAM_BANKS = 8;
+
+InstructionCache::InstructionCache() :
+	rom(),
+	wram(WRAM_BANK_SIZE * WRAM_BANKS),
+	hram(HRAM_HIGH - HRAM_LOW)
+{
+}
+
+DecodedInstruction *InstructionCache::get(const unsigned short &pc, const unsigned short &romBank, const unsigned short &wramBank){
+	if(pc < 0x8000){ // Cartridge ROM
+		// The same ROM bank may be mapped into either half of ROM space, so only the offset into the bank is used
+		unsigned short bank = (pc < ROM_BANK_SIZE ? 0 : romBank);
+		if(bank >= rom.size())
+			rom.resize(bank + 1);
+		if(rom[bank].empty())
+			rom[bank].resize(ROM_BANK_SIZE);
+		return &rom[bank][pc % ROM_BANK_SIZE];
+	}
+	else if(pc >= WRAM_ZERO_LOW && pc < WRAM_SWAP_LOW){ // WRAM bank 0
+		return &wram[pc - WRAM_ZERO_LOW];
+	}
+	else if(pc >= WRAM_SWAP_LOW && pc < WRAM_ECHO_LOW){ // WRAM bank 1-7
+		return &wram[(wramBank % WRAM_BANKS) * WRAM_BANK_SIZE + (pc - WRAM_SWAP_LOW)];
+	}
+	else if(pc >= HRAM_LOW && pc < HRAM_HIGH){ // HRAM
+		return &hram[pc - HRAM_LOW];
+	}
+	return 0x0;
+}
+
+void InstructionCache::store(const unsigned short &pc, const unsigned short &nBytes, const unsigned short &romBank, const unsigned short &wramBank, const DecodedInstruction &instr){
+	unsigned int last = pc + nBytes - 1;
+	if(last >= HRAM_HIGH || ((pc ^ last) & 0xF000) != 0) // Instruction crosses a memory page boundary
+		return;
+	DecodedInstruction *entry = get(pc, romBank, wramBank);
+	if(entry)
+		(*entry) = instr;
+}
+
+void InstructionCache::invalidate(const unsigned short &loc, const unsigned short &wramBank){
+	unsigned short addr = loc;
+	if(addr >= WRAM_ECHO_LOW && addr < WRAM_ECHO_HIGH) // Echo of WRAM bank 0 and 1
+		addr -= 0x2000;
+	else if(addr < WRAM_ZERO_LOW || addr >= HRAM_HIGH) // Instructions are only cached for WRAM and HRAM
+		return;
+	for(unsigned short i = 0; i < 3; i++){ // Instructions are at most three bytes long
+		if(addr - i < WRAM_ZERO_LOW)
+			break;
+		DecodedInstruction *entry = get(addr - i, 0, wramBank);
+		if(entry)
+			entry->op = 0x0;
+	}
+}
+
+void InstructionCache::clear(){
+	rom.clear();
+	for(auto entry = wram.begin(); entry != wram.end(); entry++)
+		entry->op = 0x0;
+	for(auto entry = hram.begin(); entry != hram.end(); entry++)
+		entry->op = 0x0;
+}
@@ -0,0 +1,463 @@
+#include <cstring>
+
+#include "Opcode.hpp"
+#include "JitCompiler.hpp"
+
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+	#define JIT_X86_64
+	#include <sys/mman.h>
+#endif
+
+constexpr size_t CODE_CHUNK_SIZE = 1024 * 1024; ///< Size of each executable memory mapping (in bytes)
+
+constexpr unsigned int MIN_NATIVE_SEGMENT = 2; ///< Shortest run of register instructions which is compiled to native code
+
+// Host registers used by compiled code
+//  rbx = CPU pointer, r12 = block state pointer, r13 = host flag conversion table
+//  al, ah, cl = scratch
+const unsigned char HOST_AL = 0;
+const unsigned char HOST_CL = 1;
+const unsigned char HOST_AH = 4;
+
+// Conditional jump condition codes
+const unsigned char HOST_JE = 0x84;
+const unsigned char HOST_JNE = 0x85;
+const unsigned char HOST_JA = 0x87;
+
+// LR35902 operand encoding of the 8-bit registers
+const unsigned char REG_H = 4;
+const unsigned char REG_L = 5;
+const unsigned char REG_aHL = 6;
+const unsigned char REG_A = 7;
+
+/** LR35902 flags (Z, H, and C) for each value of the host flags loaded into AH by LAHF
+  * (host SF=0x80, ZF=0x40, AF=0x10, PF=0x04, CF=0x01)
+  */
+static unsigned char hostFlagTable[256];
+
+JitCompiler::JitCompiler() :
+	layout(),
+	chunks(),
+	code(),
+	exitJumps()
+{
+	for(unsigned short i = 0; i < 256; i++)
+		hostFlagTable[i] = ((i & 0x40) ? 0x80 : 0) | ((i & 0x10) ? 0x20 : 0) | ((i & 0x01) ? 0x10 : 0);
+}
+
+JitCompiler::~JitCompiler(){
+	clear();
+}
+
+bool JitCompiler::isSupported(){
+#ifdef JIT_X86_64
+	return true;
+#else
+	return false;
+#endif
+}
+
+size_t JitCompiler::getCodeSize() const {
+	size_t retval = 0;
+	for(auto chunk = chunks.cbegin(); chunk != chunks.cend(); chunk++)
+		retval += chunk->used;
+	return retval;
+}
+
+NativeBlockFunc JitCompiler::compile(const TranslatedBlock *block){
+	if(!isSupported() || !block->translated())
+		return 0x0;
+	code.clear();
+	exitJumps.clear();
+
+	// Prologue
+	emit({ 0x53 }); // push rbx
+	emit({ 0x41, 0x54 }); // push r12
+	emit({ 0x41, 0x55 }); // push r13 (stack is now 16 byte aligned for calls)
+	emit({ 0x48, 0x89, 0xFB }); // mov rbx, rdi
+	emit({ 0x49, 0x89, 0xF4 }); // mov r12, rsi
+	emit({ 0x49, 0xBD }); // mov r13, imm64
+	emit64((uint64_t)(uintptr_t)hostFlagTable);
+
+	const std::vector<TranslatedInstruction> &instructions = block->instructions;
+	bool anyNative = false;
+	unsigned int index = 0;
+	while(index < instructions.size()){
+		// Find the next run of register instructions
+		unsigned int last = index;
+		unsigned int nCycles = 0;
+		while(last < instructions.size() && isNative(instructions[last]))
+			nCycles += getCycles(instructions[last++]);
+		unsigned int count = last - index;
+		if(count < MIN_NATIVE_SEGMENT){ // Execute the next instruction through the CPU
+			emitCall((const void *)layout.step, index);
+			emit({ 0x84, 0xC0 }); // test al, al
+			emitExitJump(HOST_JNE);
+			index++;
+			continue;
+		}
+
+		// The CPU decides whether the segment may run natively (no system event is due before it ends)
+		emitCall((const void *)layout.enterSegment, index, count, nCycles);
+		emit({ 0x83, 0xF8, 0x01 }); // cmp eax, 1
+		emit({ 0x0F, HOST_JE }); // je (skip native code)
+		size_t skipJump = code.size();
+		emit32(0);
+		emitExitJump(HOST_JA);
+		for(unsigned int i = index; i < last; i++){
+			if(layout.trace)
+				emitCall((const void *)layout.trace, i);
+			emitInstruction(instructions[i]);
+		}
+		emitCall((const void *)layout.leaveSegment, index, count, nCycles);
+		uint32_t skipOffset = (uint32_t)(code.size() - (skipJump + 4));
+		memcpy(&code[skipJump], &skipOffset, 4);
+		anyNative = true;
+		index = last;
+	}
+	if(!anyNative) // Nothing to gain over the block engine
+		return 0x0;
+
+	// Epilogue
+	for(auto jump = exitJumps.cbegin(); jump != exitJumps.cend(); jump++){
+		uint32_t offset = (uint32_t)(code.size() - (*jump + 4));
+		memcpy(&code[*jump], &offset, 4);
+	}
+	emit({ 0x41, 0x5D }); // pop r13
+	emit({ 0x41, 0x5C }); // pop r12
+	emit({ 0x5B }); // pop rbx
+	emit({ 0xC3 }); // ret
+	return install();
+}
+
+void JitCompiler::clear(){
+#ifdef JIT_X86_64
+	for(auto chunk = chunks.cbegin(); chunk != chunks.cend(); chunk++)
+		munmap(chunk->base, chunk->size);
+#endif
+	chunks.clear();
+}
+
+bool JitCompiler::isNative(const TranslatedInstruction &instr) const {
+	const Opcode *op = (!instr.cbPrefix ? &layout.opcodes[instr.nIndex] : &layout.opcodesCB[instr.nIndex]);
+	if(op->addrptr || op->nReadCycles || op->nWriteCycles) // Memory access
+		return false;
+	const unsigned char index = instr.nIndex;
+	if(instr.cbPrefix) // Rotates, shifts, and bit operations
+		return ((index & 0x7) != REG_aHL);
+	if(index >= 0x40 && index < 0xC0) // LD r,r and ALU A,r
+		return ((index & 0x7) != REG_aHL && (index >= 0x80 || ((index >> 3) & 0x7) != REG_aHL));
+	switch(index & 0xC7){
+		case 0x04: // INC r
+		case 0x05: // DEC r
+		case 0x06: // LD r,d8
+			return (((index >> 3) & 0x7) != REG_aHL);
+		case 0xC6: // ALU A,d8
+			return true;
+		default:
+			break;
+	}
+	switch(index & 0xCF){
+		case 0x01: // LD rr,d16
+		case 0x03: // INC rr
+		case 0x09: // ADD HL,rr
+		case 0x0B: // DEC rr
+			return true;
+		default:
+			break;
+	}
+	switch(index){
+		case 0x00: // NOP
+		case 0x07: // RLCA
+		case 0x0F: // RRCA
+		case 0x17: // RLA
+		case 0x1F: // RRA
+		case 0x2F: // CPL
+		case 0x37: // SCF
+		case 0x3F: // CCF
+		case 0xF9: // LD SP,HL
+			return true;
+		default:
+			break;
+	}
+	return false;
+}
+
+unsigned short JitCompiler::getCycles(const TranslatedInstruction &instr) const {
+	return (!instr.cbPrefix ? layout.opcodes[instr.nIndex].nCycles : layout.opcodesCB[instr.nIndex].nCycles);
+}
+
+NativeBlockFunc JitCompiler::install(){
+#ifdef JIT_X86_64
+	if(chunks.empty() || chunks.back().used + code.size() > chunks.back().size){
+		CodeChunk chunk;
+		chunk.size = (code.size() > CODE_CHUNK_SIZE ? code.size() : CODE_CHUNK_SIZE);
+		void *ptr = mmap(0x0, chunk.size, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(ptr == MAP_FAILED)
+			return 0x0;
+		chunk.base = (unsigned char *)ptr;
+		chunk.used = 0;
+		chunks.push_back(chunk);
+	}
+
+	// Code is only writable while it is being copied
+	CodeChunk &chunk = chunks.back();
+	if(mprotect(chunk.base, chunk.size, PROT_READ | PROT_WRITE) != 0)
+		return 0x0;
+	unsigned char *dest = chunk.base + chunk.used;
+	memcpy(dest, code.data(), code.size());
+	chunk.used += (code.size() + 15) & ~((size_t)15); // Keep blocks 16 byte aligned
+	if(chunk.used > chunk.size)
+		chunk.used = chunk.size;
+	if(mprotect(chunk.base, chunk.size, PROT_READ | PROT_EXEC) != 0)
+		return 0x0;
+	return reinterpret_cast<NativeBlockFunc>(dest);
+#else
+	return 0x0;
+#endif
+}
+
+void JitCompiler::emit(const std::vector<unsigned char> &bytes){
+	code.insert(code.end(), bytes.begin(), bytes.end());
+}
+
+void JitCompiler::emit32(const uint32_t &value){
+	for(int i = 0; i < 4; i++)
+		code.push_back((value >> (8 * i)) & 0xFF);
+}
+
+void JitCompiler::emit64(const uint64_t &value){
+	for(int i = 0; i < 8; i++)
+		code.push_back((value >> (8 * i)) & 0xFF);
+}
+
+void JitCompiler::emitMem(const unsigned char &opcode, const unsigned char &reg, const int &offset){
+	code.push_back(opcode);
+	code.push_back(0x83 | (reg << 3)); // mod=10 (disp32), rm=rbx
+	emit32((uint32_t)offset);
+}
+
+void JitCompiler::emitCall(const void *func, const unsigned int &arg1, const unsigned int &arg2/*=0*/, const unsigned int &arg3/*=0*/){
+	emit({ 0x4C, 0x89, 0xE7 }); // mov rdi, r12
+	emit({ 0xBE }); // mov esi, imm32
+	emit32(arg1);
+	emit({ 0xBA }); // mov edx, imm32
+	emit32(arg2);
+	emit({ 0xB9 }); // mov ecx, imm32
+	emit32(arg3);
+	emit({ 0x48, 0xB8 }); // mov rax, imm64
+	emit64((uint64_t)(uintptr_t)func);
+	emit({ 0xFF, 0xD0 }); // call rax
+}
+
+void JitCompiler::emitExitJump(const unsigned char &condition){
+	emit({ 0x0F, condition });
+	exitJumps.push_back(code.size());
+	emit32(0);
+}
+
+void JitCompiler::emitFlagsFromHost(){
+	emit({ 0x0F, 0xB6, 0xC4 }); // movzx eax, ah
+	emit({ 0x41, 0x8A, 0x44, 0x05, 0x00 }); // mov al, [r13 + rax]
+}
+
+void JitCompiler::emitStoreZeroFlag(const unsigned char &extraFlags, bool combine){
+	emit({ 0x84, 0xC0 }); // test al, al
+	emit({ 0x0F, 0x94, 0xC0 }); // sete al
+	emit({ 0xC0, 0xE0, 0x07 }); // shl al, 7
+	if(extraFlags)
+		emit({ 0x0C, extraFlags }); // or al, imm8
+	if(combine)
+		emit({ 0x08, 0xC8 }); // or al, cl
+	emitMem(0x88, HOST_AL, layout.offsetF); // mov [F], al
+}
+
+void JitCompiler::emitLoadCarry(){
+	emitMem(0x8A, HOST_CL, layout.offsetF); // mov cl, [F]
+	emit({ 0x0F, 0xBA, 0xE1, 0x04 }); // bt ecx, 4
+}
+
+void JitCompiler::emitInstruction(const TranslatedInstruction &instr){
+	if(instr.cbPrefix){
+		emitInstructionCB(instr);
+		return;
+	}
+	const unsigned char index = instr.nIndex;
+	const int *reg = layout.regOffset;
+	const int offF = layout.offsetF;
+	const int offA = reg[REG_A];
+
+	if(index >= 0x40 && index < 0x80){ // LD r,r
+		emitMem(0x8A, HOST_AL, reg[index & 0x7]); // mov al, [src]
+		emitMem(0x88, HOST_AL, reg[(index >> 3) & 0x7]); // mov [dest], al
+		return;
+	}
+	if((index >= 0x80 && index < 0xC0) || (index & 0xC7) == 0xC6){ // ALU A,r or ALU A,d8
+		const unsigned char memOps[8] = { 0x02, 0x12, 0x2A, 0x1A, 0x22, 0x32, 0x0A, 0x3A }; // op al, [rbx + disp32]
+		const unsigned char immOps[8] = { 0x04, 0x14, 0x2C, 0x1C, 0x24, 0x34, 0x0C, 0x3C }; // op al, imm8
+		const unsigned char aluOp = (index >> 3) & 0x7; // ADD ADC SUB SBC AND XOR OR CP
+		if(aluOp == 1 || aluOp == 3) // ADC and SBC
+			emitLoadCarry();
+		emitMem(0x8A, HOST_AL, offA); // mov al, [A]
+		if(index < 0xC0)
+			emitMem(memOps[aluOp], HOST_AL, reg[index & 0x7]);
+		else
+			emit({ immOps[aluOp], instr.d8 });
+		if(aluOp >= 4 && aluOp <= 6){ // AND, XOR, OR
+			emitMem(0x88, HOST_AL, offA); // mov [A], al
+			emitStoreZeroFlag(aluOp == 4 ? 0x20 : 0, false);
+			return;
+		}
+		emit({ 0x9F }); // lahf
+		if(aluOp != 7) // CP only sets the flags
+			emitMem(0x88, HOST_AL, offA); // mov [A], al
+		emitFlagsFromHost();
+		if(aluOp >= 2) // Subtraction
+			emit({ 0x0C, 0x40 }); // or al, 0x40
+		emitMem(0x88, HOST_AL, offF); // mov [F], al
+		return;
+	}
+	switch(index & 0xC7){
+		case 0x04: // INC r
+		case 0x05: // DEC r
+			emitMem(0x8A, HOST_AL, reg[(index >> 3) & 0x7]); // mov al, [r]
+			emit({ 0xFE, (unsigned char)((index & 0x1) ? 0xC8 : 0xC0) }); // dec al / inc al
+			emit({ 0x9F }); // lahf
+			emitMem(0x88, HOST_AL, reg[(index >> 3) & 0x7]); // mov [r], al
+			emitFlagsFromHost();
+			emit({ 0x24, 0xA0 }); // and al, 0xA0 (Z and H)
+			emitMem(0x8A, HOST_CL, offF); // mov cl, [F]
+			emit({ 0x80, 0xE1, 0x10 }); // and cl, 0x10 (carry is not modified)
+			emit({ 0x08, 0xC8 }); // or al, cl
+			if(index & 0x1)
+				emit({ 0x0C, 0x40 }); // or al, 0x40
+			emitMem(0x88, HOST_AL, offF); // mov [F], al
+			return;
+		case 0x06: // LD r,d8
+			emitMem(0xC6, 0, reg[(index >> 3) & 0x7]);
+			emit({ instr.d8 });
+			return;
+		default:
+			break;
+	}
+	if((index & 0xCF) == 0x01 || (index & 0xCF) == 0x03 || (index & 0xCF) == 0x09 || (index & 0xCF) == 0x0B){ // 16-bit register pairs
+		const unsigned char pair = (index >> 4) & 0x3; // BC DE HL SP
+		const int offHigh = (pair < 3 ? reg[2 * pair] : layout.offsetSP + 1);
+		const int offLow = (pair < 3 ? reg[2 * pair + 1] : layout.offsetSP);
+		switch(index & 0xF){
+			case 0x1: // LD rr,d16
+				emitMem(0xC6, 0, offHigh);
+				emit({ instr.d16h });
+				emitMem(0xC6, 0, offLow);
+				emit({ instr.d16l });
+				break;
+			case 0x3: // INC rr
+				emitMem(0x80, 0, offLow); // add byte [low], 1
+				emit({ 0x01 });
+				emitMem(0x80, 2, offHigh); // adc byte [high], 0
+				emit({ 0x00 });
+				break;
+			case 0xB: // DEC rr
+				emitMem(0x80, 5, offLow); // sub byte [low], 1
+				emit({ 0x01 });
+				emitMem(0x80, 3, offHigh); // sbb byte [high], 0
+				emit({ 0x00 });
+				break;
+			default: // ADD HL,rr (Z is not modified, H is the carry from bit 11)
+				emitMem(0x8A, HOST_AL, reg[REG_L]); // mov al, [L]
+				emitMem(0x02, HOST_AL, offLow); // add al, [low]
+				emitMem(0x88, HOST_AL, reg[REG_L]); // mov [L], al
+				emitMem(0x8A, HOST_AL, reg[REG_H]); // mov al, [H]
+				emitMem(0x12, HOST_AL, offHigh); // adc al, [high]
+				emit({ 0x9F }); // lahf
+				emitMem(0x88, HOST_AL, reg[REG_H]); // mov [H], al
+				emitFlagsFromHost();
+				emit({ 0x24, 0x30 }); // and al, 0x30 (H and C)
+				emitMem(0x8A, HOST_CL, offF); // mov cl, [F]
+				emit({ 0x80, 0xE1, 0x80 }); // and cl, 0x80
+				emit({ 0x08, 0xC8 }); // or al, cl
+				emitMem(0x88, HOST_AL, offF); // mov [F], al
+				break;
+		}
+		return;
+	}
+	switch(index){
+		case 0x07: // RLCA
+		case 0x0F: // RRCA
+		case 0x17: // RLA
+		case 0x1F: // RRA
+			if(index >= 0x17)
+				emitLoadCarry();
+			emitMem(0x8A, HOST_AL, offA); // mov al, [A]
+			emit({ 0xD0, (unsigned char)(0xC0 | ((index >> 3) << 3)) }); // rol / ror / rcl / rcr al, 1
+			emit({ 0x0F, 0x92, 0xC1 }); // setc cl
+			emitMem(0x88, HOST_AL, offA); // mov [A], al
+			emit({ 0xC0, 0xE1, 0x04 }); // shl cl, 4
+			emitMem(0x88, HOST_CL, offF); // mov [F], cl (Z is always cleared)
+			break;
+		case 0x2F: // CPL
+			emitMem(0xF6, 2, offA); // not byte [A]
+			emitMem(0x80, 1, offF); // or byte [F], 0x60
+			emit({ 0x60 });
+			break;
+		case 0x37: // SCF
+			emitMem(0x80, 4, offF); // and byte [F], 0x80
+			emit({ 0x80 });
+			emitMem(0x80, 1, offF); // or byte [F], 0x10
+			emit({ 0x10 });
+			break;
+		case 0x3F: // CCF
+			emitMem(0x80, 4, offF); // and byte [F], 0x90
+			emit({ 0x90 });
+			emitMem(0x80, 6, offF); // xor byte [F], 0x10
+			emit({ 0x10 });
+			break;
+		case 0xF9: // LD SP,HL
+			emitMem(0x8A, HOST_AL, reg[REG_L]); // mov al, [L]
+			emitMem(0x8A, HOST_AH, reg[REG_H]); // mov ah, [H]
+			emit({ 0x66 });
+			emitMem(0x89, HOST_AL, layout.offsetSP); // mov [SP], ax
+			break;
+		default: // NOP
+			break;
+	}
+}
+
+void JitCompiler::emitInstructionCB(const TranslatedInstruction &instr){
+	const unsigned char index = instr.nIndex;
+	const int offReg = layout.regOffset[index & 0x7];
+	const unsigned char bit = (index >> 3) & 0x7;
+	if(index < 0x40){ // Rotates and shifts
+		if(bit == 6){ // SWAP
+			emitMem(0x8A, HOST_AL, offReg); // mov al, [r]
+			emit({ 0xC0, 0xC0, 0x04 }); // rol al, 4
+			emitMem(0x88, HOST_AL, offReg); // mov [r], al
+			emitStoreZeroFlag(0, false);
+			return;
+		}
+		const unsigned char shiftOps[8] = { 0, 1, 2, 3, 4, 7, 0, 5 }; // RLC RRC RL RR SLA SRA - SRL (rol ror rcl rcr shl sar - shr)
+		if(bit == 2 || bit == 3) // RL and RR rotate through the carry
+			emitLoadCarry();
+		emitMem(0x8A, HOST_AL, offReg); // mov al, [r]
+		emit({ 0xD0, (unsigned char)(0xC0 | (shiftOps[bit] << 3)) }); // shift al, 1
+		emit({ 0x0F, 0x92, 0xC1 }); // setc cl
+		emitMem(0x88, HOST_AL, offReg); // mov [r], al
+		emit({ 0xC0, 0xE1, 0x04 }); // shl cl, 4
+		emitStoreZeroFlag(0, true);
+	}
+	else if(index < 0x80){ // BIT (N is cleared, H is set, and C is not modified)
+		emitMem(0x8A, HOST_CL, layout.offsetF); // mov cl, [F]
+		emit({ 0x80, 0xE1, 0x10 }); // and cl, 0x10
+		emitMem(0x8A, HOST_AL, offReg); // mov al, [r]
+		emit({ 0x24, (unsigned char)(1 << bit) }); // and al, mask
+		emitStoreZeroFlag(0x20, true);
+	}
+	else if(index < 0xC0){ // RES
+		emitMem(0x80, 4, offReg); // and byte [r], ~mask
+		emit({ (unsigned char)~(1 << bit) });
+	}
+	else{ // SET
+		emitMem(0x80, 1, offReg); // or byte [r], mask
+		emit({ (unsigned char)(1 << bit) });
+	}
+}
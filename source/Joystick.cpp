@@ -98,6 +98,7 @@ bool JoystickController::writeRegister(const unsigned short &reg, const unsigned
 		(*rJOYP) |= (val & 0x30); // Only bits 4,5 are writable 
 		selectButtonKeys    = !rJOYP->getBit(5); // P15 [0: Select, 1: No action]
 		selectDirectionKeys = !rJOYP->getBit(4); // P14 [0: Select, 1: No action]
+		onClockUpdate(); // Update the selected input lines
 		return true;
 	}
 	return false;
@@ -162,4 +163,5 @@ bool JoystickController::onClockUpdate(){
 
 void JoystickController::defineRegisters(){
 	sys->addSystemRegister(this, 0x00, rJOYP, "JOYP", "33333333");
+	sys->setRegisterWriteHandler(0x00, writeComponentRegister<JoystickController>);
 }
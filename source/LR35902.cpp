@@ -1,10 +1,14 @@
 #include <iostream>
 #include <stdlib.h>
+#include <algorithm>
 
 #include "Support.hpp"
 #include "LR35902.hpp"
 #include "SystemGBC.hpp"
 #include "SystemRegisters.hpp"
+#include "OpcodeTable.hpp"
+#include "Cartridge.hpp"
+#include "WorkRam.hpp"
 
 const unsigned char FLAG_Z_BIT = 7;
 const unsigned char FLAG_S_BIT = 6;
@@ -16,6 +20,16 @@ const unsigned char FLAG_S_MASK = 0x40;
 const unsigned char FLAG_H_MASK = 0x20;
 const unsigned char FLAG_C_MASK = 0x10;
 
+#if defined(USE_COMPUTED_GOTO_DISPATCH) && !defined(__GNUC__)
+	// Computed goto is a GCC / Clang extension, fall back to switch dispatch
+	#undef USE_COMPUTED_GOTO_DISPATCH
+	#define USE_SWITCH_DISPATCH
+#endif
+
+constexpr unsigned int HOT_BLOCK_THRESHOLD = 16; ///< Number of times a block must be interpreted before it is translated
+constexpr unsigned int MAX_BLOCK_INSTRUCTIONS = 64; ///< Maximum number of instructions in a translated block
+constexpr unsigned short MAX_IDLE_LOOP_BYTES = 16; ///< Maximum length of an idle loop (in bytes)
+
 const unsigned char IMMEDIATE_LEFT_BIT  = 0;
 const unsigned char IMMEDIATE_RIGHT_BIT = 1;
 const unsigned char ADDRESS_LEFT_BIT    = 2;
@@ -24,32 +38,70 @@ const unsigned char ADDRESS_RIGHT_BIT   = 3;
 /** Read the next instruction from memory and return the number of clock cycles. 
   */
 unsigned short LR35902::evaluate(){
-	// Read an opcode
-	unsigned char op;
-	if(!sys->read(PC++, &op))
-		std::cout << " Opcode read failed! PC=" << getHex((unsigned short)(PC-1)) << std::endl;
-	
-	if(op != 0xCB) // Normal opcodes
-		lastOpcode.set(opcodes.getOpcodes(), op, PC-1);
-	else{ // CB prefix opcodes
-		sys->read(PC++, &op);
-		lastOpcode.set(opcodes.getOpcodesCB(), op, PC-2);
+	// Check for a previously decoded instruction
+	DecodedInstruction *cached = 0x0;
+	unsigned short romBank = 0;
+	unsigned short wramBank = 0;
+	if(!sys->bootSequenceActive() && !debugMode){
+		romBank = sys->getCartridge()->getBankSelect();
+		wramBank = sys->getWRAM()->getBankSelect();
+		cached = cache.get(PC, romBank, wramBank);
 	}
+	if(cached && cached->valid()){
+		if(!cached->cbPrefix)
+			lastOpcode.set(opcodes.getOpcodes(), cached->nIndex, PC);
+		else
+			lastOpcode.setCB(opcodes.getOpcodesCB(), cached->nIndex, PC);
+		d8 = cached->d8;
+		d16h = cached->d16h;
+		d16l = cached->d16l;
+		PC += lastOpcode()->nBytes + (cached->cbPrefix ? 1 : 0);
+		if(lastOpcode()->nBytes == 2)
+			lastOpcode.setImmediateData(d8);
+		else if(lastOpcode()->nBytes == 3)
+			lastOpcode.setImmediateData(getUShort(d16h, d16l));
+	}
+	else{
+		// Read an opcode
+		unsigned short pc = PC;
+		unsigned char op;
+		if(!sys->read(PC++, &op))
+			std::cout << " Opcode read failed! PC=" << getHex((unsigned short)(PC-1)) << std::endl;
+		
+		if(op != 0xCB) // Normal opcodes
+			lastOpcode.set(opcodes.getOpcodes(), op, PC-1);
+		else{ // CB prefix opcodes
+			sys->read(PC++, &op);
+			lastOpcode.setCB(opcodes.getOpcodesCB(), op, PC-2);
+		}
 
-	d8 = 0x0;
-	d16h = 0x0;
-	d16l = 0x0;
+		d8 = 0x0;
+		d16h = 0x0;
+		d16l = 0x0;
 
-	// Read the opcode's accompanying value (if any)
-	if(lastOpcode()->nBytes == 2){ // Read 8 bits (valid targets: d8, d8, d8)
-		sys->read(PC++, d8);
-		lastOpcode.setImmediateData(d8);
-	}
-	else if(lastOpcode()->nBytes == 3){ // Read 16 bits (valid targets: d16, d16)
-		// Low byte read first!
-		sys->read(PC++, d16l);
-		sys->read(PC++, d16h);
-		lastOpcode.setImmediateData(getUShort(d16h, d16l));
+		// Read the opcode's accompanying value (if any)
+		if(lastOpcode()->nBytes == 2){ // Read 8 bits (valid targets: d8, d8, d8)
+			sys->read(PC++, d8);
+			lastOpcode.setImmediateData(d8);
+		}
+		else if(lastOpcode()->nBytes == 3){ // Read 16 bits (valid targets: d16, d16)
+			// Low byte read first!
+			sys->read(PC++, d16l);
+			sys->read(PC++, d16h);
+			lastOpcode.setImmediateData(getUShort(d16h, d16l));
+		}
+
+		// Store the decoded instruction for the next time it is executed
+		if(cached){
+			DecodedInstruction decoded;
+			decoded.op = lastOpcode();
+			decoded.nIndex = lastOpcode.nIndex;
+			decoded.d8 = d8;
+			decoded.d16h = d16h;
+			decoded.d16l = d16l;
+			decoded.cbPrefix = lastOpcode.cbPrefix;
+			cache.store(pc, PC - pc, romBank, wramBank, decoded);
+		}
 	}
 	
 	// Set the memory read/write address (if any)
@@ -64,24 +116,353 @@ unsigned short LR35902::evaluate(){
   */
 bool LR35902::onClockUpdate(){
 	if(!lastOpcode.executing()){ // Previous instruction finished executing, read the next one.
-		// Check for pending interrupts.
-		if(!rIME->zero() && ((*rIE) & (*rIF))){
-			if(rIF->getBit(0)) // VBlank
-				acknowledgeVBlankInterrupt();
-			if(rIF->getBit(1)) // LCDC STAT
-				acknowledgeLcdInterrupt();
-			if(rIF->getBit(2)) // Timer
-				acknowledgeTimerInterrupt();
-			if(rIF->getBit(3)) // Serial
-				acknowledgeSerialInterrupt();
-			if(rIF->getBit(4)) // Joypad
-				acknowledgeJoypadInterrupt();
-		}
+		checkInterrupts();
 		evaluate();
 	}
 	return lastOpcode.clock(this); // Execute the instruction on the last cycle
 }
 
+/** Return true if accessing the specified memory address depends on the state of other system components
+  * (i.e. VRAM, OAM, and I/O registers), and return false otherwise.
+  */
+bool isTimingSensitive(const unsigned short &addr){
+	return ((addr >= 0x8000 && addr < 0xA000) || (addr >= 0xFE00 && addr < 0xFF80));
+}
+
+unsigned int LR35902::run(const unsigned int &nCycles){
+	Scheduler *scheduler = sys->getScheduler();
+	unsigned int nCyclesRun = 0;
+	bool stopRunning = false;
+	while(nCyclesRun < nCycles && !stopRunning){
+		if(sys->cpuIsHalted() || sys->cpuIsStopped() || sys->getEmulationPaused())
+			break;
+		if(lastOpcode.executing()){ // Finish the current instruction one cycle at a time
+			stopRunning = scheduler->tick();
+			lastOpcode.clock(this);
+			nCyclesRun++;
+			continue;
+		}
+
+		// Execute a translated block of instructions (if available).
+		// Interrupts are only checked between blocks, so blocks are not entered if an interrupt is pending or 
+		// if a system event will occur on the next instruction fetch.
+		if(useBlockEngine && blockStart && scheduler->getCyclesUntilNextEvent() > 1 && (rIME->zero() || ((*rIE) & (*rIF)) == 0)){
+			TranslatedBlock *block = 0x0;
+			if(!sys->bootSequenceActive() && !debugMode)
+				block = blocks.get(PC, sys->getCartridge()->getBankSelect());
+			if(block && (block->translated() || (++block->nExecutions >= HOT_BLOCK_THRESHOLD && translateBlock(block, PC)))){
+				if(useJitEngine && !block->compiled){ // Compile the block the first time it is run
+					block->nativeCode = jit.compile(block);
+					block->compiled = true;
+				}
+				nCyclesRun += runBlock(block, scheduler, stopRunning);
+				continue;
+			}
+		}
+		
+		// Instruction fetch (first machine cycle)
+		stopRunning = scheduler->tick();
+		checkInterrupts();
+		evaluate();
+		
+		// Execute the instruction
+		nCyclesRun += completeInstruction(scheduler, 1, stopRunning);
+		blockStart = (!lastOpcode.cbPrefix && blockTerminator[lastOpcode.nIndex]);
+	}
+
+	// Fast-forward to the next scheduled event while spinning in an idle loop, but never past the requested 
+	// number of cycles, so that the main loop still services the frame timer and window events on time
+	if(idleLoopDetected){
+		idleLoopDetected = false;
+		unsigned int nRemaining = (nCyclesRun < nCycles ? nCycles - nCyclesRun : 0);
+		unsigned long long nSkip = scheduler->getCyclesUntilNextEvent();
+		if(nSkip > nRemaining)
+			nSkip = nRemaining;
+		if(nSkip > 0 && ((*rIE) & (*rIF)) == 0){ // No pending interrupts
+			scheduler->advance((unsigned int)nSkip);
+			nCyclesRun += (unsigned int)nSkip;
+			nIdleCycles += nSkip;
+		}
+	}
+	return nCyclesRun;
+}
+
+bool LR35902::checkIdleLoop(){
+	unsigned long long state = ((unsigned long long)getUShort(A, getF()) << 48) + ((unsigned long long)getBC() << 32) + ((unsigned long long)getDE() << 16) + getHL();
+	bool idle = (idleLoopValid && !idleLoopTainted && PC == idleLoopStart && SP == idleLoopSP && state == idleLoopState);
+	idleLoopValid = true;
+	idleLoopTainted = false;
+	idleLoopStart = PC;
+	idleLoopSP = SP;
+	idleLoopState = state;
+	return idle;
+}
+
+unsigned short LR35902::completeInstruction(Scheduler *scheduler, const unsigned short &nCyclesElapsed, bool &stopRunning){
+	// Only synchronize the system clock if the instruction accesses timing sensitive memory.
+	unsigned short nCyclesSynced = nCyclesElapsed;
+	bool syncMemory = (lastOpcode()->addrptr && isTimingSensitive(memoryAddress));
+	if(lastOpcode.nReadCycle){ // Read from memory
+		if(syncMemory && lastOpcode.nReadCycle > nCyclesSynced){
+			stopRunning |= scheduler->advance(lastOpcode.nReadCycle - nCyclesSynced);
+			nCyclesSynced = lastOpcode.nReadCycle;
+		}
+		readMemory();
+	}
+	if(syncMemory && lastOpcode.nWriteCycle > nCyclesSynced){ // Memory written on the same cycle as execution
+		stopRunning |= scheduler->advance(lastOpcode.nWriteCycle - nCyclesSynced);
+		nCyclesSynced = lastOpcode.nWriteCycle;
+	}
+	executeInstruction(lastOpcode); // Execute the instruction
+	if(lastOpcode.nWriteCycle){ // Write to memory
+		writeMemory();
+		if(syncMemory && memoryAddress >= 0xFE00) // I/O register write, system state may have changed
+			stopRunning = true;
+	}
+
+	// Advance the system clock to the end of the instruction (including extra cycles from conditional branches).
+	lastOpcode.nCycles = lastOpcode.nExecuteCycle + lastOpcode.nExtraCycles;
+	if(lastOpcode.nCycles > nCyclesSynced)
+		stopRunning |= scheduler->advance(lastOpcode.nCycles - nCyclesSynced);
+
+	// Idle loops may not modify memory or read DIV and TIMA (which change without a scheduled event)
+	if(lastOpcode.nWriteCycle || (!lastOpcode.cbPrefix && idleLoopUnsafe[lastOpcode.nIndex]) || 
+	  (lastOpcode()->addrptr && (memoryAddress == 0xFF04 || memoryAddress == 0xFF05)))
+		idleLoopTainted = true;
+	else if(!lastOpcode.cbPrefix && blockTerminator[lastOpcode.nIndex] && PC <= lastOpcode.nPC && lastOpcode.nPC - PC <= MAX_IDLE_LOOP_BYTES){ // Short backwards jump
+		if(checkIdleLoop()){
+			idleLoopDetected = true;
+			stopRunning = true;
+		}
+	}
+	return lastOpcode.nCycles;
+}
+
+bool LR35902::translateBlock(TranslatedBlock *block, const unsigned short &pc){
+	block->instructions.clear();
+	unsigned short addr = pc;
+	while(block->instructions.size() < MAX_BLOCK_INSTRUCTIONS){
+		TranslatedInstruction instr;
+		Opcode *op;
+		instr.nPC = addr;
+		sys->read(addr, instr.nIndex);
+		if(instr.nIndex != 0xCB){ // Normal opcodes
+			op = &opcodes.getOpcodes()[instr.nIndex];
+			instr.nBytes = op->nBytes;
+		}
+		else{ // CB prefix opcodes
+			sys->read(addr + 1, instr.nIndex);
+			op = &opcodes.getOpcodesCB()[instr.nIndex];
+			instr.nBytes = op->nBytes + 1;
+			instr.cbPrefix = true;
+		}
+		if(((addr + instr.nBytes - 1) & 0xF000) != (pc & 0xF000)) // Instruction is not entirely on the first memory page of the block
+			break;
+		if(op->nBytes == 2){ // Read 8 bits
+			sys->read(addr + 1, instr.d8);
+		}
+		else if(op->nBytes == 3){ // Read 16 bits (low byte first)
+			sys->read(addr + 1, instr.d16l);
+			sys->read(addr + 2, instr.d16h);
+		}
+		block->instructions.push_back(instr);
+		if(!instr.cbPrefix && blockTerminator[instr.nIndex]) // Control flow instruction
+			break;
+		addr += instr.nBytes;
+	}
+	return block->translated();
+}
+
+unsigned int LR35902::runBlock(const TranslatedBlock *block, Scheduler *scheduler, bool &stopRunning){
+	blockStart = true;
+	if(block->nativeCode){ // Compiled block
+		JitState state(this, block, scheduler, &stopRunning);
+		block->nativeCode(this, &state);
+		return state.nCyclesRun;
+	}
+	unsigned int nCyclesRun = 0;
+	for(unsigned int i = 0; i < block->instructions.size(); i++){
+		if(stepBlock(block, i, scheduler, stopRunning, nCyclesRun))
+			break;
+	}
+	return nCyclesRun;
+}
+
+void LR35902::setBlockInstruction(const TranslatedInstruction &instr){
+	if(!instr.cbPrefix) // Normal opcodes
+		lastOpcode.set(opcodes.getOpcodes(), instr.nIndex, instr.nPC);
+	else // CB prefix opcodes
+		lastOpcode.setCB(opcodes.getOpcodesCB(), instr.nIndex, instr.nPC);
+	d8 = instr.d8;
+	d16h = instr.d16h;
+	d16l = instr.d16l;
+	if(lastOpcode()->nBytes == 2)
+		lastOpcode.setImmediateData(d8);
+	else if(lastOpcode()->nBytes == 3)
+		lastOpcode.setImmediateData(getUShort(d16h, d16l));
+	PC = instr.nPC + instr.nBytes;
+}
+
+bool LR35902::stepBlock(const TranslatedBlock *block, const unsigned int &index, Scheduler *scheduler, bool &stopRunning, unsigned int &nCyclesRun){
+	if(stopRunning || (index != 0 && scheduler->getCyclesUntilNextEvent() <= 1)) // Return to the interpreter to check for interrupts
+		return true;
+	setBlockInstruction(block->instructions[index]);
+	if(lastOpcode()->addrptr) // Set memory address
+		memoryAddress = (this->*lastOpcode()->addrptr)();
+
+	// Execute the instruction. The instruction fetch cycle has not been clocked yet.
+	nCyclesRun += completeInstruction(scheduler, 0, stopRunning);
+
+	// Writes to the cartridge MBC may change the ROM bank and writes to the interrupt enable register may
+	// trigger an interrupt, return to the interpreter.
+	return (lastOpcode.nWriteCycle && (memoryAddress < 0x8000 || memoryAddress == 0xFFFF));
+}
+
+bool LR35902::setJitEngine(bool state/*=true*/){
+	if(state && !JitCompiler::isSupported()){
+		useJitEngine = false;
+		return false;
+	}
+	useJitEngine = state;
+	if(state)
+		useBlockEngine = true;
+	return true;
+}
+
+void LR35902::updateJitLayout(){
+	JitLayout layout;
+	unsigned char *regs[8] = { &B, &C, &D, &E, &H, &L, 0x0, &A }; // LR35902 operand encoding, (HL) is not a register
+	for(unsigned short i = 0; i < 8; i++)
+		layout.regOffset[i] = (regs[i] ? (int)((char *)regs[i] - (char *)this) : 0);
+	layout.offsetF = (int)((char *)&F - (char *)this);
+	layout.offsetSP = (int)((char *)&SP - (char *)this);
+	layout.opcodes = opcodes.getOpcodes();
+	layout.opcodesCB = opcodes.getOpcodesCB();
+	layout.step = &LR35902::jitStep;
+	layout.enterSegment = &LR35902::jitEnterSegment;
+	layout.leaveSegment = &LR35902::jitLeaveSegment;
+	layout.trace = (traceFile.is_open() ? &LR35902::jitTrace : 0x0);
+	jit.setLayout(layout);
+}
+
+bool LR35902::jitStep(void *state, unsigned int index){
+	JitState *jitState = static_cast<JitState *>(state);
+	return jitState->cpu->stepBlock(jitState->block, index, jitState->scheduler, *jitState->stopRunning, jitState->nCyclesRun);
+}
+
+int LR35902::jitEnterSegment(void *state, unsigned int first, unsigned int count, unsigned int nCycles){
+	JitState *jitState = static_cast<JitState *>(state);
+	LR35902 *cpu = jitState->cpu;
+	unsigned int nCyclesUntilEvent = jitState->scheduler->getCyclesUntilNextEvent();
+	if(*jitState->stopRunning || (first != 0 && nCyclesUntilEvent <= 1))
+		return 2;
+	if(nCyclesUntilEvent > nCycles + 1){ // Run natively, native code operates on the flags register directly
+		cpu->evaluateFlags();
+		return 0;
+	}
+	for(unsigned int i = first; i < first + count; i++){ // An event occurs within the segment, step through it
+		if(cpu->stepBlock(jitState->block, i, jitState->scheduler, *jitState->stopRunning, jitState->nCyclesRun))
+			return 2;
+	}
+	return 1;
+}
+
+void LR35902::jitLeaveSegment(void *state, unsigned int first, unsigned int count, unsigned int nCycles){
+	JitState *jitState = static_cast<JitState *>(state);
+	LR35902 *cpu = jitState->cpu;
+	cpu->setBlockInstruction(jitState->block->instructions[first + count - 1]);
+	cpu->lastOpcode.nCycles = cpu->lastOpcode.nExecuteCycle; // Last instruction has completed
+	cpu->nInstructions += count;
+	*jitState->stopRunning |= jitState->scheduler->advance(nCycles);
+	jitState->nCyclesRun += nCycles;
+}
+
+void LR35902::jitTrace(void *state, unsigned int index){
+	JitState *jitState = static_cast<JitState *>(state);
+	jitState->cpu->setBlockInstruction(jitState->block->instructions[index]);
+	jitState->cpu->traceInstruction();
+}
+
+bool LR35902::openTraceFile(const std::string &fname){
+	traceFile.open(fname.c_str());
+	if(!traceFile.good()){
+		std::cout << " Warning! Failed to open instruction trace file \"" << fname << "\"" << std::endl;
+		return false;
+	}
+	updateJitLayout(); // Compiled blocks must also write to the trace
+	return true;
+}
+
+void LR35902::traceInstruction(){
+	traceFile << getHex(lastOpcode.nPC) << " " << lastOpcode.getShortInstruction();
+	traceFile << " AF=" << getHex(getAF()) << " BC=" << getHex(getBC()) << " DE=" << getHex(getDE());
+	traceFile << " HL=" << getHex(getHL()) << " SP=" << getHex(SP) << "\n";
+}
+
+void LR35902::executeInstruction(const OpcodeData &data){
+	nInstructions++;
+	if(traceFile.is_open())
+		traceInstruction();
+#if defined(USE_COMPUTED_GOTO_DISPATCH)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#define OPCODE_LABEL(index, handler) &&opcode_##index,
+#define OPCODE_LABEL_CB(index, handler) &&opcodeCB_##index,
+	static void* const jumpTable[256] = { LR35902_OPCODE_TABLE(OPCODE_LABEL) };
+	static void* const jumpTableCB[256] = { LR35902_OPCODE_TABLE_CB(OPCODE_LABEL_CB) };
+#undef OPCODE_LABEL
+#undef OPCODE_LABEL_CB
+	goto *(!data.cbPrefix ? jumpTable : jumpTableCB)[data.nIndex];
+#define OPCODE_CASE(index, handler) opcode_##index: handler(); return;
+#define OPCODE_CASE_CB(index, handler) opcodeCB_##index: handler(); return;
+	LR35902_OPCODE_TABLE(OPCODE_CASE)
+	LR35902_OPCODE_TABLE_CB(OPCODE_CASE_CB)
+#undef OPCODE_CASE
+#undef OPCODE_CASE_CB
+#pragma GCC diagnostic pop
+#elif defined(USE_SWITCH_DISPATCH)
+#define OPCODE_CASE(index, handler) case index: handler(); break;
+	if(!data.cbPrefix){ // Standard opcodes
+		switch(data.nIndex){
+			LR35902_OPCODE_TABLE(OPCODE_CASE)
+		}
+	}
+	else{ // CB prefix opcodes
+		switch(data.nIndex){
+			LR35902_OPCODE_TABLE_CB(OPCODE_CASE)
+		}
+	}
+#undef OPCODE_CASE
+#else
+	(this->*data.op->ptr)();
+#endif
+}
+
+std::string LR35902::getDispatchMethod(){
+#if defined(USE_COMPUTED_GOTO_DISPATCH)
+	return "goto";
+#elif defined(USE_SWITCH_DISPATCH)
+	return "switch";
+#else
+	return "table";
+#endif
+}
+
+void LR35902::checkInterrupts(){
+	if(!rIME->zero() && ((*rIE) & (*rIF))){
+		if(rIF->getBit(0)) // VBlank
+			acknowledgeVBlankInterrupt();
+		if(rIF->getBit(1)) // LCDC STAT
+			acknowledgeLcdInterrupt();
+		if(rIF->getBit(2)) // Timer
+			acknowledgeTimerInterrupt();
+		if(rIF->getBit(3)) // Serial
+			acknowledgeSerialInterrupt();
+		if(rIF->getBit(4)) // Joypad
+			acknowledgeJoypadInterrupt();
+	}
+}
+
 void LR35902::acknowledgeVBlankInterrupt(){
 	rIF->resetBit(0);
 	if(rIE->getBit(0)){ // Execute interrupt
@@ -122,21 +503,71 @@ void LR35902::acknowledgeJoypadInterrupt(){
 	}
 }
 
+unsigned char LR35902::computeFlags() const {
+	if(lastFlagOperation == flagOperation::NONE)
+		return F;
+	// Note: (arg1 ^ arg2) ^ result = carry (or borrow) bits
+	unsigned char flags = ((flagResult & 0xFF) == 0 ? FLAG_Z_MASK : 0);
+	if(((flagArg1 ^ flagArg2) ^ flagResult) & 0x10) // Carry from bit 3 (borrow from bit 4)
+		flags |= FLAG_H_MASK;
+	switch(lastFlagOperation){
+		case flagOperation::ADD:
+			if(flagResult & 0x100) // Carry from bit 7
+				flags |= FLAG_C_MASK;
+			break;
+		case flagOperation::SUB:
+			flags |= FLAG_S_MASK;
+			if(flagResult & 0x100) // Borrow from bit 8
+				flags |= FLAG_C_MASK;
+			break;
+		case flagOperation::INC:
+			if(flagCarry)
+				flags |= FLAG_C_MASK;
+			break;
+		case flagOperation::DEC:
+			flags |= FLAG_S_MASK;
+			if(flagCarry)
+				flags |= FLAG_C_MASK;
+			break;
+		default:
+			break;
+	}
+	return flags;
+}
+
+void LR35902::evaluateFlags(){
+	if(lastFlagOperation == flagOperation::NONE)
+		return;
+	F = computeFlags();
+	lastFlagOperation = flagOperation::NONE;
+}
+
+bool LR35902::getFlagC() const {
+	switch(lastFlagOperation){
+		case flagOperation::NONE:
+			return ((F & FLAG_C_MASK) != 0);
+		case flagOperation::INC:
+		case flagOperation::DEC:
+			return flagCarry;
+		default:
+			return ((flagResult & 0x100) != 0);
+	}
+}
+
 void LR35902::setFlag(const unsigned char &bit, bool state/*=true*/){
+	evaluateFlags();
 	if(state) set_d8(&F, bit);
 	else      res_d8(&F, bit);
 }
 
 void LR35902::setFlags(bool zflag, bool sflag, bool hflag, bool cflag){
-	setFlag(FLAG_Z_BIT, zflag);
-	setFlag(FLAG_S_BIT, sflag);
-	setFlag(FLAG_H_BIT, hflag);
-	setFlag(FLAG_C_BIT, cflag);
+	F = (zflag ? FLAG_Z_MASK : 0) | (sflag ? FLAG_S_MASK : 0) | (hflag ? FLAG_H_MASK : 0) | (cflag ? FLAG_C_MASK : 0);
+	lastFlagOperation = flagOperation::NONE;
 }
 
 unsigned short LR35902::getd16() const { return getUShort(d16h, d16l); }
 
-unsigned short LR35902::getAF() const { return getUShort(A, F); }
+unsigned short LR35902::getAF() const { return getUShort(A, getF()); }
 
 unsigned short LR35902::getBC() const { return getUShort(B, C); }
 
@@ -153,6 +584,7 @@ void LR35902::setAF(const unsigned short &val){
 	A = (0xFF00 & val) >> 8;
 	F = 0x00FF & val;
 	F &= 0xF0; // Bottom 4 bits of F are always zero
+	lastFlagOperation = flagOperation::NONE;
 }
 
 void LR35902::setBC(const unsigned short &val){
@@ -203,6 +635,7 @@ unsigned char* LR35902::getPointerToRegister8bit(const std::string& name) {
 		return &E;
 	}
 	else if (name == "f") {
+		evaluateFlags();
 		return &F;
 	}
 	else if (name == "h") {
@@ -336,9 +769,7 @@ void LR35902::set_d8(unsigned char *arg, const unsigned char &bit){
 
 void LR35902::bit_d8(const unsigned char &arg, const unsigned char &bit){
 	// Copy a bit of (arg) to the zero bit.
-	setFlag(FLAG_Z_BIT, (arg & (0x1 << bit)) == 0);
-	setFlag(FLAG_S_BIT, 0);
-	setFlag(FLAG_H_BIT, 1);
+	setFlags((arg & (0x1 << bit)) == 0, 0, 1, getFlagC());
 }
 
 void LR35902::inc_d16(unsigned char *addrH, unsigned char *addrL){
@@ -352,17 +783,17 @@ void LR35902::dec_d16(unsigned char *addrH, unsigned char *addrL){
 }
 
 void LR35902::inc_d8(unsigned char *arg){
-	(*arg) = getCarriesAdd(*arg, 1);
-	setFlag(FLAG_Z_BIT, (*arg == 0));
-	setFlag(FLAG_S_BIT, 0);
-	setFlag(FLAG_H_BIT, halfCarry);
+	bool carry = getFlagC(); // INC does not modify the carry flag
+	(*arg) = addLazy(*arg, 1);
+	lastFlagOperation = flagOperation::INC;
+	flagCarry = carry;
 }
 
 void LR35902::dec_d8(unsigned char *arg){
-	(*arg) = getCarriesSub(*arg, 1);
-	setFlag(FLAG_Z_BIT, (*arg == 0));
-	setFlag(FLAG_S_BIT, 1);
-	setFlag(FLAG_H_BIT, halfCarry);
+	bool carry = getFlagC(); // DEC does not modify the carry flag
+	(*arg) = subLazy(*arg, 1);
+	lastFlagOperation = flagOperation::DEC;
+	flagCarry = carry;
 }
 
 void LR35902::jr_n(const unsigned char &n){
@@ -392,73 +823,42 @@ void LR35902::add_HL_d16(const unsigned char &addrH, const unsigned char &addrL)
 	halfCarry = (((HL ^ dd) ^ result) & 0x1000) == 0x1000; // Carry from bit 11
 	fullCarry = (((HL ^ dd) ^ result) & 0x10000) == 0x10000; // Carry from bit 15	
 	setHL(result & 0xFFFF);
-	setFlag(FLAG_S_BIT, 0);
-	setFlag(FLAG_H_BIT, halfCarry);
-	setFlag(FLAG_C_BIT, fullCarry);
+	setFlags(getFlagZ(), 0, halfCarry, fullCarry); // Z is not affected
 }
 
 void LR35902::add_A_d8(const unsigned char &arg){
-	A = getCarriesAdd(A, arg);
-	setFlag(FLAG_Z_BIT, (A == 0));
-	setFlag(FLAG_S_BIT, 0);
-	setFlag(FLAG_H_BIT, halfCarry);
-	setFlag(FLAG_C_BIT, fullCarry);
+	A = addLazy(A, arg);
 }
 
 void LR35902::adc_A_d8(const unsigned char &arg){
-	A = getCarriesAdd(A, arg, true); // Add WITH carry
-	setFlag(FLAG_Z_BIT, (A == 0));
-	setFlag(FLAG_S_BIT, 0);
-	setFlag(FLAG_H_BIT, halfCarry);
-	setFlag(FLAG_C_BIT, fullCarry);
+	A = addLazy(A, arg, getFlagC()); // Add WITH carry
 }
 
 void LR35902::sub_A_d8(const unsigned char &arg){
-	A = getCarriesSub(A, arg);
-	setFlag(FLAG_Z_BIT, (A == 0));
-	setFlag(FLAG_S_BIT, 1);
-	setFlag(FLAG_H_BIT, halfCarry);
-	setFlag(FLAG_C_BIT, fullCarry);
+	A = subLazy(A, arg);
 }
 
 void LR35902::sbc_A_d8(const unsigned char &arg){
-	A = getCarriesSub(A, arg, true); // Subtract WITH carry
-	setFlag(FLAG_Z_BIT, (A == 0));
-	setFlag(FLAG_S_BIT, 1);
-	setFlag(FLAG_H_BIT, halfCarry);
-	setFlag(FLAG_C_BIT, fullCarry);
+	A = subLazy(A, arg, getFlagC()); // Subtract WITH carry
 }
 
 void LR35902::and_d8(const unsigned char &arg){
 	A &= arg;
-	setFlag(FLAG_Z_BIT, (A == 0));
-	setFlag(FLAG_S_BIT, 0);
-	setFlag(FLAG_H_BIT, 1);
-	setFlag(FLAG_C_BIT, 0);		
+	setFlags((A == 0), 0, 1, 0);
 }
 
 void LR35902::xor_d8(const unsigned char &arg){
 	A ^= arg;
-	setFlag(FLAG_Z_BIT, (A == 0));
-	setFlag(FLAG_S_BIT, 0);
-	setFlag(FLAG_H_BIT, 0);
-	setFlag(FLAG_C_BIT, 0);	
+	setFlags((A == 0), 0, 0, 0);
 }
 
 void LR35902::or_d8(const unsigned char &arg){
 	A |= arg;
-	setFlag(FLAG_Z_BIT, (A == 0));
-	setFlag(FLAG_S_BIT, 0);
-	setFlag(FLAG_H_BIT, 0);
-	setFlag(FLAG_C_BIT, 0);
+	setFlags((A == 0), 0, 0, 0);
 }
 
 void LR35902::cp_d8(const unsigned char &arg){
-	getCarriesSub(A, arg);
-	setFlag(FLAG_Z_BIT, (A == arg)); // A == arg
-	setFlag(FLAG_S_BIT, 1);
-	setFlag(FLAG_H_BIT, halfCarry);
-	setFlag(FLAG_C_BIT, fullCarry); // A < arg
+	subLazy(A, arg); // Z set if A == arg, C set if A < arg
 }
 
 void LR35902::push_d16(const unsigned char &addrH, const unsigned char &addrL){
@@ -522,20 +922,22 @@ void LR35902::ret_cc(){
 	ret();
 }
 
-unsigned char LR35902::getCarriesAdd(const unsigned char &arg1, const unsigned char &arg2, bool adc/*=false*/){ // ADD - ADC
-	// Note: (arg1 ^ arg2) ^ result = carry bits
-	unsigned short result = arg1 + (arg2 + (adc & getFlagC() ? 1: 0));
-	halfCarry = (((arg1 ^ arg2) ^ result) & 0x10) == 0x10; // Carry from bit 3
-	fullCarry = (((arg1 ^ arg2) ^ result) & 0x100) == 0x100; // Carry from bit 7
-	return (result & 0x00FF); // Return the lower 8 bits of the result.
+unsigned char LR35902::addLazy(const unsigned char &arg1, const unsigned char &arg2, bool carry/*=false*/){ // ADD - ADC
+	// Flags are computed from the operands and result only when they are read
+	flagArg1 = arg1;
+	flagArg2 = arg2;
+	flagResult = arg1 + (arg2 + (carry ? 1 : 0));
+	lastFlagOperation = flagOperation::ADD;
+	return (flagResult & 0x00FF); // Return the lower 8 bits of the result.
 }
 
-unsigned char LR35902::getCarriesSub(const unsigned char &arg1, const unsigned char &arg2, bool sbc/*=false*/){ // SUB - SBC
-	// Note: (arg1 ^ arg2) ^ result = borrow bits
-	unsigned short result = arg1 - (arg2 + (sbc & getFlagC() ? 1 : 0));
-	halfCarry = (((arg1 ^ arg2) ^ result) & 0x10) == 0x10; // Borrow from bit 4
-	fullCarry = (((arg1 ^ arg2) ^ result) & 0x100) == 0x100; // Borrow from bit 8
-	return (result & 0x00FF); // Return the lower 8 bits of the result.
+unsigned char LR35902::subLazy(const unsigned char &arg1, const unsigned char &arg2, bool carry/*=false*/){ // SUB - SBC - CP
+	// Flags are computed from the operands and result only when they are read
+	flagArg1 = arg1;
+	flagArg2 = arg2;
+	flagResult = arg1 - (arg2 + (carry ? 1 : 0));
+	lastFlagOperation = flagOperation::SUB;
+	return (flagResult & 0x00FF); // Return the lower 8 bits of the result.
 }
 
 void LR35902::sla_d8(unsigned char *arg){
@@ -704,9 +1106,7 @@ void LR35902::ADD_HL_SP(){
 	halfCarry = (((HL ^ SP) ^ result) & 0x1000) == 0x1000; // Carry from bit 11
 	fullCarry = (((HL ^ SP) ^ result) & 0x10000) == 0x10000; // Carry from bit 15	
 	setHL(result & 0xFFFF);
-	setFlag(FLAG_S_BIT, 0);
-	setFlag(FLAG_H_BIT, halfCarry);
-	setFlag(FLAG_C_BIT, fullCarry);
+	setFlags(getFlagZ(), 0, halfCarry, fullCarry); // Z is not affected
 }
 
 // LD HL-,A or LDD HL,A
@@ -770,6 +1170,7 @@ void LR35902::LD_DE_d16(){
 void LR35902::POP_AF(){ 
 	pop_d16(&A, &F);
 	F &= 0xF0; // Bottom 4 bits of F are always zero
+	lastFlagOperation = flagOperation::NONE;
 }
 
 // RET NZ[Z|NC|C]
@@ -845,523 +1246,36 @@ void LR35902::initialize(){
 	rset16["d16"] = &LR35902::setd16;
 
 	// Standard opcodes
-	opcodes.setOpcodePointer(0, &LR35902::NOP);
-	opcodes.setOpcodePointer(1, &LR35902::LD_BC_d16);
-	opcodes.setOpcodePointer(2, &LR35902::LD_aBC_A);
-	opcodes.setOpcodePointer(3, &LR35902::INC_BC);
-	opcodes.setOpcodePointer(4, &LR35902::INC_B);
-	opcodes.setOpcodePointer(5, &LR35902::DEC_B);
-	opcodes.setOpcodePointer(6, &LR35902::LD_B_d8);
-	opcodes.setOpcodePointer(7, &LR35902::RLCA);
-	opcodes.setOpcodePointer(8, &LR35902::LD_a16_SP);
-	opcodes.setOpcodePointer(9, &LR35902::ADD_HL_BC);
-	opcodes.setOpcodePointer(10, &LR35902::LD_A_aBC);
-	opcodes.setOpcodePointer(11, &LR35902::DEC_BC);
-	opcodes.setOpcodePointer(12, &LR35902::INC_C);
-	opcodes.setOpcodePointer(13, &LR35902::DEC_C);
-	opcodes.setOpcodePointer(14, &LR35902::LD_C_d8);
-	opcodes.setOpcodePointer(15, &LR35902::RRCA);
-	opcodes.setOpcodePointer(16, &LR35902::STOP_0);
-	opcodes.setOpcodePointer(17, &LR35902::LD_DE_d16);
-	opcodes.setOpcodePointer(18, &LR35902::LD_aDE_A);
-	opcodes.setOpcodePointer(19, &LR35902::INC_DE);
-	opcodes.setOpcodePointer(20, &LR35902::INC_D);
-	opcodes.setOpcodePointer(21, &LR35902::DEC_D);
-	opcodes.setOpcodePointer(22, &LR35902::LD_D_d8);
-	opcodes.setOpcodePointer(23, &LR35902::RLA);
-	opcodes.setOpcodePointer(24, &LR35902::JR_r8);
-	opcodes.setOpcodePointer(25, &LR35902::ADD_HL_DE);
-	opcodes.setOpcodePointer(26, &LR35902::LD_A_aDE);
-	opcodes.setOpcodePointer(27, &LR35902::DEC_DE);
-	opcodes.setOpcodePointer(28, &LR35902::INC_E);
-	opcodes.setOpcodePointer(29, &LR35902::DEC_E);
-	opcodes.setOpcodePointer(30, &LR35902::LD_E_d8);
-	opcodes.setOpcodePointer(31, &LR35902::RRA);
-	opcodes.setOpcodePointer(32, &LR35902::JR_NZ_r8);
-	opcodes.setOpcodePointer(33, &LR35902::LD_HL_d16);
-	opcodes.setOpcodePointer(34, &LR35902::LDI_aHL_A);
-	opcodes.setOpcodePointer(35, &LR35902::INC_HL);
-	opcodes.setOpcodePointer(36, &LR35902::INC_H);
-	opcodes.setOpcodePointer(37, &LR35902::DEC_H);
-	opcodes.setOpcodePointer(38, &LR35902::LD_H_d8);
-	opcodes.setOpcodePointer(39, &LR35902::DAA);
-	opcodes.setOpcodePointer(40, &LR35902::JR_Z_r8);
-	opcodes.setOpcodePointer(41, &LR35902::ADD_HL_HL);
-	opcodes.setOpcodePointer(42, &LR35902::LDI_A_aHL);
-	opcodes.setOpcodePointer(43, &LR35902::DEC_HL);
-	opcodes.setOpcodePointer(44, &LR35902::INC_L);
-	opcodes.setOpcodePointer(45, &LR35902::DEC_L);
-	opcodes.setOpcodePointer(46, &LR35902::LD_L_d8);
-	opcodes.setOpcodePointer(47, &LR35902::CPL);
-	opcodes.setOpcodePointer(48, &LR35902::JR_NC_r8);
-	opcodes.setOpcodePointer(49, &LR35902::LD_SP_d16);
-	opcodes.setOpcodePointer(50, &LR35902::LDD_aHL_A);
-	opcodes.setOpcodePointer(51, &LR35902::INC_SP);
-	opcodes.setOpcodePointer(52, &LR35902::INC_aHL);
-	opcodes.setOpcodePointer(53, &LR35902::DEC_aHL);
-	opcodes.setOpcodePointer(54, &LR35902::LD_aHL_d8);
-	opcodes.setOpcodePointer(55, &LR35902::SCF);
-	opcodes.setOpcodePointer(56, &LR35902::JR_C_r8);
-	opcodes.setOpcodePointer(57, &LR35902::ADD_HL_SP);
-	opcodes.setOpcodePointer(58, &LR35902::LDD_A_aHL);
-	opcodes.setOpcodePointer(59, &LR35902::DEC_SP);
-	opcodes.setOpcodePointer(60, &LR35902::INC_A);
-	opcodes.setOpcodePointer(61, &LR35902::DEC_A);
-	opcodes.setOpcodePointer(62, &LR35902::LD_A_d8);
-	opcodes.setOpcodePointer(63, &LR35902::CCF);
-	opcodes.setOpcodePointer(64, &LR35902::LD_B_B);
-	opcodes.setOpcodePointer(65, &LR35902::LD_B_C);
-	opcodes.setOpcodePointer(66, &LR35902::LD_B_D);
-	opcodes.setOpcodePointer(67, &LR35902::LD_B_E);
-	opcodes.setOpcodePointer(68, &LR35902::LD_B_H);
-	opcodes.setOpcodePointer(69, &LR35902::LD_B_L);
-	opcodes.setOpcodePointer(70, &LR35902::LD_B_aHL);
-	opcodes.setOpcodePointer(71, &LR35902::LD_B_A);
-	opcodes.setOpcodePointer(72, &LR35902::LD_C_B);
-	opcodes.setOpcodePointer(73, &LR35902::LD_C_C);
-	opcodes.setOpcodePointer(74, &LR35902::LD_C_D);
-	opcodes.setOpcodePointer(75, &LR35902::LD_C_E);
-	opcodes.setOpcodePointer(76, &LR35902::LD_C_H);
-	opcodes.setOpcodePointer(77, &LR35902::LD_C_L);
-	opcodes.setOpcodePointer(78, &LR35902::LD_C_aHL);
-	opcodes.setOpcodePointer(79, &LR35902::LD_C_A);
-	opcodes.setOpcodePointer(80, &LR35902::LD_D_B);
-	opcodes.setOpcodePointer(81, &LR35902::LD_D_C);
-	opcodes.setOpcodePointer(82, &LR35902::LD_D_D);
-	opcodes.setOpcodePointer(83, &LR35902::LD_D_E);
-	opcodes.setOpcodePointer(84, &LR35902::LD_D_H);
-	opcodes.setOpcodePointer(85, &LR35902::LD_D_L);
-	opcodes.setOpcodePointer(86, &LR35902::LD_D_aHL);
-	opcodes.setOpcodePointer(87, &LR35902::LD_D_A);
-	opcodes.setOpcodePointer(88, &LR35902::LD_E_B);
-	opcodes.setOpcodePointer(89, &LR35902::LD_E_C);
-	opcodes.setOpcodePointer(90, &LR35902::LD_E_D);
-	opcodes.setOpcodePointer(91, &LR35902::LD_E_E);
-	opcodes.setOpcodePointer(92, &LR35902::LD_E_H);
-	opcodes.setOpcodePointer(93, &LR35902::LD_E_L);
-	opcodes.setOpcodePointer(94, &LR35902::LD_E_aHL);
-	opcodes.setOpcodePointer(95, &LR35902::LD_E_A);
-	opcodes.setOpcodePointer(96, &LR35902::LD_H_B);
-	opcodes.setOpcodePointer(97, &LR35902::LD_H_C);
-	opcodes.setOpcodePointer(98, &LR35902::LD_H_D);
-	opcodes.setOpcodePointer(99, &LR35902::LD_H_E);
-	opcodes.setOpcodePointer(100, &LR35902::LD_H_H);
-	opcodes.setOpcodePointer(101, &LR35902::LD_H_L);
-	opcodes.setOpcodePointer(102, &LR35902::LD_H_aHL);
-	opcodes.setOpcodePointer(103, &LR35902::LD_H_A);
-	opcodes.setOpcodePointer(104, &LR35902::LD_L_B);
-	opcodes.setOpcodePointer(105, &LR35902::LD_L_C);
-	opcodes.setOpcodePointer(106, &LR35902::LD_L_D);
-	opcodes.setOpcodePointer(107, &LR35902::LD_L_E);
-	opcodes.setOpcodePointer(108, &LR35902::LD_L_H);
-	opcodes.setOpcodePointer(109, &LR35902::LD_L_L);
-	opcodes.setOpcodePointer(110, &LR35902::LD_L_aHL);
-	opcodes.setOpcodePointer(111, &LR35902::LD_L_A);
-	opcodes.setOpcodePointer(112, &LR35902::LD_aHL_B);
-	opcodes.setOpcodePointer(113, &LR35902::LD_aHL_C);
-	opcodes.setOpcodePointer(114, &LR35902::LD_aHL_D);
-	opcodes.setOpcodePointer(115, &LR35902::LD_aHL_E);
-	opcodes.setOpcodePointer(116, &LR35902::LD_aHL_H);
-	opcodes.setOpcodePointer(117, &LR35902::LD_aHL_L);
-	opcodes.setOpcodePointer(118, &LR35902::HALT);
-	opcodes.setOpcodePointer(119, &LR35902::LD_aHL_A);
-	opcodes.setOpcodePointer(120, &LR35902::LD_A_B);
-	opcodes.setOpcodePointer(121, &LR35902::LD_A_C);
-	opcodes.setOpcodePointer(122, &LR35902::LD_A_D);
-	opcodes.setOpcodePointer(123, &LR35902::LD_A_E);
-	opcodes.setOpcodePointer(124, &LR35902::LD_A_H);
-	opcodes.setOpcodePointer(125, &LR35902::LD_A_L);
-	opcodes.setOpcodePointer(126, &LR35902::LD_A_aHL);
-	opcodes.setOpcodePointer(127, &LR35902::LD_A_A);
-	opcodes.setOpcodePointer(128, &LR35902::ADD_A_B);
-	opcodes.setOpcodePointer(129, &LR35902::ADD_A_C);
-	opcodes.setOpcodePointer(130, &LR35902::ADD_A_D);
-	opcodes.setOpcodePointer(131, &LR35902::ADD_A_E);
-	opcodes.setOpcodePointer(132, &LR35902::ADD_A_H);
-	opcodes.setOpcodePointer(133, &LR35902::ADD_A_L);
-	opcodes.setOpcodePointer(134, &LR35902::ADD_A_aHL);
-	opcodes.setOpcodePointer(135, &LR35902::ADD_A_A);
-	opcodes.setOpcodePointer(136, &LR35902::ADC_A_B);
-	opcodes.setOpcodePointer(137, &LR35902::ADC_A_C);
-	opcodes.setOpcodePointer(138, &LR35902::ADC_A_D);
-	opcodes.setOpcodePointer(139, &LR35902::ADC_A_E);
-	opcodes.setOpcodePointer(140, &LR35902::ADC_A_H);
-	opcodes.setOpcodePointer(141, &LR35902::ADC_A_L);
-	opcodes.setOpcodePointer(142, &LR35902::ADC_A_aHL);
-	opcodes.setOpcodePointer(143, &LR35902::ADC_A_A);
-	opcodes.setOpcodePointer(144, &LR35902::SUB_B);
-	opcodes.setOpcodePointer(145, &LR35902::SUB_C);
-	opcodes.setOpcodePointer(146, &LR35902::SUB_D);
-	opcodes.setOpcodePointer(147, &LR35902::SUB_E);
-	opcodes.setOpcodePointer(148, &LR35902::SUB_H);
-	opcodes.setOpcodePointer(149, &LR35902::SUB_L);
-	opcodes.setOpcodePointer(150, &LR35902::SUB_aHL);
-	opcodes.setOpcodePointer(151, &LR35902::SUB_A);
-	opcodes.setOpcodePointer(152, &LR35902::SBC_A_B);
-	opcodes.setOpcodePointer(153, &LR35902::SBC_A_C);
-	opcodes.setOpcodePointer(154, &LR35902::SBC_A_D);
-	opcodes.setOpcodePointer(155, &LR35902::SBC_A_E);
-	opcodes.setOpcodePointer(156, &LR35902::SBC_A_H);
-	opcodes.setOpcodePointer(157, &LR35902::SBC_A_L);
-	opcodes.setOpcodePointer(158, &LR35902::SBC_A_aHL);
-	opcodes.setOpcodePointer(159, &LR35902::SBC_A_A);
-	opcodes.setOpcodePointer(160, &LR35902::AND_B);
-	opcodes.setOpcodePointer(161, &LR35902::AND_C);
-	opcodes.setOpcodePointer(162, &LR35902::AND_D);
-	opcodes.setOpcodePointer(163, &LR35902::AND_E);
-	opcodes.setOpcodePointer(164, &LR35902::AND_H);
-	opcodes.setOpcodePointer(165, &LR35902::AND_L);
-	opcodes.setOpcodePointer(166, &LR35902::AND_aHL);
-	opcodes.setOpcodePointer(167, &LR35902::AND_A);
-	opcodes.setOpcodePointer(168, &LR35902::XOR_B);
-	opcodes.setOpcodePointer(169, &LR35902::XOR_C);
-	opcodes.setOpcodePointer(170, &LR35902::XOR_D);
-	opcodes.setOpcodePointer(171, &LR35902::XOR_E);
-	opcodes.setOpcodePointer(172, &LR35902::XOR_H);
-	opcodes.setOpcodePointer(173, &LR35902::XOR_L);
-	opcodes.setOpcodePointer(174, &LR35902::XOR_aHL);
-	opcodes.setOpcodePointer(175, &LR35902::XOR_A);
-	opcodes.setOpcodePointer(176, &LR35902::OR_B);
-	opcodes.setOpcodePointer(177, &LR35902::OR_C);
-	opcodes.setOpcodePointer(178, &LR35902::OR_D);
-	opcodes.setOpcodePointer(179, &LR35902::OR_E);
-	opcodes.setOpcodePointer(180, &LR35902::OR_H);
-	opcodes.setOpcodePointer(181, &LR35902::OR_L);
-	opcodes.setOpcodePointer(182, &LR35902::OR_aHL);
-	opcodes.setOpcodePointer(183, &LR35902::OR_A);
-	opcodes.setOpcodePointer(184, &LR35902::CP_B);
-	opcodes.setOpcodePointer(185, &LR35902::CP_C);
-	opcodes.setOpcodePointer(186, &LR35902::CP_D);
-	opcodes.setOpcodePointer(187, &LR35902::CP_E);
-	opcodes.setOpcodePointer(188, &LR35902::CP_H);
-	opcodes.setOpcodePointer(189, &LR35902::CP_L);
-	opcodes.setOpcodePointer(190, &LR35902::CP_aHL);
-	opcodes.setOpcodePointer(191, &LR35902::CP_A);
-	opcodes.setOpcodePointer(192, &LR35902::RET_NZ);
-	opcodes.setOpcodePointer(193, &LR35902::POP_BC);
-	opcodes.setOpcodePointer(194, &LR35902::JP_NZ_d16);
-	opcodes.setOpcodePointer(195, &LR35902::JP_d16);
-	opcodes.setOpcodePointer(196, &LR35902::CALL_NZ_a16);
-	opcodes.setOpcodePointer(197, &LR35902::PUSH_BC);
-	opcodes.setOpcodePointer(198, &LR35902::ADD_A_d8);
-	opcodes.setOpcodePointer(199, &LR35902::RST_00H);
-	opcodes.setOpcodePointer(200, &LR35902::RET_Z);
-	opcodes.setOpcodePointer(201, &LR35902::RET);
-	opcodes.setOpcodePointer(202, &LR35902::JP_Z_d16);
-	opcodes.setOpcodePointer(203, 0x0);
-	opcodes.setOpcodePointer(204, &LR35902::CALL_Z_a16);
-	opcodes.setOpcodePointer(205, &LR35902::CALL_a16);
-	opcodes.setOpcodePointer(206, &LR35902::ADC_A_d8);
-	opcodes.setOpcodePointer(207, &LR35902::RST_08H);
-	opcodes.setOpcodePointer(208, &LR35902::RET_NC);
-	opcodes.setOpcodePointer(209, &LR35902::POP_DE);
-	opcodes.setOpcodePointer(210, &LR35902::JP_NC_d16);
-	opcodes.setOpcodePointer(211, &LR35902::NOP);
-	opcodes.setOpcodePointer(212, &LR35902::CALL_NC_a16);
-	opcodes.setOpcodePointer(213, &LR35902::PUSH_DE);
-	opcodes.setOpcodePointer(214, &LR35902::SUB_d8);
-	opcodes.setOpcodePointer(215, &LR35902::RST_10H);
-	opcodes.setOpcodePointer(216, &LR35902::RET_C);
-	opcodes.setOpcodePointer(217, &LR35902::RETI);
-	opcodes.setOpcodePointer(218, &LR35902::JP_C_d16);
-	opcodes.setOpcodePointer(219, &LR35902::NOP);
-	opcodes.setOpcodePointer(220, &LR35902::CALL_C_a16);
-	opcodes.setOpcodePointer(221, &LR35902::NOP);
-	opcodes.setOpcodePointer(222, &LR35902::SBC_A_d8);
-	opcodes.setOpcodePointer(223, &LR35902::RST_18H);
-	opcodes.setOpcodePointer(224, &LR35902::LDH_a8_A);
-	opcodes.setOpcodePointer(225, &LR35902::POP_HL);
-	opcodes.setOpcodePointer(226, &LR35902::LD_aC_A);
-	opcodes.setOpcodePointer(227, &LR35902::NOP);
-	opcodes.setOpcodePointer(228, &LR35902::NOP);
-	opcodes.setOpcodePointer(229, &LR35902::PUSH_HL);
-	opcodes.setOpcodePointer(230, &LR35902::AND_d8);
-	opcodes.setOpcodePointer(231, &LR35902::RST_20H);
-	opcodes.setOpcodePointer(232, &LR35902::ADD_SP_r8);
-	opcodes.setOpcodePointer(233, &LR35902::JP_aHL);
-	opcodes.setOpcodePointer(234, &LR35902::LD_a16_A);
-	opcodes.setOpcodePointer(235, &LR35902::NOP);
-	opcodes.setOpcodePointer(236, &LR35902::NOP);
-	opcodes.setOpcodePointer(237, &LR35902::NOP);
-	opcodes.setOpcodePointer(238, &LR35902::XOR_d8);
-	opcodes.setOpcodePointer(239, &LR35902::RST_28H);
-	opcodes.setOpcodePointer(240, &LR35902::LDH_A_a8);
-	opcodes.setOpcodePointer(241, &LR35902::POP_AF);
-	opcodes.setOpcodePointer(242, &LR35902::LD_A_aC);
-	opcodes.setOpcodePointer(243, &LR35902::DI);
-	opcodes.setOpcodePointer(244, &LR35902::NOP);
-	opcodes.setOpcodePointer(245, &LR35902::PUSH_AF);
-	opcodes.setOpcodePointer(246, &LR35902::OR_d8);
-	opcodes.setOpcodePointer(247, &LR35902::RST_30H);
-	opcodes.setOpcodePointer(248, &LR35902::LD_HL_SP_r8);
-	opcodes.setOpcodePointer(249, &LR35902::LD_SP_HL);
-	opcodes.setOpcodePointer(250, &LR35902::LD_A_a16);
-	opcodes.setOpcodePointer(251, &LR35902::EI);
-	opcodes.setOpcodePointer(252, &LR35902::NOP);
-	opcodes.setOpcodePointer(253, &LR35902::NOP);
-	opcodes.setOpcodePointer(254, &LR35902::CP_d8);
-	opcodes.setOpcodePointer(255, &LR35902::RST_38H);
-			
+#define SET_OPCODE_POINTER(index, handler) opcodes.setOpcodePointer(index, &LR35902::handler);
+	LR35902_OPCODE_TABLE(SET_OPCODE_POINTER)
+#undef SET_OPCODE_POINTER
+
 	// CB prefix opcodes
-	opcodes.setOpcodePointerCB(0, &LR35902::RLC_B);
-	opcodes.setOpcodePointerCB(1, &LR35902::RLC_C);
-	opcodes.setOpcodePointerCB(2, &LR35902::RLC_D);
-	opcodes.setOpcodePointerCB(3, &LR35902::RLC_E);
-	opcodes.setOpcodePointerCB(4, &LR35902::RLC_H);
-	opcodes.setOpcodePointerCB(5, &LR35902::RLC_L);
-	opcodes.setOpcodePointerCB(6, &LR35902::RLC_aHL);
-	opcodes.setOpcodePointerCB(7, &LR35902::RLC_A);
-	opcodes.setOpcodePointerCB(8, &LR35902::RRC_B);
-	opcodes.setOpcodePointerCB(9, &LR35902::RRC_C);
-	opcodes.setOpcodePointerCB(10, &LR35902::RRC_D);
-	opcodes.setOpcodePointerCB(11, &LR35902::RRC_E);
-	opcodes.setOpcodePointerCB(12, &LR35902::RRC_H);
-	opcodes.setOpcodePointerCB(13, &LR35902::RRC_L);
-	opcodes.setOpcodePointerCB(14, &LR35902::RRC_aHL);
-	opcodes.setOpcodePointerCB(15, &LR35902::RRC_A);
-	opcodes.setOpcodePointerCB(16, &LR35902::RL_B);
-	opcodes.setOpcodePointerCB(17, &LR35902::RL_C);
-	opcodes.setOpcodePointerCB(18, &LR35902::RL_D);
-	opcodes.setOpcodePointerCB(19, &LR35902::RL_E);
-	opcodes.setOpcodePointerCB(20, &LR35902::RL_H);
-	opcodes.setOpcodePointerCB(21, &LR35902::RL_L);
-	opcodes.setOpcodePointerCB(22, &LR35902::RL_aHL);
-	opcodes.setOpcodePointerCB(23, &LR35902::RL_A);
-	opcodes.setOpcodePointerCB(24, &LR35902::RR_B);
-	opcodes.setOpcodePointerCB(25, &LR35902::RR_C);
-	opcodes.setOpcodePointerCB(26, &LR35902::RR_D);
-	opcodes.setOpcodePointerCB(27, &LR35902::RR_E);
-	opcodes.setOpcodePointerCB(28, &LR35902::RR_H);
-	opcodes.setOpcodePointerCB(29, &LR35902::RR_L);
-	opcodes.setOpcodePointerCB(30, &LR35902::RR_aHL);
-	opcodes.setOpcodePointerCB(31, &LR35902::RR_A);
-	opcodes.setOpcodePointerCB(32, &LR35902::SLA_B);
-	opcodes.setOpcodePointerCB(33, &LR35902::SLA_C);
-	opcodes.setOpcodePointerCB(34, &LR35902::SLA_D);
-	opcodes.setOpcodePointerCB(35, &LR35902::SLA_E);
-	opcodes.setOpcodePointerCB(36, &LR35902::SLA_H);
-	opcodes.setOpcodePointerCB(37, &LR35902::SLA_L);
-	opcodes.setOpcodePointerCB(38, &LR35902::SLA_aHL);
-	opcodes.setOpcodePointerCB(39, &LR35902::SLA_A);
-	opcodes.setOpcodePointerCB(40, &LR35902::SRA_B);
-	opcodes.setOpcodePointerCB(41, &LR35902::SRA_C);
-	opcodes.setOpcodePointerCB(42, &LR35902::SRA_D);
-	opcodes.setOpcodePointerCB(43, &LR35902::SRA_E);
-	opcodes.setOpcodePointerCB(44, &LR35902::SRA_H);
-	opcodes.setOpcodePointerCB(45, &LR35902::SRA_L);
-	opcodes.setOpcodePointerCB(46, &LR35902::SRA_aHL);
-	opcodes.setOpcodePointerCB(47, &LR35902::SRA_A);
-	opcodes.setOpcodePointerCB(48, &LR35902::SWAP_B);
-	opcodes.setOpcodePointerCB(49, &LR35902::SWAP_C);
-	opcodes.setOpcodePointerCB(50, &LR35902::SWAP_D);
-	opcodes.setOpcodePointerCB(51, &LR35902::SWAP_E);
-	opcodes.setOpcodePointerCB(52, &LR35902::SWAP_H);
-	opcodes.setOpcodePointerCB(53, &LR35902::SWAP_L);
-	opcodes.setOpcodePointerCB(54, &LR35902::SWAP_aHL);
-	opcodes.setOpcodePointerCB(55, &LR35902::SWAP_A);
-	opcodes.setOpcodePointerCB(56, &LR35902::SRL_B);
-	opcodes.setOpcodePointerCB(57, &LR35902::SRL_C);
-	opcodes.setOpcodePointerCB(58, &LR35902::SRL_D);
-	opcodes.setOpcodePointerCB(59, &LR35902::SRL_E);
-	opcodes.setOpcodePointerCB(60, &LR35902::SRL_H);
-	opcodes.setOpcodePointerCB(61, &LR35902::SRL_L);
-	opcodes.setOpcodePointerCB(62, &LR35902::SRL_aHL);
-	opcodes.setOpcodePointerCB(63, &LR35902::SRL_A);
-	opcodes.setOpcodePointerCB(64, &LR35902::BIT_0_B);
-	opcodes.setOpcodePointerCB(65, &LR35902::BIT_0_C);
-	opcodes.setOpcodePointerCB(66, &LR35902::BIT_0_D);
-	opcodes.setOpcodePointerCB(67, &LR35902::BIT_0_E);
-	opcodes.setOpcodePointerCB(68, &LR35902::BIT_0_H);
-	opcodes.setOpcodePointerCB(69, &LR35902::BIT_0_L);
-	opcodes.setOpcodePointerCB(70, &LR35902::BIT_0_aHL);
-	opcodes.setOpcodePointerCB(71, &LR35902::BIT_0_A);
-	opcodes.setOpcodePointerCB(72, &LR35902::BIT_1_B);
-	opcodes.setOpcodePointerCB(73, &LR35902::BIT_1_C);
-	opcodes.setOpcodePointerCB(74, &LR35902::BIT_1_D);
-	opcodes.setOpcodePointerCB(75, &LR35902::BIT_1_E);
-	opcodes.setOpcodePointerCB(76, &LR35902::BIT_1_H);
-	opcodes.setOpcodePointerCB(77, &LR35902::BIT_1_L);
-	opcodes.setOpcodePointerCB(78, &LR35902::BIT_1_aHL);
-	opcodes.setOpcodePointerCB(79, &LR35902::BIT_1_A);
-	opcodes.setOpcodePointerCB(80, &LR35902::BIT_2_B);
-	opcodes.setOpcodePointerCB(81, &LR35902::BIT_2_C);
-	opcodes.setOpcodePointerCB(82, &LR35902::BIT_2_D);
-	opcodes.setOpcodePointerCB(83, &LR35902::BIT_2_E);
-	opcodes.setOpcodePointerCB(84, &LR35902::BIT_2_H);
-	opcodes.setOpcodePointerCB(85, &LR35902::BIT_2_L);
-	opcodes.setOpcodePointerCB(86, &LR35902::BIT_2_aHL);
-	opcodes.setOpcodePointerCB(87, &LR35902::BIT_2_A);
-	opcodes.setOpcodePointerCB(88, &LR35902::BIT_3_B);
-	opcodes.setOpcodePointerCB(89, &LR35902::BIT_3_C);
-	opcodes.setOpcodePointerCB(90, &LR35902::BIT_3_D);
-	opcodes.setOpcodePointerCB(91, &LR35902::BIT_3_E);
-	opcodes.setOpcodePointerCB(92, &LR35902::BIT_3_H);
-	opcodes.setOpcodePointerCB(93, &LR35902::BIT_3_L);
-	opcodes.setOpcodePointerCB(94, &LR35902::BIT_3_aHL);
-	opcodes.setOpcodePointerCB(95, &LR35902::BIT_3_A);
-	opcodes.setOpcodePointerCB(96, &LR35902::BIT_4_B);
-	opcodes.setOpcodePointerCB(97, &LR35902::BIT_4_C);
-	opcodes.setOpcodePointerCB(98, &LR35902::BIT_4_D);
-	opcodes.setOpcodePointerCB(99, &LR35902::BIT_4_E);
-	opcodes.setOpcodePointerCB(100, &LR35902::BIT_4_H);
-	opcodes.setOpcodePointerCB(101, &LR35902::BIT_4_L);
-	opcodes.setOpcodePointerCB(102, &LR35902::BIT_4_aHL);
-	opcodes.setOpcodePointerCB(103, &LR35902::BIT_4_A);
-	opcodes.setOpcodePointerCB(104, &LR35902::BIT_5_B);
-	opcodes.setOpcodePointerCB(105, &LR35902::BIT_5_C);
-	opcodes.setOpcodePointerCB(106, &LR35902::BIT_5_D);
-	opcodes.setOpcodePointerCB(107, &LR35902::BIT_5_E);
-	opcodes.setOpcodePointerCB(108, &LR35902::BIT_5_H);
-	opcodes.setOpcodePointerCB(109, &LR35902::BIT_5_L);
-	opcodes.setOpcodePointerCB(110, &LR35902::BIT_5_aHL);
-	opcodes.setOpcodePointerCB(111, &LR35902::BIT_5_A);
-	opcodes.setOpcodePointerCB(112, &LR35902::BIT_6_B);
-	opcodes.setOpcodePointerCB(113, &LR35902::BIT_6_C);
-	opcodes.setOpcodePointerCB(114, &LR35902::BIT_6_D);
-	opcodes.setOpcodePointerCB(115, &LR35902::BIT_6_E);
-	opcodes.setOpcodePointerCB(116, &LR35902::BIT_6_H);
-	opcodes.setOpcodePointerCB(117, &LR35902::BIT_6_L);
-	opcodes.setOpcodePointerCB(118, &LR35902::BIT_6_aHL);
-	opcodes.setOpcodePointerCB(119, &LR35902::BIT_6_A);
-	opcodes.setOpcodePointerCB(120, &LR35902::BIT_7_B);
-	opcodes.setOpcodePointerCB(121, &LR35902::BIT_7_C);
-	opcodes.setOpcodePointerCB(122, &LR35902::BIT_7_D);
-	opcodes.setOpcodePointerCB(123, &LR35902::BIT_7_E);
-	opcodes.setOpcodePointerCB(124, &LR35902::BIT_7_H);
-	opcodes.setOpcodePointerCB(125, &LR35902::BIT_7_L);
-	opcodes.setOpcodePointerCB(126, &LR35902::BIT_7_aHL);
-	opcodes.setOpcodePointerCB(127, &LR35902::BIT_7_A);
-	opcodes.setOpcodePointerCB(128, &LR35902::RES_0_B);
-	opcodes.setOpcodePointerCB(129, &LR35902::RES_0_C);
-	opcodes.setOpcodePointerCB(130, &LR35902::RES_0_D);
-	opcodes.setOpcodePointerCB(131, &LR35902::RES_0_E);
-	opcodes.setOpcodePointerCB(132, &LR35902::RES_0_H);
-	opcodes.setOpcodePointerCB(133, &LR35902::RES_0_L);
-	opcodes.setOpcodePointerCB(134, &LR35902::RES_0_aHL);
-	opcodes.setOpcodePointerCB(135, &LR35902::RES_0_A);
-	opcodes.setOpcodePointerCB(136, &LR35902::RES_1_B);
-	opcodes.setOpcodePointerCB(137, &LR35902::RES_1_C);
-	opcodes.setOpcodePointerCB(138, &LR35902::RES_1_D);
-	opcodes.setOpcodePointerCB(139, &LR35902::RES_1_E);
-	opcodes.setOpcodePointerCB(140, &LR35902::RES_1_H);
-	opcodes.setOpcodePointerCB(141, &LR35902::RES_1_L);
-	opcodes.setOpcodePointerCB(142, &LR35902::RES_1_aHL);
-	opcodes.setOpcodePointerCB(143, &LR35902::RES_1_A);
-	opcodes.setOpcodePointerCB(144, &LR35902::RES_2_B);
-	opcodes.setOpcodePointerCB(145, &LR35902::RES_2_C);
-	opcodes.setOpcodePointerCB(146, &LR35902::RES_2_D);
-	opcodes.setOpcodePointerCB(147, &LR35902::RES_2_E);
-	opcodes.setOpcodePointerCB(148, &LR35902::RES_2_H);
-	opcodes.setOpcodePointerCB(149, &LR35902::RES_2_L);
-	opcodes.setOpcodePointerCB(150, &LR35902::RES_2_aHL);
-	opcodes.setOpcodePointerCB(151, &LR35902::RES_2_A);
-	opcodes.setOpcodePointerCB(152, &LR35902::RES_3_B);
-	opcodes.setOpcodePointerCB(153, &LR35902::RES_3_C);
-	opcodes.setOpcodePointerCB(154, &LR35902::RES_3_D);
-	opcodes.setOpcodePointerCB(155, &LR35902::RES_3_E);
-	opcodes.setOpcodePointerCB(156, &LR35902::RES_3_H);
-	opcodes.setOpcodePointerCB(157, &LR35902::RES_3_L);
-	opcodes.setOpcodePointerCB(158, &LR35902::RES_3_aHL);
-	opcodes.setOpcodePointerCB(159, &LR35902::RES_3_A);
-	opcodes.setOpcodePointerCB(160, &LR35902::RES_4_B);
-	opcodes.setOpcodePointerCB(161, &LR35902::RES_4_C);
-	opcodes.setOpcodePointerCB(162, &LR35902::RES_4_D);
-	opcodes.setOpcodePointerCB(163, &LR35902::RES_4_E);
-	opcodes.setOpcodePointerCB(164, &LR35902::RES_4_H);
-	opcodes.setOpcodePointerCB(165, &LR35902::RES_4_L);
-	opcodes.setOpcodePointerCB(166, &LR35902::RES_4_aHL);
-	opcodes.setOpcodePointerCB(167, &LR35902::RES_4_A);
-	opcodes.setOpcodePointerCB(168, &LR35902::RES_5_B);
-	opcodes.setOpcodePointerCB(169, &LR35902::RES_5_C);
-	opcodes.setOpcodePointerCB(170, &LR35902::RES_5_D);
-	opcodes.setOpcodePointerCB(171, &LR35902::RES_5_E);
-	opcodes.setOpcodePointerCB(172, &LR35902::RES_5_H);
-	opcodes.setOpcodePointerCB(173, &LR35902::RES_5_L);
-	opcodes.setOpcodePointerCB(174, &LR35902::RES_5_aHL);
-	opcodes.setOpcodePointerCB(175, &LR35902::RES_5_A);
-	opcodes.setOpcodePointerCB(176, &LR35902::RES_6_B);
-	opcodes.setOpcodePointerCB(177, &LR35902::RES_6_C);
-	opcodes.setOpcodePointerCB(178, &LR35902::RES_6_D);
-	opcodes.setOpcodePointerCB(179, &LR35902::RES_6_E);
-	opcodes.setOpcodePointerCB(180, &LR35902::RES_6_H);
-	opcodes.setOpcodePointerCB(181, &LR35902::RES_6_L);
-	opcodes.setOpcodePointerCB(182, &LR35902::RES_6_aHL);
-	opcodes.setOpcodePointerCB(183, &LR35902::RES_6_A);
-	opcodes.setOpcodePointerCB(184, &LR35902::RES_7_B);
-	opcodes.setOpcodePointerCB(185, &LR35902::RES_7_C);
-	opcodes.setOpcodePointerCB(186, &LR35902::RES_7_D);
-	opcodes.setOpcodePointerCB(187, &LR35902::RES_7_E);
-	opcodes.setOpcodePointerCB(188, &LR35902::RES_7_H);
-	opcodes.setOpcodePointerCB(189, &LR35902::RES_7_L);
-	opcodes.setOpcodePointerCB(190, &LR35902::RES_7_aHL);
-	opcodes.setOpcodePointerCB(191, &LR35902::RES_7_A);
-	opcodes.setOpcodePointerCB(192, &LR35902::SET_0_B);
-	opcodes.setOpcodePointerCB(193, &LR35902::SET_0_C);
-	opcodes.setOpcodePointerCB(194, &LR35902::SET_0_D);
-	opcodes.setOpcodePointerCB(195, &LR35902::SET_0_E);
-	opcodes.setOpcodePointerCB(196, &LR35902::SET_0_H);
-	opcodes.setOpcodePointerCB(197, &LR35902::SET_0_L);
-	opcodes.setOpcodePointerCB(198, &LR35902::SET_0_aHL);
-	opcodes.setOpcodePointerCB(199, &LR35902::SET_0_A);
-	opcodes.setOpcodePointerCB(200, &LR35902::SET_1_B);
-	opcodes.setOpcodePointerCB(201, &LR35902::SET_1_C);
-	opcodes.setOpcodePointerCB(202, &LR35902::SET_1_D);
-	opcodes.setOpcodePointerCB(203, &LR35902::SET_1_E);
-	opcodes.setOpcodePointerCB(204, &LR35902::SET_1_H);
-	opcodes.setOpcodePointerCB(205, &LR35902::SET_1_L);
-	opcodes.setOpcodePointerCB(206, &LR35902::SET_1_aHL);
-	opcodes.setOpcodePointerCB(207, &LR35902::SET_1_A);
-	opcodes.setOpcodePointerCB(208, &LR35902::SET_2_B);
-	opcodes.setOpcodePointerCB(209, &LR35902::SET_2_C);
-	opcodes.setOpcodePointerCB(210, &LR35902::SET_2_D);
-	opcodes.setOpcodePointerCB(211, &LR35902::SET_2_E);
-	opcodes.setOpcodePointerCB(212, &LR35902::SET_2_H);
-	opcodes.setOpcodePointerCB(213, &LR35902::SET_2_L);
-	opcodes.setOpcodePointerCB(214, &LR35902::SET_2_aHL);
-	opcodes.setOpcodePointerCB(215, &LR35902::SET_2_A);
-	opcodes.setOpcodePointerCB(216, &LR35902::SET_3_B);
-	opcodes.setOpcodePointerCB(217, &LR35902::SET_3_C);
-	opcodes.setOpcodePointerCB(218, &LR35902::SET_3_D);
-	opcodes.setOpcodePointerCB(219, &LR35902::SET_3_E);
-	opcodes.setOpcodePointerCB(220, &LR35902::SET_3_H);
-	opcodes.setOpcodePointerCB(221, &LR35902::SET_3_L);
-	opcodes.setOpcodePointerCB(222, &LR35902::SET_3_aHL);
-	opcodes.setOpcodePointerCB(223, &LR35902::SET_3_A);
-	opcodes.setOpcodePointerCB(224, &LR35902::SET_4_B);
-	opcodes.setOpcodePointerCB(225, &LR35902::SET_4_C);
-	opcodes.setOpcodePointerCB(226, &LR35902::SET_4_D);
-	opcodes.setOpcodePointerCB(227, &LR35902::SET_4_E);
-	opcodes.setOpcodePointerCB(228, &LR35902::SET_4_H);
-	opcodes.setOpcodePointerCB(229, &LR35902::SET_4_L);
-	opcodes.setOpcodePointerCB(230, &LR35902::SET_4_aHL);
-	opcodes.setOpcodePointerCB(231, &LR35902::SET_4_A);
-	opcodes.setOpcodePointerCB(232, &LR35902::SET_5_B);
-	opcodes.setOpcodePointerCB(233, &LR35902::SET_5_C);
-	opcodes.setOpcodePointerCB(234, &LR35902::SET_5_D);
-	opcodes.setOpcodePointerCB(235, &LR35902::SET_5_E);
-	opcodes.setOpcodePointerCB(236, &LR35902::SET_5_H);
-	opcodes.setOpcodePointerCB(237, &LR35902::SET_5_L);
-	opcodes.setOpcodePointerCB(238, &LR35902::SET_5_aHL);
-	opcodes.setOpcodePointerCB(239, &LR35902::SET_5_A);
-	opcodes.setOpcodePointerCB(240, &LR35902::SET_6_B);
-	opcodes.setOpcodePointerCB(241, &LR35902::SET_6_C);
-	opcodes.setOpcodePointerCB(242, &LR35902::SET_6_D);
-	opcodes.setOpcodePointerCB(243, &LR35902::SET_6_E);
-	opcodes.setOpcodePointerCB(244, &LR35902::SET_6_H);
-	opcodes.setOpcodePointerCB(245, &LR35902::SET_6_L);
-	opcodes.setOpcodePointerCB(246, &LR35902::SET_6_aHL);
-	opcodes.setOpcodePointerCB(247, &LR35902::SET_6_A);
-	opcodes.setOpcodePointerCB(248, &LR35902::SET_7_B);
-	opcodes.setOpcodePointerCB(249, &LR35902::SET_7_C);
-	opcodes.setOpcodePointerCB(250, &LR35902::SET_7_D);
-	opcodes.setOpcodePointerCB(251, &LR35902::SET_7_E);
-	opcodes.setOpcodePointerCB(252, &LR35902::SET_7_H);
-	opcodes.setOpcodePointerCB(253, &LR35902::SET_7_L);
-	opcodes.setOpcodePointerCB(254, &LR35902::SET_7_aHL);
-	opcodes.setOpcodePointerCB(255, &LR35902::SET_7_A); 
+#define SET_OPCODE_POINTER_CB(index, handler) opcodes.setOpcodePointerCB(index, &LR35902::handler);
+	LR35902_OPCODE_TABLE_CB(SET_OPCODE_POINTER_CB)
+#undef SET_OPCODE_POINTER_CB
 
 	// Set memory address getters/setters for opcodes which access system memory
 	opcodes.setMemoryAccess(this);
+	updateJitLayout();
+
+	// Flag all control flow (and undefined) opcodes as block terminators
+	const std::vector<std::string> controlFlow = { "jp", "jr", "call", "ret", "reti", "rst", "halt", "stop", "ei", "di", "prefix", "" };
+	for(unsigned short i = 0; i < 256; i++){
+		std::string name = opcodes.getOpcodes()[i].sName;
+		name = name.substr(0, name.find(' '));
+		blockTerminator[i] = (std::find(controlFlow.begin(), controlFlow.end(), name) != controlFlow.end());
+	}
+	blockTerminator[0x08] = true; // LD (a16),SP writes directly to memory
+
+	// Flag all opcodes which access the stack or change interrupt state as unsafe for idle loops
+	const std::vector<std::string> idleUnsafe = { "call", "ret", "reti", "rst", "push", "pop", "halt", "stop", "ei", "di", "prefix", "" };
+	for(unsigned short i = 0; i < 256; i++){
+		std::string name = opcodes.getOpcodes()[i].sName;
+		name = name.substr(0, name.find(' '));
+		idleLoopUnsafe[i] = (std::find(idleUnsafe.begin(), idleUnsafe.end(), name) != idleUnsafe.end());
+	}
+	idleLoopUnsafe[0x08] = true; // LD (a16),SP writes directly to memory
 }
 
 void LR35902::reset(){
@@ -1372,6 +1286,17 @@ void LR35902::reset(){
 	setHL(0x014D); // 0x014D
 	SP = 0xFFFE;   // 0xFFFE
 	PC = 0x0100;   // 0x0100
+	cache.clear(); // Flush all decoded instructions
+	blocks.clear();
+	jit.clear(); // Compiled blocks were released along with the block cache
+	resetIdleLoop();
+	blockStart = true;
+}
+
+void LR35902::resetIdleLoop(){
+	idleLoopValid = false;
+	idleLoopTainted = true;
+	idleLoopDetected = false;
 }
 
 void LR35902::userAddSavestateValues(){
@@ -0,0 +1,228 @@
+#include <cstring>
+
+#include "ScanlineCompositor.hpp"
+
+#ifndef USE_SCALAR_COMPOSITOR
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define COMPOSITOR_SSE2
+		#include <emmintrin.h>
+	#endif
+	// AVX2 is selected at runtime, so the host CPU is checked using a GCC / Clang builtin
+	#if defined(COMPOSITOR_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+		#define COMPOSITOR_AVX2
+		#include <immintrin.h>
+	#endif
+#endif
+
+/////////////////////////////////////////////////////////////////////
+// class LayerLine
+/////////////////////////////////////////////////////////////////////
+
+LayerLine::LayerLine(){
+	reset();
+}
+
+void LayerLine::reset(){
+	memset(color, 0, LAYER_LINE_WIDTH);
+	memset(palette, 0, LAYER_LINE_WIDTH);
+	memset(priority, 0, LAYER_LINE_WIDTH);
+	memset(visible, 0, LAYER_LINE_WIDTH);
+}
+
+/////////////////////////////////////////////////////////////////////
+// class ScanlineCompositor
+/////////////////////////////////////////////////////////////////////
+
+ScanlineCompositor::ScanlineCompositor() :
+	method(compositeMethod::SCALAR),
+	useObjPriority(true),
+	useBgPriority(false),
+	bgColor(),
+	bgPalette(),
+	bgPriority(),
+	objColor(),
+	objPalette(),
+	objPriority(),
+	objVisible(),
+	colorIndex()
+{
+#if defined(COMPOSITOR_AVX2)
+	__builtin_cpu_init();
+	method = (__builtin_cpu_supports("avx2") ? compositeMethod::AVX2 : compositeMethod::SSE2);
+#elif defined(COMPOSITOR_SSE2)
+	method = compositeMethod::SSE2;
+#endif
+}
+
+void ScanlineCompositor::composite(const LayerLine &background, const LayerLine &window, const LayerLine &sprites, const unsigned char &scroll, const short &windowStart, const uint32_t *palette, uint32_t *output){
+	// Clamp the start of the window to the screen so that it may be compared with pixel indices
+	unsigned char windowX = (unsigned char)(windowStart < 0 ? 0 : (windowStart > SCREEN_LINE_WIDTH ? SCREEN_LINE_WIDTH : windowStart));
+	unwrap(background, sprites, scroll);
+	switch(method){
+		case compositeMethod::AVX2:
+			mixAVX2(window, windowX, palette, output);
+			return; // Colors are gathered directly from the palette table
+		case compositeMethod::SSE2:
+			mixSSE2(window, windowX);
+			break;
+		default:
+			mixScalar(window, windowX);
+			break;
+	}
+	for(unsigned short x = 0; x < SCREEN_LINE_WIDTH; x++)
+		output[x] = palette[colorIndex[x]];
+}
+
+std::string ScanlineCompositor::getMethod() const {
+	switch(method){
+		case compositeMethod::AVX2:
+			return "avx2";
+		case compositeMethod::SSE2:
+			return "sse2";
+		default:
+			break;
+	}
+	return "scalar";
+}
+
+bool ScanlineCompositor::setMethod(const std::string &name){
+	if(name == "scalar"){
+		method = compositeMethod::SCALAR;
+		return true;
+	}
+#if defined(COMPOSITOR_SSE2)
+	if(name == "sse2"){
+		method = compositeMethod::SSE2;
+		return true;
+	}
+#endif
+#if defined(COMPOSITOR_AVX2)
+	if(name == "avx2" && __builtin_cpu_supports("avx2")){
+		method = compositeMethod::AVX2;
+		return true;
+	}
+#endif
+	return false;
+}
+
+void ScanlineCompositor::unwrap(const LayerLine &background, const LayerLine &sprites, const unsigned char &scroll){
+	// The screen wraps around to the left edge of the layer when scrolled past the right edge
+	const unsigned short nRight = (scroll + SCREEN_LINE_WIDTH <= LAYER_LINE_WIDTH ? SCREEN_LINE_WIDTH : LAYER_LINE_WIDTH - scroll);
+	const unsigned short nLeft = SCREEN_LINE_WIDTH - nRight;
+	const unsigned char *src[7] = { background.color, background.palette, background.priority, sprites.color, sprites.palette, sprites.priority, sprites.visible };
+	unsigned char *dest[7] = { bgColor, bgPalette, bgPriority, objColor, objPalette, objPriority, objVisible };
+	for(unsigned short i = 0; i < 7; i++){
+		memcpy(dest[i], &src[i][scroll], nRight);
+		if(nLeft)
+			memcpy(&dest[i][nRight], src[i], nLeft);
+	}
+}
+
+void ScanlineCompositor::mixScalar(const LayerLine &window, const unsigned char &windowStart){
+	for(unsigned short x = 0; x < SCREEN_LINE_WIDTH; x++){
+		unsigned char color, pal;
+		if(x >= windowStart){ // Draw window
+			color = window.color[x];
+			pal = window.palette[x];
+		}
+		else{ // Draw background
+			color = bgColor[x];
+			pal = bgPalette[x];
+		}
+		if(objVisible[x]){
+			bool behindBg = (useObjPriority && objPriority[x] && bgColor[x]); // OBJ behind BG color 1-3
+			bool bgOnTop = (useBgPriority && bgPriority[x]); // BG priority (tile attributes)
+			if(!behindBg && !bgOnTop){ // Draw sprite
+				color = objColor[x];
+				pal = objPalette[x];
+			}
+		}
+		colorIndex[x] = 4 * pal + color;
+	}
+}
+
+#ifdef COMPOSITOR_SSE2
+
+void ScanlineCompositor::mixSSE2(const LayerLine &window, const unsigned char &windowStart){
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i ones = _mm_set1_epi8(-1);
+	const __m128i objPriorityMask = (useObjPriority ? ones : zero);
+	const __m128i bgPriorityMask = (useBgPriority ? ones : zero);
+	const __m128i winX = _mm_set1_epi8((char)windowStart);
+	__m128i pixelX = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+	for(unsigned short x = 0; x < SCREEN_LINE_WIDTH; x += 16){
+		// Select the window or the background
+		__m128i useWindow = _mm_cmpeq_epi8(_mm_max_epu8(pixelX, winX), pixelX); // x >= windowStart
+		__m128i bgc = _mm_loadu_si128((const __m128i*)&bgColor[x]);
+		__m128i color = _mm_or_si128(_mm_and_si128(useWindow, _mm_loadu_si128((const __m128i*)&window.color[x])), _mm_andnot_si128(useWindow, bgc));
+		__m128i pal = _mm_or_si128(_mm_and_si128(useWindow, _mm_loadu_si128((const __m128i*)&window.palette[x])), _mm_andnot_si128(useWindow, _mm_loadu_si128((const __m128i*)&bgPalette[x])));
+
+		// Select pixels where the sprite is visible and is not hidden behind the background
+		__m128i visible = _mm_xor_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&objVisible[x]), zero), ones);
+		__m128i behindBg = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&objPriority[x]), zero), _mm_cmpeq_epi8(bgc, zero)), objPriorityMask);
+		__m128i bgOnTop = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&bgPriority[x]), zero), bgPriorityMask);
+		__m128i useSprite = _mm_andnot_si128(_mm_or_si128(behindBg, bgOnTop), visible);
+		color = _mm_or_si128(_mm_and_si128(useSprite, _mm_loadu_si128((const __m128i*)&objColor[x])), _mm_andnot_si128(useSprite, color));
+		pal = _mm_or_si128(_mm_and_si128(useSprite, _mm_loadu_si128((const __m128i*)&objPalette[x])), _mm_andnot_si128(useSprite, pal));
+
+		// Palette numbers are less than 64, so shifting 16-bit lanes does not carry into the neighboring byte
+		_mm_storeu_si128((__m128i*)&colorIndex[x], _mm_add_epi8(_mm_slli_epi16(pal, 2), color));
+		pixelX = _mm_add_epi8(pixelX, _mm_set1_epi8(16));
+	}
+}
+
+#else
+
+void ScanlineCompositor::mixSSE2(const LayerLine &window, const unsigned char &windowStart){
+	mixScalar(window, windowStart);
+}
+
+#endif
+
+#ifdef COMPOSITOR_AVX2
+
+__attribute__((target("avx2")))
+void ScanlineCompositor::mixAVX2(const LayerLine &window, const unsigned char &windowStart, const uint32_t *palette, uint32_t *output){
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i ones = _mm256_set1_epi8(-1);
+	const __m256i objPriorityMask = (useObjPriority ? ones : zero);
+	const __m256i bgPriorityMask = (useBgPriority ? ones : zero);
+	const __m256i winX = _mm256_set1_epi8((char)windowStart);
+	__m256i pixelX = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+	                                  16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+	for(unsigned short x = 0; x < SCREEN_LINE_WIDTH; x += 32){
+		// Select the window or the background
+		__m256i useWindow = _mm256_cmpeq_epi8(_mm256_max_epu8(pixelX, winX), pixelX); // x >= windowStart
+		__m256i bgc = _mm256_loadu_si256((const __m256i*)&bgColor[x]);
+		__m256i color = _mm256_blendv_epi8(bgc, _mm256_loadu_si256((const __m256i*)&window.color[x]), useWindow);
+		__m256i pal = _mm256_blendv_epi8(_mm256_loadu_si256((const __m256i*)&bgPalette[x]), _mm256_loadu_si256((const __m256i*)&window.palette[x]), useWindow);
+
+		// Select pixels where the sprite is visible and is not hidden behind the background
+		__m256i visible = _mm256_xor_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)&objVisible[x]), zero), ones);
+		__m256i behindBg = _mm256_andnot_si256(_mm256_or_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)&objPriority[x]), zero), _mm256_cmpeq_epi8(bgc, zero)), objPriorityMask);
+		__m256i bgOnTop = _mm256_andnot_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)&bgPriority[x]), zero), bgPriorityMask);
+		__m256i useSprite = _mm256_andnot_si256(_mm256_or_si256(behindBg, bgOnTop), visible);
+		color = _mm256_blendv_epi8(color, _mm256_loadu_si256((const __m256i*)&objColor[x]), useSprite);
+		pal = _mm256_blendv_epi8(pal, _mm256_loadu_si256((const __m256i*)&objPalette[x]), useSprite);
+
+		// Palette numbers are less than 64, so shifting 16-bit lanes does not carry into the neighboring byte
+		_mm256_storeu_si256((__m256i*)&colorIndex[x], _mm256_add_epi8(_mm256_slli_epi16(pal, 2), color));
+		pixelX = _mm256_add_epi8(pixelX, _mm256_set1_epi8(32));
+
+		// Gather the output colors from the palette table (8 pixels at a time)
+		for(unsigned short i = 0; i < 32; i += 8){
+			__m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)&colorIndex[x + i]));
+			_mm256_storeu_si256((__m256i*)&output[x + i], _mm256_i32gather_epi32((const int*)palette, index, 4));
+		}
+	}
+}
+
+#else
+
+void ScanlineCompositor::mixAVX2(const LayerLine &window, const unsigned char &windowStart, const uint32_t *palette, uint32_t *output){
+	mixSSE2(window, windowStart);
+	for(unsigned short x = 0; x < SCREEN_LINE_WIDTH; x++)
+		output[x] = palette[colorIndex[x]];
+}
+
+#endif
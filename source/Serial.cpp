@@ -6,4 +6,8 @@
 void SerialController::defineRegisters(){
 	sys->addSystemRegister(this, 0x01, rSB, "SB", "33333333");
 	sys->addSystemRegister(this, 0x02, rSC, "SC", "33000003");
+
+	// The serial controller has no register handlers
+	sys->setRegisterWriteHandler(0x01, 0x0);
+	sys->setRegisterWriteHandler(0x02, 0x0);
 }
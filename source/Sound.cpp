@@ -344,6 +344,21 @@ bool SoundProcessor::onClockUpdate(){
 	return false;
 }
 
+bool SoundProcessor::onClockAdvance(const unsigned int &nCycles){
+	bool retval = false;
+	for(unsigned int i = 0; i < nCycles; i++){
+		if(SoundProcessor::onClockUpdate())
+			retval = true;
+	}
+	return retval;
+}
+
+unsigned int SoundProcessor::getCyclesUntilNextEvent(){
+	if(!bEnabled) // If timer not enabled
+		return 0;
+	return (nPeriod > nCyclesSinceLastTick ? nPeriod - nCyclesSinceLastTick : 1);
+}
+
 bool SoundProcessor::isChannelEnabled(const int& ch) const {
 	if(ch < 1 || ch > 4)
 		return false;
@@ -573,6 +588,13 @@ void SoundProcessor::defineRegisters(){
 	// Wave RAM
 	for(unsigned char i = 0x0; i <= 0xF; i++)
 		sys->addSystemRegister(this, i+0x30, rWAVE[i], "WAVE", "33333333");
+
+	// Call the APU register handlers directly. Reads are also handled since unused bits read back as ones.
+	for(unsigned char reg = 0x10; reg <= 0x3F; reg++){
+		sys->setRegisterCheckHandler(reg, checkComponentRegister<SoundProcessor>);
+		sys->setRegisterWriteHandler(reg, writeComponentRegister<SoundProcessor>);
+		sys->setRegisterReadHandler(reg, readComponentRegister<SoundProcessor>);
+	}
 }
 
 void SoundProcessor::userAddSavestateValues(){
@@ -1,5 +1,4 @@
 
-#include <algorithm>
 
 #include "SpriteAttributes.hpp"
 #include "SystemRegisters.hpp"
@@ -36,7 +35,7 @@ SpriteHandler::SpriteHandler() :
 	reset();
 }
 
-bool SpriteHandler::updateNextSprite(std::vector<SpriteAttributes> &sprites){
+bool SpriteHandler::updateNextSprite(SpriteAttributes *sprites){
 	if(lModified.empty())
 		return false;
 
@@ -44,29 +43,8 @@ bool SpriteHandler::updateNextSprite(std::vector<SpriteAttributes> &sprites){
 	bModified[spriteIndex] = false;
 	lModified.pop();
 
-	// Search for the sprite in the list of active sprites
-	std::vector<SpriteAttributes>::iterator iter = std::find(sprites.begin(), sprites.end(), spriteIndex);
-	
-	unsigned char *data = &mem[0][spriteIndex*4];
-	if((data[0] == 0 || data[0] >= 160) || (data[1] == 0 || data[1] >= 168)){
-		if(iter != sprites.end()) // Remove the sprite from the list
-			sprites.erase(iter);
-		return true; // Sprite is hidden.
-	}
-
-	SpriteAttributes *current;
-	if(iter != sprites.end()) // Get a pointer to an existing sprite
-		current = &(*iter);
-	else{ // Add the sprite to the list
-		sprites.push_back(SpriteAttributes());
-		current = &sprites.back();
-	}
-	
 	// Decode the sprite attributes.
-	getSpriteData(data, current);
-	
-	// Set the sprite index. 
-	current->oamIndex = spriteIndex;
+	sprites[spriteIndex] = getSpriteAttributes(spriteIndex);
 	
 	return true;
 }
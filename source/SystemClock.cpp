@@ -16,6 +16,22 @@ constexpr unsigned int MODE1_START = 65664; // STAT mode 1 from 65664 to 70224 (
 constexpr unsigned int VERTICAL_SYNC_CYCLES   = 70224; // CPU cycles per VSYNC (~59.73 Hz)
 constexpr unsigned int HORIZONTAL_SYNC_CYCLES = 456;   // CPU cycles per HSYNC (per 154 scanlines)
 
+/** Get the number of system clock ticks until the pixel clock reaches a target value
+  * @param target The target pixel clock value
+  * @param current The current pixel clock value
+  * @return The number of system clock ticks (4 pixel clock ticks each) or zero if the target has already been passed
+  */
+unsigned int getTicksUntil(const unsigned int &target, const unsigned int &current){
+	return (target > current ? (target - current + 3) / 4 : 0);
+}
+
+/** Update the minimum number of ticks with a new value, ignoring zero
+  */
+void setMinimumTicks(unsigned int &ticks, const unsigned int &val){
+	if(val != 0 && (ticks == 0 || val < ticks))
+		ticks = val;
+}
+
 SystemClock::SystemClock() : 
 	SystemComponent("Clock", 0x204b4c43), // "CLK "
 	vsync(false), 
@@ -27,6 +43,7 @@ SystemClock::SystemClock() :
 	lcdDriverMode(2), 
 	framerate(0),
 	framePeriod(0),
+	frameWorkTime(0),
 	timeOfInitialization(hrclock::now()),
 	timeOfLastVSync(hrclock::now()),
 	cycleTimer(hrclock::now()),
@@ -144,6 +161,38 @@ bool SystemClock::onClockUpdate(){
 	return vsync;
 }
 
+bool SystemClock::onClockAdvance(const unsigned int &nCycles){
+	if(nCycles == 0)
+		return false;
+	if(nCycles > 1){ // Skip ahead to the final tick
+		cycleCounter += nCycles - 1;
+		if(rLCDC->bit7()){
+			cyclesSinceLastVSync += 4 * (nCycles - 1);
+			cyclesSinceLastHSync += 4 * (nCycles - 1);
+		}
+	}
+	return onClockUpdate();
+}
+
+unsigned int SystemClock::getCyclesUntilNextEvent(){
+	// Framerate statistics are updated every ten seconds
+	unsigned int nTicks = currentClockSpeed*10 - (cycleCounter % (currentClockSpeed*10));
+	if(!rLCDC->bit7()) // Display disabled
+		return (lcdDriverMode != 1 ? 1 : nTicks);
+	if(cyclesSinceLastVSync <= modeStart[1]){ // Visible scanlines (0-143)
+		setMinimumTicks(nTicks, getTicksUntil(modeStart[3], cyclesSinceLastHSync)); // Mode 2->3
+		setMinimumTicks(nTicks, getTicksUntil(modeStart[0] - nClockPause, cyclesSinceLastHSync)); // Mode 3->0
+		setMinimumTicks(nTicks, getTicksUntil(modeStart[1] + 1, cyclesSinceLastVSync)); // End of visible scanlines
+	}
+	else{ // Mode 1 - Overscan (144-153)
+		setMinimumTicks(nTicks, getTicksUntil(cyclesPerVSync, cyclesSinceLastVSync)); // Mode 1->2
+	}
+	setMinimumTicks(nTicks, getTicksUntil(cyclesPerHSync, cyclesSinceLastHSync)); // Next scanline
+	if(cyclesSinceLastHSync >= cyclesPerHSync || cyclesSinceLastVSync >= cyclesPerVSync) // Unexpected state, clock every tick
+		return 1;
+	return nTicks;
+}
+
 void SystemClock::wait(){
 	waitUntilNextVSync();
 }
@@ -185,7 +234,8 @@ void SystemClock::waitUntilNextVSync(){
 	static unsigned int frameCount = 0;
 	static double totalRenderTime = 0;
 	std::chrono::duration<double, std::micro> wallTime = hrclock::now() - timeOfLastVSync;
-	double timeToSleep = framePeriod - wallTime.count(); // microseconds
+	frameWorkTime = wallTime.count();
+	double timeToSleep = framePeriod - frameWorkTime; // microseconds
 	if(timeToSleep > 0)
 		std::this_thread::sleep_for(std::chrono::microseconds((long long)timeToSleep));
 	totalRenderTime += std::chrono::duration_cast<std::chrono::duration<double>>(hrclock::now() - timeOfLastVSync).count();
@@ -233,7 +283,6 @@ void SystemClock::startMode3(){
 
 void SystemClock::userAddSavestateValues(){
 	unsigned int sizeULong = sizeof(unsigned int);
-	unsigned int sizeDouble = sizeof(double);
 	// Ints
 	addSavestateValue(&cyclesSinceLastVSync, sizeULong);
 	addSavestateValue(&cyclesSinceLastHSync, sizeULong);
@@ -245,10 +294,8 @@ void SystemClock::userAddSavestateValues(){
 	// Bytes
 	addSavestateValue(&lcdDriverMode, sizeof(unsigned char));
 	addSavestateValue(&vsync,         sizeof(bool));
-	// Doubles
-	addSavestateValue(&framerate, sizeDouble);
-	addSavestateValue(&framePeriod, sizeDouble);
-	addSavestateValue(&cyclesPerSecond, sizeDouble);
+	// The framerate, frame period, and clock rate are not saved. They are host timing values (set by the framerate
+	// multiplier and measured against the wall clock) and are kept or re-measured after loading a state.
 	//hrclock::time_point timeOfInitialization; ///< The time that the system clock was initialized
 	//hrclock::time_point timeOfLastVSync; ///< The time at which the screen was last refreshed
 	//hrclock::time_point cycleTimer;
@@ -25,19 +25,36 @@
 #include "Serial.hpp"
 #include "SoundManager.hpp"
 #include "MidiFile.hpp"
+#include "ImageWriter.hpp"
+#include "RewindBuffer.hpp"
+#include "SavestateReader.hpp"
+#include "Lz4Codec.hpp"
 
 #ifdef USE_QT_DEBUGGER
 	#include "mainwindow.h"
 #endif
 
-constexpr unsigned char SAVESTATE_VERSION = 0x1;
+constexpr unsigned short SAVESTATE_VERSION = 0x2;
+
+constexpr unsigned int SYSTEM_CHUNK_ID = 0x20535953; // "SYS " (system flags and interrupt enables)
+constexpr unsigned int REGISTER_CHUNK_ID = 0x53474552; // "REGS" (system registers)
+constexpr unsigned short SYSTEM_CHUNK_VERSION = 0x1;
+constexpr unsigned short REGISTER_CHUNK_VERSION = 0x1;
+constexpr unsigned int SYSTEM_CHUNK_LENGTH = 3;
 
 constexpr unsigned short VRAM_SWAP_START = 0x8000;
+constexpr unsigned short TILE_MAP_START  = 0x9800;
 constexpr unsigned short CART_RAM_START  = 0xA000;
 constexpr unsigned short WRAM_ZERO_START = 0xC000;
+constexpr unsigned short WRAM_SWAP_START = 0xD000;
+constexpr unsigned short WRAM_ECHO_START = 0xE000;
 constexpr unsigned short OAM_TABLE_START = 0xFE00;
 constexpr unsigned short HIGH_RAM_START  = 0xFF80;
 
+constexpr float BENCHMARK_FRAMERATE_MULTIPLIER = 1E6; // Effectively disables the framerate limit
+
+constexpr unsigned int MAX_CPU_RUN_CYCLES = 456; // Maximum number of machine cycles the CPU may run between main loop iterations
+
 constexpr unsigned short REGISTER_LOW    = 0xFF00;
 constexpr unsigned short REGISTER_HIGH   = 0xFF80;
 
@@ -85,6 +102,9 @@ SystemGBC::SystemGBC(int& argc, char* argv[]) :
 	dummyComponent("System"),
 	nFrames(0),
 	frameSkip(1),
+	autoFrameSkip(false),
+	frameRendered(true),
+	frameSkipper(),
 	verboseMode(false),
 	debugMode(false),
 	cpuStopped(false),
@@ -95,6 +115,7 @@ SystemGBC::SystemGBC(int& argc, char* argv[]) :
 	displayFramerate(false),
 	userQuitting(false),
 	autoLoadExtRam(true),
+	compressExtRam(false),
 	initSuccessful(false),
 	fatalError(false),
 	consoleIsOpen(false),
@@ -111,7 +132,19 @@ SystemGBC::SystemGBC(int& argc, char* argv[]) :
 	pauseAfterNextClock(false),
 	pauseAfterNextHBlank(false),
 	pauseAfterNextVBlank(false),
-	audioInterface(&SoundManager::getInstance())
+	benchmarkLength(0),
+	benchmarkFrames(0),
+	benchmarkInstructions(0),
+	benchmarkTimer(),
+	frameNumber(0),
+	frameDumpInterval(0),
+	screenshotIndex(1),
+	rewindInterval(0),
+	rewindState(),
+	audioInterface(&SoundManager::getInstance()),
+	readPages(),
+	writePages(),
+	writeDirty()
 { 
 	// Disable memory region monitor
 	memoryAccessWrite[0] = 1; 
@@ -130,9 +163,17 @@ SystemGBC::SystemGBC(int& argc, char* argv[]) :
 	handler.add(optionExt("framerate", required_argument, NULL, 'F', "<multiplier>", "Set target framerate multiplier (default=1)."));
 	handler.add(optionExt("volume", required_argument, NULL, 'V', "<volume>", "Set initial output volume (in range 0 to 1)."));
 	handler.add(optionExt("verbose", no_argument, NULL, 'v', "", "Toggle verbose mode."));
-	handler.add(optionExt("scale-factor", required_argument, NULL, 'S', "<N>", "Set the integer size multiplier for the screen (default 2)."));
+	handler.add(optionExt("scale-factor", required_argument, NULL, 'S', "<N|filter>", "Set the integer size multiplier for the screen (default 2) or an upscaling filter (nearest<N>x, scale2x, scale3x, xbr<N>x)."));
 	handler.add(optionExt("use-color", no_argument, NULL, 'C', "", "Use GBC mode for original GB games."));
 	handler.add(optionExt("no-load-sram", no_argument, NULL, 'n', "", "Do not load external cartridge RAM (SRAM) at boot."));
+	handler.add(optionExt("benchmark", required_argument, NULL, 'B', "<seconds>", "Run without framerate limit for the specified time and print CPU performance."));
+	handler.add(optionExt("cpu-engine", required_argument, NULL, 'E', "<engine>", "Set the CPU engine, options are: interpreter block jit (default=interpreter)."));
+	handler.add(optionExt("trace", required_argument, NULL, 't', "<filename>", "Write a trace of all executed CPU instructions to a file."));
+	handler.add(optionExt("headless", no_argument, NULL, 'H', "", "Run without a display (no window is opened)."));
+	handler.add(optionExt("frame-skip", required_argument, NULL, 's', "<N|auto>", "Render 1 out of every N frames, or adjust frame-skip automatically to hold the target framerate (default=1)."));
+	handler.add(optionExt("dump-frames", required_argument, NULL, 'D', "<N>", "Write every Nth frame to a PNG image (dumped frames are drawn even when frame-skip would skip them)."));
+	handler.add(optionExt("rewind", required_argument, NULL, 'R', "<N>", "Take a rewind snapshot every N frames (hold backspace to rewind)."));
+	handler.add(optionExt("benchmark-frames", required_argument, NULL, 'f', "<N>", "Run without framerate limit for N emulated frames and print CPU performance and the hash of the last frame."));
 #ifdef USE_QT_DEBUGGER			
 	handler.add(optionExt("debug", no_argument, NULL, 'd', "", "Enable Qt debugging GUI."));
 	handler.add(optionExt("tile-viewer", no_argument, NULL, 'T', "", "Enable VRAM tile viewer (if debug gui enabled)."));
@@ -214,6 +255,12 @@ SystemGBC::SystemGBC(int& argc, char* argv[]) :
 	// Initialize registers vector
 	registers = std::vector<Register>(REGISTER_HIGH-REGISTER_LOW, Register());
 
+#ifndef _WIN32
+	// The window is opened when the system is initialized
+	if(handler.getOption(11)->active) // Run without a display
+		gpu->setHeadless(true);
+#endif // ifndef _WIN32
+
 	// Initialize system components
 	this->initialize();
 
@@ -230,12 +277,25 @@ SystemGBC::SystemGBC(int& argc, char* argv[]) :
 			sclk->setFramerateMultiplier(cfgFile.getFloat());
 		if (cfgFile.searchBoolFlag("VERBOSE_MODE")) // Toggle verbose flag
 			setVerboseMode(true);
-		if (cfgFile.search("PIXEL_SCALE", true)) // Set pixel scaling factor
-			gpu->setPixelScale(cfgFile.getUInt());
+		if (cfgFile.search("PIXEL_SCALE", true) && !gpu->setPixelScale(cfgFile.getValue())) // Set pixel scaling factor and upscaling filter
+			std::cout << sysWarning << "Unsupported pixel scale (" << cfgFile.getValue() << ")." << std::endl;
+		if (cfgFile.search("FRAME_SKIP", true) && !setFrameSkip(cfgFile.getValue())) // Set frame-skip
+			std::cout << sysWarning << "Invalid frame-skip (" << cfgFile.getValue() << ")." << std::endl;
+		if (cfgFile.search("REWIND_INTERVAL", true)){ // Enable rewinding
+			unsigned int interval = cfgFile.getUInt();
+			if (cfgFile.search("REWIND_BUFFER_SIZE", true)) // Size of the rewind history (in MB)
+				setRewind(interval, (size_t)(cfgFile.getFloat() * 0x100000));
+			else
+				setRewind(interval);
+		}
 		if (cfgFile.searchBoolFlag("FORCE_COLOR")) // Use GBC mode for original GB games
 			setForceColorMode(true);
+		if (cfgFile.searchBoolFlag("COLOR_CORRECTION")) // Approximate the colors of the GBC LCD
+			gpu->setColorCorrection(true);
 		if (cfgFile.searchBoolFlag("DISABLE_AUTO_SAVE")) // Do not automatically save/load external cartridge RAM (SRAM)
 			autoLoadExtRam = false;
+		if (cfgFile.searchBoolFlag("COMPRESS_SRAM")) // Write external cartridge RAM (SRAM) files with LZ4 compression
+			compressExtRam = true;
 #ifdef USE_QT_DEBUGGER			
 		if (cfgFile.searchBoolFlag("DEBUG_MODE")) { // Toggle debug flag
 			setDebugMode(true);
@@ -257,18 +317,47 @@ SystemGBC::SystemGBC(int& argc, char* argv[]) :
 			sound->getMixer()->setVolume(strtod(handler.getOption(3)->argument.c_str(), NULL));
 		if(handler.getOption(4)->active) // Toggle verbose flag
 			setVerboseMode(true);
-		if(handler.getOption(5)->active) // Set pixel scaling factor
-			gpu->setPixelScale(strtoul(handler.getOption(5)->argument.c_str(), NULL, 10));
+		if(handler.getOption(5)->active && !gpu->setPixelScale(handler.getOption(5)->argument)) // Set pixel scaling factor and upscaling filter
+			std::cout << sysWarning << "Unsupported pixel scale (" << handler.getOption(5)->argument << ")." << std::endl;
 		if(handler.getOption(6)->active) // Use GBC mode for original GB games
 			forceColor = true;
 		if(handler.getOption(7)->active) // Do not automatically save/load external cartridge RAM (SRAM)
 			autoLoadExtRam = false;
+		if(handler.getOption(8)->active){ // Run CPU benchmark
+			benchmarkLength = strtod(handler.getOption(8)->argument.c_str(), NULL);
+			sclk->setFramerateMultiplier(BENCHMARK_FRAMERATE_MULTIPLIER);
+		}
+		if(handler.getOption(9)->active){ // Select CPU engine
+			std::string engine = toLowercase(handler.getOption(9)->argument);
+			if(engine == "block")
+				cpu->setBlockEngine(true);
+			else if(engine == "jit"){
+				if(!cpu->setJitEngine(true)){
+					std::cout << sysWarning << "Native code generation is not supported on this host, using block engine." << std::endl;
+					cpu->setBlockEngine(true);
+				}
+			}
+			else if(engine != "interpreter")
+				std::cout << sysWarning << "Unrecognized CPU engine (" << engine << "), using interpreter." << std::endl;
+		}
+		if(handler.getOption(10)->active) // Write CPU instruction trace
+			cpu->openTraceFile(handler.getOption(10)->argument);
+		if(handler.getOption(12)->active && !setFrameSkip(handler.getOption(12)->argument)) // Set frame-skip
+			std::cout << sysWarning << "Invalid frame-skip (" << handler.getOption(12)->argument << ")." << std::endl;
+		if(handler.getOption(13)->active) // Write every Nth frame to an image
+			setFrameDumpInterval(strtoul(handler.getOption(13)->argument.c_str(), NULL, 0));
+		if(handler.getOption(14)->active) // Enable rewinding
+			setRewind(strtoul(handler.getOption(14)->argument.c_str(), NULL, 0));
+		if(handler.getOption(15)->active){ // Run CPU benchmark for a fixed number of emulated frames
+			benchmarkFrames = strtoul(handler.getOption(15)->argument.c_str(), NULL, 0);
+			sclk->setFramerateMultiplier(BENCHMARK_FRAMERATE_MULTIPLIER);
+		}
 #ifdef USE_QT_DEBUGGER			
-		if(handler.getOption(8)->active){ // Toggle debug flag
+		if(handler.getOption(16)->active){ // Toggle debug flag
 			setDebugMode(true);
-			if(handler.getOption(9)->active) // Open tile-viewer window
+			if(handler.getOption(17)->active) // Open tile-viewer window
 				useTileViewer = true;
-			if(handler.getOption(10)->active) // Open layer-viewer window
+			if(handler.getOption(18)->active) // Open layer-viewer window
 				useLayerViewer = true;
 		}
 #endif // ifdef USE_QT_DEBUGGER
@@ -342,6 +431,11 @@ void SystemGBC::initialize(){
 	gpu->initialize();
 	joy->setWindow(gpu->getWindow());
 
+	// Add all components with timed events to the scheduler
+	scheduler.add(timer.get());
+	scheduler.add(sound.get());
+	scheduler.add(sclk.get());
+
 	// Initialization was successful
 	initSuccessful = true;
 }
@@ -349,6 +443,17 @@ void SystemGBC::initialize(){
 bool SystemGBC::execute(){
 	if(!initSuccessful)
 		return false;
+	if(benchmarkFrames > 0){ // Start CPU benchmark (fixed number of frames)
+		std::cout << sysMessage << "Running CPU benchmark for " << benchmarkFrames << " frames (dispatch=" << LR35902::getDispatchMethod() << ")" << std::endl;
+		benchmarkLength = 0;
+		benchmarkInstructions = cpu->getInstructionCount();
+		benchmarkTimer.start();
+	}
+	else if(benchmarkLength > 0){ // Start CPU benchmark
+		std::cout << sysMessage << "Running CPU benchmark for " << benchmarkLength << " s (dispatch=" << LR35902::getDispatchMethod() << ")" << std::endl;
+		benchmarkInstructions = cpu->getInstructionCount();
+		benchmarkTimer.start();
+	}
 	// Run the ROM. Main loop.
 	while(true){
 		// Check the status of the GPU and LCD screen
@@ -362,37 +467,43 @@ bool SystemGBC::execute(){
 					cpuHalted = false;
 			}
 
-			// Update system timer
-			timer->onClockUpdate();
-
-			// Update sound processor
-			sound->onClockUpdate();
-
-			// Update joypad handler
-			joy->onClockUpdate();
-
-			// Tick the system sclk
-			sclk->onClockUpdate();
-#ifdef USE_QT_DEBUGGER
-			if(pauseAfterNextClock){
-				pauseAfterNextClock = false;					
-				pause();
+			if(!cpuHalted && !debugMode && !dma->getNumCyclesRemaining()){
+				// Execute whole instructions until the next scheduled event.
+				// The system clock is advanced by the CPU as instructions are executed.
+				unsigned long long nCycles = scheduler.getCyclesUntilNextEvent();
+				cpu->run(nCycles > 0 ? (nCycles < MAX_CPU_RUN_CYCLES ? (unsigned int)nCycles : MAX_CPU_RUN_CYCLES) : 1);
+			}
+			else if(cpuHalted && !debugMode){
+				// Nothing happens while the CPU is halted until an interrupt is requested by a scheduled
+				// system event, so fast-forward directly to the next event.
+				unsigned long long nCycles = scheduler.getCyclesUntilNextEvent();
+				scheduler.advance(nCycles > 0 && nCycles < MAX_CPU_RUN_CYCLES ? (unsigned int)nCycles : MAX_CPU_RUN_CYCLES);
 			}
+			else{
+				// Tick the system clock and update all components with pending events
+				// (system timer, sound processor, and LCD driver)
+				scheduler.tick();
+#ifdef USE_QT_DEBUGGER
+				if(pauseAfterNextClock){
+					pauseAfterNextClock = false;					
+					pause();
+				}
 #endif
 
-			// Check if the CPU is halted.
-			if(!cpuHalted && !dma->onClockUpdate()){
-				// Perform one instruction.
-				if(cpu->onClockUpdate()){
+				// Check if the CPU is halted.
+				if(!cpuHalted && !dma->onClockUpdate()){
+					// Perform one instruction.
+					if(cpu->onClockUpdate()){
 #ifdef USE_QT_DEBUGGER
-					if(pauseAfterNextInstruction){
-						pauseAfterNextInstruction = false;					
-						pause();
-					}
-					else if(breakpointOpcode.check(cpu->getLastOpcode()->nIndex) ||
-					   breakpointProgramCounter.check(cpu->getLastOpcode()->nPC))
-						pause();
+						if(pauseAfterNextInstruction){
+							pauseAfterNextInstruction = false;					
+							pause();
+						}
+						else if(breakpointOpcode.check(cpu->getLastOpcode()->nIndex) ||
+						   breakpointProgramCounter.check(cpu->getLastOpcode()->nPC))
+							pause();
 #endif
+					}
 				}
 			}
 
@@ -400,14 +511,29 @@ bool SystemGBC::execute(){
 			if(sclk->pollVSync()){
 				// Process window events
 				gpu->processEvents();
+				joy->onClockUpdate(); // Update joypad handler
 				checkSystemKeys();
+				if(rewindBuffer) // Take a rewind snapshot or step backwards
+					updateRewind();
 				
 				// Render the current frame
-				if(nFrames++ % frameSkip == 0 && !cpuStopped){
+				bool renderFrame = drawingFrame();
+				nFrames++;
+				if(frameDumpInterval && frameNumber % frameDumpInterval == 0) // Write the frame to an image (always drawn)
+					writeFrame(romFilename + "_frame" + uintToStr(frameNumber, 6) + ".png", true);
+				frameNumber++;
+				if(renderFrame && !cpuStopped){
 					if(displayFramerate)
 						gpu->print(doubleToStr(sclk->getFramerate(), 1)+" fps", 0, 17);
 					gpu->render();
 				}
+				if(autoFrameSkip) // Adjust frame-skip using the time spent on the previous frame
+					updateFrameSkip();
+				frameRendered = renderFrame;
+				if((benchmarkFrames > 0 && frameNumber >= benchmarkFrames) || (benchmarkLength > 0 && benchmarkTimer.stop() >= benchmarkLength)){
+					printBenchmarkResults();
+					quit();
+				}
 #ifdef USE_QT_DEBUGGER
 				if(debugMode){
 					if(!pauseAfterNextVBlank){
@@ -454,12 +580,19 @@ bool SystemGBC::execute(){
 		audioInterface->quit();
 	if(autoLoadExtRam) // Save save data (if available)
 		writeExternalRam();
+	if(rewindBuffer && verboseMode)
+		std::cout << sysMessage << "Rewind history holds " << rewindBuffer->getNumberOfStates() << " states (" << rewindBuffer->getBytesUsed() / 1024 << " kB)." << std::endl;
+	if(imageWriter){ // Finish writing all queued images
+		imageWriter->stop();
+		if(verboseMode || frameDumpInterval)
+			std::cout << sysMessage << "Wrote " << imageWriter->getImagesWritten() << " images (" << imageWriter->getImagesDropped() << " dropped)." << std::endl;
+	}
 	return true;
 }
 
 void SystemGBC::handleHBlankPeriod(){
 	if(!emulationPaused){
-		if(nFrames % frameSkip == 0){
+		if(drawingFrame()){
 			sclk->setPixelClockPause( gpu->drawNextScanline(oam.get()) );
 		}
 		dma->onHBlank();
@@ -502,6 +635,36 @@ void SystemGBC::disableInterrupts(){
 }
 
 bool SystemGBC::write(const unsigned short &loc, const unsigned char &src){
+	unsigned char *page = writePages[loc >> 8];
+	if(page){ // Directly mapped memory
+		page[loc & 0xFF] = src;
+		*writeDirty[loc >> 8] = 1; // Flag the page as modified for incremental savestates
+		if(loc >= WRAM_ZERO_START) // Code may be executed from WRAM
+			cpu->getInstructionCache()->invalidate(loc, wram->getBankSelect());
+		else if(loc < TILE_MAP_START) // VRAM tile data, decoded tiles must be updated
+			gpu->invalidateTile(loc);
+	}
+	else if(!writeMemoryHandler(loc, src))
+		return false;
+#ifdef USE_QT_DEBUGGER
+	// Check for memory access watch
+	if (loc >= memoryAccessWrite[0] && loc <= memoryAccessWrite[1]) {
+		OpcodeData* op = cpu->getLastOpcode();
+		std::cout << sysMessage << "(W) PC=" << getHex(op->nPC) << " " << getHex(src) << "->[" << getHex(loc) << "] ";
+		if (op->op->nBytes == 2)
+			std::cout << "d8=" << getHex(op->getd8());
+		else if (op->op->nBytes == 3)
+			std::cout << "d16=" << getHex(op->getd16());
+		std::cout << std::endl;
+	}
+	// Check for memory write breakpoint
+	if (breakpointMemoryWrite.check(loc))
+		pause();
+#endif // ifdef USE_QT_DEBUGGER
+	return true; // Successfully wrote to memory location (loc)
+}
+
+bool SystemGBC::writeMemoryHandler(const unsigned short &loc, const unsigned char &src){
 	// Check for system registers
 	if(loc >= REGISTER_LOW && loc < REGISTER_HIGH){
 		// Write the register
@@ -522,6 +685,7 @@ bool SystemGBC::write(const unsigned short &loc, const unsigned char &src){
 	}
 	else if(loc <= 0xFDFF){ // Work RAM (WRAM) bank 0, swap, and echo
 		wram->write(loc, src);
+		cpu->getInstructionCache()->invalidate(loc, wram->getBankSelect()); // Code may be executed from WRAM
 	}
 	else if(loc <= 0xFE9F){ // Sprite table (OAM)
 		if(bLockedOAM) // PPU is using OAM, access restricted
@@ -533,29 +697,34 @@ bool SystemGBC::write(const unsigned short &loc, const unsigned char &src){
 	}
 	else if(loc <= 0xFFFE){ // High RAM (HRAM)
 		hram->write(loc, src);
+		cpu->getInstructionCache()->invalidate(loc, 0); // Code may be executed from HRAM
 	}
 	else if(loc == 0xFFFF){ // Interrupt enable (IE)
 		rIE->write(src);
 	}
+	return true;
+}
+
+bool SystemGBC::read(const unsigned short &loc, unsigned char &dest){
+	const unsigned char *page = readPages[loc >> 8];
+	if(page) // Directly mapped memory
+		dest = page[loc & 0xFF];
+	else if(!readMemoryHandler(loc, dest))
+		return false;
 #ifdef USE_QT_DEBUGGER
+	// Check for memory read breakpoint
+	if (breakpointMemoryRead.check(loc))
+		pause();
 	// Check for memory access watch
-	if (loc >= memoryAccessWrite[0] && loc <= memoryAccessWrite[1]) {
-		OpcodeData* op = cpu->getLastOpcode();
-		std::cout << sysMessage << "(W) PC=" << getHex(op->nPC) << " " << getHex(src) << "->[" << getHex(loc) << "] ";
-		if (op->op->nBytes == 2)
-			std::cout << "d8=" << getHex(op->getd8());
-		else if (op->op->nBytes == 3)
-			std::cout << "d16=" << getHex(op->getd16());
-		std::cout << std::endl;
+	if(loc >= memoryAccessRead[0] && loc <= memoryAccessRead[1]){
+		OpcodeData *op = cpu->getLastOpcode();
+		std::cout << sysMessage << "(R) PC=" << getHex(op->nPC) << " [" << getHex(loc) << "]=" << getHex(dest) << "" << std::endl;
 	}
-	// Check for memory write breakpoint
-	if (breakpointMemoryWrite.check(loc))
-		pause();
 #endif // ifdef USE_QT_DEBUGGER
-	return true; // Successfully wrote to memory location (loc)
+	return true; // Successfully read from memory location (loc)
 }
 
-bool SystemGBC::read(const unsigned short &loc, unsigned char &dest){
+bool SystemGBC::readMemoryHandler(const unsigned short &loc, unsigned char &dest){
 	// Check for system registers
 	if(loc >= REGISTER_LOW && loc < REGISTER_HIGH){
 		// Read the register
@@ -599,17 +768,7 @@ bool SystemGBC::read(const unsigned short &loc, unsigned char &dest){
 	else if(loc == 0xFFFF){ // Interrupt enable (IE)
 		dest = rIE->read();
 	}
-#ifdef USE_QT_DEBUGGER
-	// Check for memory read breakpoint
-	if (breakpointMemoryRead.check(loc))
-		pause();
-	// Check for memory access watch
-	if(loc >= memoryAccessRead[0] && loc <= memoryAccessRead[1]){
-		OpcodeData *op = cpu->getLastOpcode();
-		std::cout << sysMessage << "(R) PC=" << getHex(op->nPC) << " [" << getHex(loc) << "]=" << getHex(dest) << "" << std::endl;
-	}
-#endif // ifdef USE_QT_DEBUGGER
-	return true; // Successfully read from memory location (loc)
+	return true;
 }
 
 unsigned char SystemGBC::getValue(const unsigned short &loc){
@@ -767,6 +926,44 @@ void SystemGBC::setQtDebugger(MainWindow* ptr){
 }
 #endif
 
+void SystemGBC::printBenchmarkResults(){
+	double elapsed = benchmarkTimer.stop();
+	unsigned long long nInstructions = cpu->getInstructionCount() - benchmarkInstructions;
+	std::cout << sysMessage << "Benchmark results (dispatch=" << LR35902::getDispatchMethod() << "):" << std::endl;
+	std::cout << sysMessage << " Elapsed time = " << elapsed << " s" << std::endl;
+	std::cout << sysMessage << " Instructions = " << nInstructions << std::endl;
+	std::cout << sysMessage << " Performance  = " << nInstructions / elapsed / 1E6 << " MIPS" << std::endl;
+	std::cout << sysMessage << " Idle cycles  = " << cpu->getIdleCycleCount() << " (skipped)" << std::endl;
+	std::cout << sysMessage << " Compositor   = " << gpu->getCompositorMethod() << std::endl;
+	std::cout << sysMessage << " Frame hash   = " << std::hex << gpu->getFrameHash() << std::dec << std::endl;
+}
+
+bool SystemGBC::setFrameSkip(const std::string &str){
+	std::string value = toLowercase(stripAllWhitespace(str));
+	if(value.compare(0, 4, "auto") == 0){ // Automatic frame-skip with optional maximum
+		value = value.substr(4);
+		if(!value.empty()){
+			if(!isInteger(value) || value.length() > 2 || std::stoi(value) < 1)
+				return false;
+			frameSkipper.setMaximum((unsigned short)std::stoi(value));
+		}
+		setAutoFrameSkip(true);
+		return true;
+	}
+	if(value.empty() || !isInteger(value) || value.length() > 2 || std::stoi(value) < 1)
+		return false;
+	setFrameSkip((unsigned short)std::stoi(value));
+	return true;
+}
+
+void SystemGBC::setAutoFrameSkip(bool state/*=true*/){
+	autoFrameSkip = state;
+	if(autoFrameSkip)
+		frameSkipper.reset(frameSkip);
+	if(verboseMode)
+		std::cout << sysMessage << "Automatic frame-skip " << (autoFrameSkip ? "enabled" : "disabled") << std::endl;
+}
+
 void SystemGBC::setFramerateMultiplier(const float& freq){
 	sclk->setFramerateMultiplier(freq);
 	sound->getMixer()->setSampleRateMultiplier(freq);
@@ -793,6 +990,10 @@ void SystemGBC::addSystemRegister(SystemComponent *comp, const unsigned char &re
 	registers[reg].setMasks(bits);
 	registers[reg].setAddress(0xFF00+reg);
 	registers[reg].setSystemComponent(comp);
+	registerHandlers[reg] = RegisterHandler();
+	registerHandlers[reg].comp = comp;
+	if(comp != &dummyComponent) // System registers require no action
+		registerHandlers[reg].write = writeRegisterVirtual;
 	ptr = &registers[reg];
 }
 
@@ -802,6 +1003,10 @@ void SystemGBC::addSystemRegister(const unsigned char &reg, Register* &ptr, cons
 
 void SystemGBC::addDummyRegister(SystemComponent *comp, const unsigned char &reg){
 	registers[reg].setSystemComponent(comp);
+	registerHandlers[reg] = RegisterHandler();
+	registerHandlers[reg].comp = comp;
+	if(comp)
+		registerHandlers[reg].write = writeRegisterVirtual;
 }
 
 void SystemGBC::clearRegister(const unsigned char &reg){ 
@@ -857,7 +1062,17 @@ bool SystemGBC::saveSRAM(const std::string &fname){
 		return false;
 	}
 	std::ofstream ofile(fname.c_str(), std::ios::binary);
-	if(!ofile.good() || !cart->getRam()->writeMemoryToFile(ofile)){
+	bool retval = ofile.good();
+	if(retval && compressExtRam){ // Write compressed cartridge RAM
+		SystemComponent *sram = cart->getRam();
+		std::vector<unsigned char> packed;
+		Lz4Codec codec;
+		codec.compress(sram->getPtrToBank(0), sram->getSize(), packed);
+		ofile.write((char*)packed.data(), packed.size());
+	}
+	else if(retval)
+		retval = (cart->getRam()->writeMemoryToFile(ofile) > 0);
+	if(!retval || !ofile.good()){
 		if(verboseMode)
 			std::cout << sysMessage << "Writing cartridge RAM to file \"" << fname << "\"... FAILED!" << std::endl;
 		return false;
@@ -875,12 +1090,25 @@ bool SystemGBC::loadSRAM(const std::string &fname){
 		return false;
 	}
 	std::ifstream ifile(fname.c_str(), std::ios::binary);
-	if(!ifile.good() || !cart->getRam()->readMemoryFromFile(ifile)){
+	std::vector<unsigned char> data;
+	if(ifile.good()){ // Read the entire file at once
+		ifile.seekg(0, ifile.end);
+		data.resize((size_t)ifile.tellg());
+		ifile.seekg(0);
+		ifile.read((char*)data.data(), data.size());
+		ifile.close();
+	}
+	bool retval = !data.empty();
+	if(retval && Lz4Codec::isCompressed(data.data(), data.size())){ // Compressed cartridge RAM
+		std::vector<unsigned char> unpacked;
+		retval = Lz4Codec::decompress(data.data(), data.size(), unpacked);
+		data.swap(unpacked);
+	}
+	if(!retval || !cart->getRam()->readMemory(data.data(), data.size())){
 		if(verboseMode)
 			std::cout << sysMessage << "Reading cartridge RAM from file \"" << fname << "\"... FAILED!" << std::endl;
 		return false;
 	}
-	ifile.close();
 	if(verboseMode)
 		std::cout << sysMessage << "Reading cartridge RAM from file \"" << fname << "\"... DONE!" << std::endl;
 	return true;
@@ -888,6 +1116,7 @@ bool SystemGBC::loadSRAM(const std::string &fname){
 
 void SystemGBC::resumeCPU(){ 
 	cpuStopped = false;
+	scheduler.sync();
 	if(rKEY1->getBit(0)){ // Prepare speed switch
 		if(!bCPUSPEED){ // Normal speed
 			sclk->setDoubleSpeedMode();
@@ -902,6 +1131,7 @@ void SystemGBC::resumeCPU(){
 			bCPUSPEED = false;
 			rKEY1->clear();
 		}
+		scheduler.reschedule(); // System clock counters were reset
 	}
 }
 
@@ -914,6 +1144,7 @@ void SystemGBC::updateDebugger(){
 
 void SystemGBC::pause(){ 
 	emulationPaused = true; 
+	scheduler.sync(); // Bring all components up to date
 #ifdef USE_QT_DEBUGGER
 	if(debugMode){
 		gui->updatePausedState(true);
@@ -1050,12 +1281,40 @@ bool SystemGBC::reset() {
 		bootSequence = false;
 	}
 
+	// Cartridge memory and boot ROM state have changed, rebuild the memory page table
+	updateMemoryPages(0x0000, 0xFFFF);
+
+	// Register values may have changed, update all pending events
+	scheduler.reschedule();
+
 	return true;
 }
 
 bool SystemGBC::screenshot(){
-	std::cout << sysMessage << "Not implemented" << std::endl;
-	return false;
+	std::string fname;
+	while(true){ // Find the first unused screenshot filename
+		fname = romFilename + "_" + uintToStr(screenshotIndex++, 4) + ".png";
+		std::ifstream ifile(fname.c_str());
+		if(!ifile.good())
+			break;
+	}
+	if(!writeFrame(fname, false)){
+		std::cout << sysWarning << "Image writer is busy, screenshot dropped." << std::endl;
+		return false;
+	}
+	std::cout << sysMessage << "Queued screenshot \"" << fname << "\" (written in the background)." << std::endl;
+	return true;
+}
+
+void SystemGBC::setRewind(const unsigned int &interval, const size_t &capacity/*=0x800000*/){
+	rewindInterval = interval;
+	if(rewindInterval){
+		rewindBuffer.reset(new RewindBuffer(capacity));
+		if(verboseMode)
+			std::cout << sysMessage << "Rewind enabled, snapshot every " << rewindInterval << " frames (" << capacity / 1024 << " kB history)" << std::endl;
+	}
+	else
+		rewindBuffer.reset();
 }
 
 bool SystemGBC::quicksave(const std::string& fname/*=""*/){
@@ -1070,107 +1329,207 @@ bool SystemGBC::quicksave(const std::string& fname/*=""*/){
 		return false;
 	}
 
-	unsigned int nBytesWritten = 0;
+	std::vector<unsigned char> state;
+	std::vector<unsigned char> packed;
+	Lz4Codec codec;
+	size_t nBytesWritten = saveState(state);
+	size_t nBytesPacked = codec.compress(state.data(), nBytesWritten, packed);
+	ofile.write((char*)packed.data(), nBytesPacked);
+	ofile.close();
+	std::cout << "DONE! Wrote " << nBytesPacked << " B (" << nBytesWritten << " B uncompressed)" << std::endl;
 	
-	unsigned char nVersion = SAVESTATE_VERSION;
+	return true;
+}
+
+bool SystemGBC::quickload(const std::string& fname/*=""*/){
+	std::cout << sysMessage << "Loading quicksave... ";
+	std::ifstream ifile;
+	if(fname.empty())
+		ifile.open((romFilename+".sav").c_str(), std::ios::binary);
+	else
+		ifile.open(fname.c_str(), std::ios::binary);
+	if(!ifile.good()){
+		std::cout << "FAILED!" << std::endl;
+		return false;
+	}
+
+	// Read the entire savestate at once
+	ifile.seekg(0, ifile.end);
+	std::vector<unsigned char> state((size_t)ifile.tellg());
+	ifile.seekg(0);
+	ifile.read((char*)state.data(), state.size());
+	ifile.close();
+
+	// Quicksaves are normally compressed, uncompressed savestates are also accepted
+	if(Lz4Codec::isCompressed(state.data(), state.size())){
+		std::vector<unsigned char> unpacked;
+		if(!Lz4Codec::decompress(state.data(), state.size(), unpacked)){
+			std::cout << "FAILED! Savestate is corrupt" << std::endl;
+			return false;
+		}
+		state.swap(unpacked);
+	}
+	
+	if(!loadState(state.data(), state.size())){
+		std::cout << "FAILED!" << std::endl;
+		return false;
+	}
+	std::cout << "DONE! Read " << state.size() << " B" << std::endl;
+
+	return true;
+}
+
+size_t SystemGBC::getSavestateSize() const {
+	size_t nBytesTotal = SAVESTATE_HEADER_LENGTH; // System header
+	nBytesTotal += SAVESTATE_CHUNK_HEADER_LENGTH + SYSTEM_CHUNK_LENGTH;
+	if(cart->hasRam())
+		nBytesTotal += cart->getRam()->getSavestateSize();
+	for(auto comp = subsystems->list.cbegin(); comp != subsystems->list.cend(); comp++)
+		nBytesTotal += comp->second->getSavestateSize();
+	nBytesTotal += SAVESTATE_CHUNK_HEADER_LENGTH + registers.size();
+	return nBytesTotal;
+}
+
+size_t SystemGBC::saveState(std::vector<unsigned char> &state, bool incremental/*=false*/){
+	// Bring all components up to date before writing their state
+	scheduler.sync();
+	cpu->evaluateFlags(); // Pending CPU flags must be written to the flags register
+
+	if(state.size() != getSavestateSize()){ // Buffer does not contain a previous state, write everything
+		state.resize(getSavestateSize()); // Does not re-allocate when an existing buffer is reused
+		incremental = false;
+	}
+	unsigned char *dest = state.data();
+	size_t nBytesWritten = 0;
+
+	// Write the savestate header and cartridge title
+	nBytesWritten += SavestateReader::writeHeader(dest, SAVESTATE_VERSION, cart->getRawTitleString());
+
+	// Write system flags
 	unsigned char nFlags = 0;
-	bool cartRam = cart->hasRam();
 	if(bGBCMODE) // CGB mode flag
 		bitSet(nFlags, 0);
 	if(cpuStopped) // STOP flag
 		bitSet(nFlags, 1);
 	if(cpuHalted) // HALT flag
 		bitSet(nFlags, 2);
-	if(cartRam) // Internal cartridge RAM flag
-		bitSet(nFlags, 3);
-
-	// Write the cartridge title and system flags
-	ofile.write((char*)&nFlags, 1); // System flags
-	ofile.write((char*)&nVersion, 1); // Savestate version number
-	ofile.write(cart->getRawTitleString(), 12);
-	ofile.write((char*)rIE->getConstPtr(), 1); // Interrupt enable
-	ofile.write((char*)rIME->getConstPtr(), 1); // Master interrupt enable
-	nBytesWritten += 16;
+	nBytesWritten += SavestateChunk::writeHeader(&dest[nBytesWritten], SYSTEM_CHUNK_ID, SYSTEM_CHUNK_VERSION, SYSTEM_CHUNK_LENGTH);
+	dest[nBytesWritten++] = nFlags; // System flags
+	dest[nBytesWritten++] = rIE->getValue(); // Interrupt enable
+	dest[nBytesWritten++] = rIME->getValue(); // Master interrupt enable
 
 	// Write cartridge RAM (if enabled)
-	if(cartRam)
-		nBytesWritten += cart->getRam()->writeSavestate(ofile);
+	if(cart->hasRam())
+		nBytesWritten += cart->getRam()->writeSavestate(&dest[nBytesWritten], incremental);
 
 	// Write state of all system components
 	for(auto comp = subsystems->list.cbegin(); comp != subsystems->list.cend(); comp++){
-		nBytesWritten += comp->second->writeSavestate(ofile);
+		nBytesWritten += comp->second->writeSavestate(&dest[nBytesWritten], incremental);
 	}
 	
 	// Write system registers
+	nBytesWritten += SavestateChunk::writeHeader(&dest[nBytesWritten], REGISTER_CHUNK_ID, REGISTER_CHUNK_VERSION, registers.size());
 	for(std::vector<Register>::const_iterator reg = registers.cbegin(); reg != registers.cend(); reg++){
-		ofile.write((char*)reg->getConstPtr(), 1);
-		nBytesWritten++;
+		dest[nBytesWritten++] = reg->getValue();
 	}
-		
-	ofile.close();
-	std::cout << "DONE! Wrote " << nBytesWritten << " B" << std::endl;
-	
-	return true;
+
+	return nBytesWritten;
 }
 
-bool SystemGBC::quickload(const std::string& fname/*=""*/){
-	std::cout << sysMessage << "Loading quicksave... ";
-	std::ifstream ifile;
-	if(fname.empty())
-		ifile.open((romFilename+".sav").c_str(), std::ios::binary);
-	else
-		ifile.open(fname.c_str(), std::ios::binary);
-	if(!ifile.good()){
-		std::cout << "FAILED!" << std::endl;
+bool SystemGBC::loadState(const unsigned char *state, const size_t &length){
+	// Index all chunks in the savestate (payloads are read in place)
+	SavestateReader reader;
+	if(!reader.open(state, length)){
+		if(!reader.getTitle())
+			std::cout << sysWarning << "Input is not a savestate or was written by an older version" << std::endl;
+		else
+			std::cout << sysWarning << "Savestate is truncated" << std::endl;
 		return false;
 	}
 	
-	unsigned int nBytesRead = 0;
-
-	char readTitle[12];
-	unsigned char nVersion;
-	unsigned char nFlags;
-
-	// Read the cartridge title and system flags
-	ifile.read((char*)&nFlags, 1); // System flags
-	ifile.read((char*)&nVersion, 1); // Savestate version number
-	ifile.read(readTitle, 12);
-	ifile.read((char*)rIE->getConstPtr(), 1); // Interrupt enable
-	ifile.read((char*)rIME->getConstPtr(), 1); // Master interrupt enable
-	nBytesRead += 16;
-	
 	// Check incoming savestate version
-	if(nVersion != SAVESTATE_VERSION){
-		std::cout << sysWarning << "Unexpected savestate version number (" << getHex(nVersion) << " != " << getHex(SAVESTATE_VERSION) << ")" << std::endl;
+	if(reader.getVersion() != SAVESTATE_VERSION){
+		std::cout << sysWarning << "Unsupported savestate version number (" << getHex(reader.getVersion()) << " != " << getHex(SAVESTATE_VERSION) << ")" << std::endl;
+		return false;
 	}
-	
-	bGBCMODE = bitTest(nFlags, 0); // CGB mode flag
-	cpuStopped = bitTest(nFlags, 1); // STOP flag
-	cpuHalted = bitTest(nFlags, 2); // HALT flag
-	bool cartRam = bitTest(nFlags, 3); // Savestate contains internal cartridge RAM
-	
+
 	// Check the title against the title of the loaded ROM
-	if(strcmp(readTitle, cart->getRawTitleString()) != 0){
+	if(memcmp(reader.getTitle(), cart->getRawTitleString(), 12) != 0){
 		std::cout << sysWarning << "ROM title of quicksave does not match loaded ROM!" << std::endl;
 	}
 
+	// Find and check every chunk before touching any component
+	bool chunksValid = true;
+	const SavestateChunk *systemChunk = reader.find(SYSTEM_CHUNK_ID);
+	if(!systemChunk || systemChunk->version != SYSTEM_CHUNK_VERSION || systemChunk->length != SYSTEM_CHUNK_LENGTH){
+		std::cout << sysWarning << "Savestate system chunk is missing or does not match" << std::endl;
+		chunksValid = false;
+	}
+	const SavestateChunk *registerChunk = reader.find(REGISTER_CHUNK_ID);
+	if(!registerChunk || registerChunk->version != REGISTER_CHUNK_VERSION || registerChunk->length != registers.size()){
+		std::cout << sysWarning << "Savestate register chunk is missing or does not match" << std::endl;
+		chunksValid = false;
+	}
+	SystemComponent *sram = (cart->hasRam() ? cart->getRam() : 0x0);
+	if(sram && !sram->checkSavestate(reader.find(sram->getComponentID())))
+		chunksValid = false;
+	for(auto comp = subsystems->list.cbegin(); comp != subsystems->list.cend(); comp++){
+		if(!comp->second->checkSavestate(reader.find(comp->second->getComponentID())))
+			chunksValid = false;
+	}
+	if(!chunksValid)
+		return false;
+
+	// Chunks which do not belong to any component are skipped
+	if(verboseMode){
+		for(auto chunk = reader.getChunks().cbegin(); chunk != reader.getChunks().cend(); chunk++){
+			bool known = (chunk->id == SYSTEM_CHUNK_ID || chunk->id == REGISTER_CHUNK_ID || (sram && chunk->id == sram->getComponentID()));
+			for(auto comp = subsystems->list.cbegin(); !known && comp != subsystems->list.cend(); comp++)
+				known = (chunk->id == comp->second->getComponentID());
+			if(!known)
+				std::cout << sysMessage << "Skipping unknown savestate chunk \"" << chunk->getName() << "\" (" << chunk->length << " B)" << std::endl;
+		}
+	}
+
+	// Bring all components up to date before overwriting their state
+	scheduler.sync();
+	cpu->evaluateFlags(); // Pending CPU flags must be written to the flags register
+
+	// Read system flags
+	unsigned char nFlags = systemChunk->payload[0]; // System flags
+	rIE->setValue(systemChunk->payload[1]); // Interrupt enable
+	rIME->setValue(systemChunk->payload[2]); // Master interrupt enable
+	bGBCMODE = bitTest(nFlags, 0); // CGB mode flag
+	cpuStopped = bitTest(nFlags, 1); // STOP flag
+	cpuHalted = bitTest(nFlags, 2); // HALT flag
+
 	// Copy cartridge RAM (if enabled)
-	if(cartRam)
-		nBytesRead += cart->getRam()->readSavestate(ifile);
+	if(sram)
+		sram->readSavestate(*reader.find(sram->getComponentID()));
 
 	// Copy state of all system components
 	for(auto comp = subsystems->list.cbegin(); comp != subsystems->list.cend(); comp++){
-		nBytesRead += comp->second->readSavestate(ifile);
+		comp->second->readSavestate(*reader.find(comp->second->getComponentID()));
 	}
 
 	// Copy system registers
+	const unsigned char *src = registerChunk->payload;
 	for(std::vector<Register>::iterator reg = registers.begin(); reg != registers.end(); reg++){
-		ifile.read((char*)reg->getPtr(), 1);
-		nBytesRead++;
+		reg->setValue(*src++);
 	}
-		
-	ifile.close();
-	std::cout << "DONE! Read " << nBytesRead << " B" << std::endl;
+
+	// Memory contents have changed, flush all decoded instructions and restart idle loop detection
+	cpu->getInstructionCache()->clear();
+	cpu->resetIdleLoop();
+	gpu->invalidateTileCache();
+	gpu->refreshPalettes();
+	gpu->invalidateSpriteIndex();
+
+	// Memory bank selects may have changed, rebuild the memory page table
+	updateMemoryPages(0x0000, 0xFFFF);
+
+	// Component states have changed, update all pending events
+	scheduler.reschedule();
 
 	return true;
 }
@@ -1207,22 +1566,32 @@ void SystemGBC::help(){
 	std::cout << "  F8 : Save cart SRAM to \"sram.dat\"" << std::endl;
 	std::cout << "  F9 : Quickload state" << std::endl;
 	std::cout << "  F10: Start/stop midi recording" << std::endl;
+	std::cout << "  F11: Toggle automatic frame-skip" << std::endl;
 	std::cout << "  F12: Take screenshot" << std::endl;
 	std::cout << "   ` : Open interpreter console" << std::endl;
 	std::cout << "   - : Decrease volume" << std::endl;
 	std::cout << "   + : Increase volume" << std::endl;
 	std::cout << "   f : Show/hide FPS counter on screen" << std::endl;
 	std::cout << "   m : Mute output audio" << std::endl;
+	std::cout << "  BS : Rewind (hold, if enabled)" << std::endl;
+}
+
+bool SystemGBC::pressKey(const unsigned char &key){
+	return gpu->injectKeyEvent(KeyEvent(key, true));
+}
+
+bool SystemGBC::releaseKey(const unsigned char &key){
+	return gpu->injectKeyEvent(KeyEvent(key, false));
 }
 
 void SystemGBC::openDebugConsole(){
-	gpu->getWindow()->setKeyboardStreamMode();
+	gpu->setKeyboardStreamMode();
 	consoleIsOpen = true;
 	pause();
 }
 
 void SystemGBC::closeDebugConsole(){
-	gpu->getWindow()->setKeyboardToggleMode();
+	gpu->setKeyboardToggleMode();
 	consoleIsOpen = false;
 	unpause();
 }
@@ -1248,19 +1617,78 @@ void SystemGBC::resumeUntilNextVBlank(){
 }
 
 void SystemGBC::lockMemory(bool lockVRAM, bool lockOAM){
+	bool remapVRAM = (lockVRAM != bLockedVRAM);
 	bLockedVRAM = lockVRAM;
 	bLockedOAM = lockOAM;
+	if(remapVRAM) // Locked VRAM must be accessed through the memory handler
+		updateMemoryPages(VRAM_SWAP_START, CART_RAM_START-1);
+}
+
+void SystemGBC::updateMemoryPages(const unsigned short &locL, const unsigned short &locH){
+	for(unsigned short page = (locL >> 8); page <= (locH >> 8); page++)
+		mapMemoryPage(page, readPages[page], writePages[page], writeDirty[page]);
+}
+
+void SystemGBC::mapMemoryPage(const unsigned short &page, unsigned char* &readPtr, unsigned char* &writePtr, unsigned char* &dirtyPtr){
+	unsigned short loc = page << 8;
+	readPtr = 0x0;
+	writePtr = 0x0; // Writes to ROM are MBC register writes
+	dirtyPtr = 0x0;
+	if(loc < 0x4000){ // Cartridge ROM bank 0
+		if(!bootSequence || (loc >= 0x100 && loc < 0x200)) // Boot ROM is overlaid on ROM bank 0
+			readPtr = cart->getPtrToBank(0);
+		if(readPtr)
+			readPtr += loc;
+	}
+	else if(loc < VRAM_SWAP_START){ // Cartridge ROM swap bank
+		readPtr = cart->getPtrToBank(cart->getBankSelect());
+		if(readPtr)
+			readPtr += loc - 0x4000;
+	}
+	else if(loc < CART_RAM_START){ // Video RAM (VRAM)
+		if(!bLockedVRAM){ // PPU is using VRAM, access restricted
+			readPtr = writePtr = gpu->getPtr(loc);
+			dirtyPtr = gpu->getDirtyFlagToBank(gpu->getBankSelect(), loc - VRAM_SWAP_START);
+		}
+	}
+	else if(loc < WRAM_ZERO_START){ // External RAM (SRAM)
+		SystemComponent *sram = cart->getRam();
+		if(cart->hasRam() && (loc - CART_RAM_START) < sram->getBankSize()){ // Unmapped SRAM is handled separately
+			readPtr = writePtr = sram->getPtrToBank(sram->getBankSelect());
+			if(readPtr){
+				readPtr = writePtr = readPtr + (loc - CART_RAM_START);
+				dirtyPtr = sram->getDirtyFlagToBank(sram->getBankSelect(), loc - CART_RAM_START);
+			}
+		}
+	}
+	else if(loc < OAM_TABLE_START){ // Work RAM (WRAM) bank 0, swap, and echo
+		unsigned short addr = (loc >= WRAM_ECHO_START ? loc - 0x2000 : loc); // Echo of bank 0 and swap bank
+		if(addr < WRAM_SWAP_START){ // Bank 0
+			readPtr = wram->getPtrToBank(0) + (addr - WRAM_ZERO_START);
+			dirtyPtr = wram->getDirtyFlagToBank(0, addr - WRAM_ZERO_START);
+		}
+		else{ // Bank 1-7
+			readPtr = wram->getPtrToBank(wram->getBankSelect()) + (addr - WRAM_SWAP_START);
+			dirtyPtr = wram->getDirtyFlagToBank(wram->getBankSelect(), addr - WRAM_SWAP_START);
+		}
+		writePtr = readPtr;
+	}
+	// OAM, system registers, and HRAM are always accessed through the memory handler
 }
 
 bool SystemGBC::writeRegister(const unsigned short &reg, const unsigned char &val){
 	if(reg < REGISTER_LOW || reg > REGISTER_HIGH)
 		return false;
+	scheduler.sync(); // Bring all components up to date before modifying their state
 	Register *ptr = &registers[reg - REGISTER_LOW];
-	if(ptr->getSystemComponent()){ // Registers with an associated system component
-		if(!ptr->getSystemComponent()->checkRegister(reg))
+	const RegisterHandler &handler = registerHandlers[reg - REGISTER_LOW];
+	if(handler.comp){ // Registers with an associated system component
+		if(handler.check && !handler.check(handler.comp, reg))
 			return false;
 		ptr->write(val); // Write the new register value.
-		ptr->getSystemComponent()->writeRegister(reg, val);
+		if(handler.write)
+			handler.write(handler.comp, reg, val);
+		scheduler.reschedule(); // Component state may have changed
 	}
 	else{ // Registers with no associated system component
 		ptr->write(val); // Write the new register value.
@@ -1271,6 +1699,7 @@ bool SystemGBC::writeRegister(const unsigned short &reg, const unsigned char &va
 				break;
 			case 0xFF50: // Enable/disable ROM boot sequence
 				bootSequence = false;
+				updateMemoryPages(0x0000, 0x3FFF); // Unmap the boot ROM
 				if(forceColor) // Disable GBC mode so that original GB games display correctly after boot.
 					bGBCMODE = false;
 				break;
@@ -1286,10 +1715,13 @@ bool SystemGBC::writeRegister(const unsigned short &reg, const unsigned char &va
 bool SystemGBC::readRegister(const unsigned short &reg, unsigned char &val){
 	if(reg < REGISTER_LOW || reg > REGISTER_HIGH)
 		return false;
+	scheduler.sync(); // Bring all components up to date before reading their state
 	Register *ptr = &registers[reg - REGISTER_LOW];
+	const RegisterHandler &handler = registerHandlers[reg - REGISTER_LOW];
 	val = ptr->read();
-	if(ptr->getSystemComponent()){ // Registers with an associated system component
-		ptr->getSystemComponent()->readRegister(reg, val);	
+	if(handler.comp){ // Registers with an associated system component
+		if(handler.read)
+			handler.read(handler.comp, reg, val);
 	}
 	else{ // Registers with no associated system component
 		switch(reg){
@@ -1306,6 +1738,39 @@ bool SystemGBC::readRegister(const unsigned short &reg, unsigned char &val){
 	return true; // Read register
 }
 
+bool SystemGBC::drawingFrame() const {
+	return (nFrames % frameSkip == 0 || (frameDumpInterval && frameNumber % frameDumpInterval == 0));
+}
+
+void SystemGBC::updateFrameSkip(){
+	unsigned short newFrameSkip = frameSkipper.update(sclk->getFrameWorkTime(), sclk->getFramePeriod(), frameRendered);
+	if(newFrameSkip != frameSkip){
+		if(verboseMode){
+			std::cout << sysMessage << "Frame-skip changed from " << frameSkip << " to " << newFrameSkip << " (load=" 
+			          << doubleToStr(frameSkipper.getRenderedLoad(), 2) << "/" << doubleToStr(frameSkipper.getSkippedLoad(), 2) << ")" << std::endl;
+		}
+		frameSkip = newFrameSkip;
+	}
+}
+
+bool SystemGBC::writeFrame(const std::string &fname, bool wait){
+	if(!imageWriter)
+		imageWriter.reset(new ImageWriter);
+	Window *win = gpu->getWindow();
+	return imageWriter->write(fname, gpu->getFramebuffer(), win->getWidth(), win->getHeight(), wait);
+}
+
+void SystemGBC::updateRewind(){
+	if(gpu->getWindow()->getKeypress()->check(0x08)){ // Backspace held, restore the previous snapshot
+		if(rewindBuffer->pop(rewindState))
+			loadState(rewindState.data(), rewindState.size());
+	}
+	else if(frameNumber % rewindInterval == 0){ // Take a new snapshot
+		saveState(rewindState, true); // Only pages modified since the previous snapshot are copied
+		rewindBuffer->push(rewindState);
+	}
+}
+
 void SystemGBC::checkSystemKeys(){
 	KeyStates *keys = gpu->getWindow()->getKeypress();
 	if(keys->empty()) 
@@ -1322,9 +1787,9 @@ void SystemGBC::checkSystemKeys(){
 	else if (keys->poll(0xF5)) // F5  Quicksave
 		quicksave();
 	else if (keys->poll(0xF6)) // F6  Decrease frame-skip (slower)
-		frameSkip = (frameSkip > 1 ? frameSkip-1 : 1);
+		setFrameSkip(frameSkip-1);
 	else if (keys->poll(0xF7)) // F7  Increase freme-skip (faster)
-		frameSkip++;
+		setFrameSkip(frameSkip+1);
 	else if (keys->poll(0xF8)) // F8  Save cartridge RAM to file
 		writeExternalRam();
 	else if (keys->poll(0xF9)) // F9  Quickload
@@ -1339,8 +1804,8 @@ void SystemGBC::checkSystemKeys(){
 			sound->startMidiFile("out.mid");
 		}
 	}
-	else if (keys->poll(0xFB)) // F11 (No function)
-		return;
+	else if (keys->poll(0xFB)) // F11 Toggle automatic frame-skip
+		setAutoFrameSkip(!autoFrameSkip);
 	else if (keys->poll(0xFC)) // F12 Screenshot
 		screenshot();
 	else if (keys->poll(0x2D)) // '-'    Decrease volume
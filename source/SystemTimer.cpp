@@ -89,6 +89,29 @@ bool SystemTimer::onClockUpdate(){
 	return true;
 }
 
+bool SystemTimer::onClockAdvance(const unsigned int &nCycles){
+	if(!bEnabled) return false;
+	unsigned int nDivider = nDividerCycles + nCycles; // DIV incremented once every 65 ticks (see onClockUpdate)
+	rDIV->setValue(rDIV->getValue() + nDivider / 65);
+	nDividerCycles = nDivider % 65;
+	unsigned int nTicks = nCyclesSinceLastTick + nCycles;
+	while(nTicks >= nPeriod){ // Handle all timer ticks.
+		if(++(*rTIMA) == 0x0) // Timer counter has rolled over
+			rollover();
+		nTicks -= nPeriod;
+	}
+	nCyclesSinceLastTick = nTicks;
+	return true;
+}
+
+unsigned int SystemTimer::getCyclesUntilNextEvent(){
+	if(!bEnabled || nPeriod == 0) // No timer interrupts while disabled
+		return 0;
+	unsigned int nTicksToOverflow = 0x100 - rTIMA->getValue();
+	unsigned int nCycles = nTicksToOverflow * nPeriod;
+	return (nCycles > nCyclesSinceLastTick ? nCycles - nCyclesSinceLastTick : 1);
+}
+
 void SystemTimer::rollover(){
 	rTIMA->setValue(rTMA->getValue());
 	sys->handleTimerInterrupt();
@@ -99,6 +122,12 @@ void SystemTimer::defineRegisters(){
 	sys->addSystemRegister(this, 0x05, rTIMA, "TIMA", "33333333");
 	sys->addSystemRegister(this, 0x06, rTMA , "TMA" , "33333333");
 	sys->addSystemRegister(this, 0x07, rTAC , "TAC" , "33300000");
+
+	// Only writes to DIV and TAC require action (TIMA and TMA are read when the timer is next clocked)
+	sys->setRegisterWriteHandler(0x04, writeComponentRegister<SystemTimer>);
+	sys->setRegisterWriteHandler(0x05, 0x0);
+	sys->setRegisterWriteHandler(0x06, 0x0);
+	sys->setRegisterWriteHandler(0x07, writeComponentRegister<SystemTimer>);
 }
 
 void SystemTimer::userAddSavestateValues(){
@@ -0,0 +1,31 @@
+#include "TileCache.hpp"
+
+TileCache::TileCache() :
+	dirty(),
+	pixels()
+{
+	clear();
+}
+
+void TileCache::clear(){
+	for(unsigned short bank = 0; bank < TILE_CACHE_BANKS; bank++){
+		for(unsigned short tile = 0; tile < TILE_CACHE_TILES; tile++)
+			dirty[bank][tile] = true;
+	}
+}
+
+void TileCache::decode(const unsigned char *vram, const unsigned short &tile, const unsigned char &bank){
+	const unsigned char *bitmap = &vram[16 * tile];
+	unsigned char *normal = pixels[bank][0][tile];
+	unsigned char *flipped = pixels[bank][1][tile];
+	for(unsigned short dy = 0; dy < 8; dy++){
+		const unsigned char low = bitmap[2 * dy]; // LS bits of the row colors
+		const unsigned char high = bitmap[2 * dy + 1]; // MS bits of the row colors
+		for(unsigned short dx = 0; dx < 8; dx++){ // Bit 7 is the left-most pixel
+			unsigned char color = ((low >> dx) & 0x1) + (((high >> dx) & 0x1) << 1);
+			normal[8 * dy + (7 - dx)] = color;
+			flipped[8 * dy + dx] = color;
+		}
+	}
+	dirty[bank][tile] = false;
+}
@@ -78,6 +78,7 @@ bool WorkRam::writeRegister(const unsigned short &reg, const unsigned char &val)
 	if(wramBank == 0x0) 
 		wramBank = 0x1; // Select bank 1 instead
 	setBank(wramBank);
+	sys->updateMemoryPages(WRAM_SWAP_LOW, WRAM_ECHO_HIGH-1); // Swap bank and its echo
 	return true;
 }
 
@@ -89,4 +90,5 @@ bool WorkRam::readRegister(const unsigned short &reg, unsigned char &dest){
 
 void WorkRam::defineRegisters(){
 	sys->addSystemRegister(this, 0x70, rSVBK, "SVBK", "33300000");
+	sys->setRegisterWriteHandler(0x70, writeComponentRegister<WorkRam>);
 }
@@ -0,0 +1,47 @@
+#!/bin/sh
+#
+# Run a ROM for a fixed number of emulated frames with the CPU interpreter, the block engine, and
+# the native code (jit) engine, and check that all engines execute exactly the same instructions
+# with the same register values and produce the same final frame.
+#
+# Usage: compare-engines.sh <gbc> <rom> [frames=120]
+
+if [ $# -lt 2 ]; then
+	echo " Usage: $0 <gbc> <rom> [frames=120]"
+	exit 2
+fi
+
+GBC=$1
+ROM=$2
+FRAMES=${3:-120}
+
+WORKDIR=$(mktemp -d) || exit 2
+trap 'rm -rf "$WORKDIR"' EXIT
+
+for ENGINE in interpreter block jit; do
+	# SRAM is not loaded or saved, so that both runs start from the same state
+	if ! "$GBC" -i "$ROM" --headless --no-load-sram --benchmark-frames "$FRAMES" --cpu-engine $ENGINE --trace "$WORKDIR/$ENGINE.trace" > "$WORKDIR/$ENGINE.log" 2>&1; then
+		echo " Error! Failed to run $ROM with the $ENGINE engine."
+		cat "$WORKDIR/$ENGINE.log"
+		exit 2
+	fi
+	grep "Frame hash" "$WORKDIR/$ENGINE.log" > "$WORKDIR/$ENGINE.hash"
+done
+
+STATUS=0
+for ENGINE in block jit; do
+	if ! cmp -s "$WORKDIR/interpreter.trace" "$WORKDIR/$ENGINE.trace"; then
+		echo " Instruction traces differ (< interpreter, > $ENGINE):"
+		diff "$WORKDIR/interpreter.trace" "$WORKDIR/$ENGINE.trace" | head -n 20
+		STATUS=1
+	fi
+	if ! cmp -s "$WORKDIR/interpreter.hash" "$WORKDIR/$ENGINE.hash" || [ ! -s "$WORKDIR/interpreter.hash" ]; then
+		echo " Frame hashes differ (interpreter, $ENGINE):"
+		cat "$WORKDIR/interpreter.hash" "$WORKDIR/$ENGINE.hash"
+		STATUS=1
+	fi
+done
+if [ $STATUS -eq 0 ]; then
+	echo " Engines match after $FRAMES frames ($(wc -l < "$WORKDIR/interpreter.trace") instructions)."
+fi
+exit $STATUS
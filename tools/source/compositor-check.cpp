@@ -0,0 +1,101 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstring>
+#include <cstdlib>
+
+#include "ScanlineCompositor.hpp"
+
+const unsigned int DEFAULT_SCANLINES = 100000; ///< Default number of random scanlines to compare
+
+const unsigned int PRINT_LIMIT = 10; ///< Maximum number of mismatched scanlines to print
+
+/** Fill a layer scanline with random pixels
+  */
+void randomize(LayerLine &line, std::mt19937 &rng, bool sprites){
+	for(unsigned short x = 0; x < LAYER_LINE_WIDTH; x++){
+		unsigned int bits = rng();
+		unsigned char color = bits & 0x3;
+		unsigned char pal = (bits >> 2) & 0xF; // 16 palettes of 4 colors
+		bool prio = ((bits >> 6) & 0x1) != 0;
+		if(sprites && ((bits >> 7) & 0x3) == 0) // Leave some sprite pixels empty
+			line.reset(x);
+		else if(sprites)
+			line.setColorOBJ(x, color, pal, prio);
+		else
+			line.setColorBG(x, color, pal, prio);
+	}
+}
+
+void help(char *name){
+	std::cout << " Usage: " << name << " [scanlines] [seed]\n";
+	std::cout << "  Composite random scanlines with every compositing method supported by the host CPU\n";
+	std::cout << "  and compare the palette indices and output colors against the scalar method.\n";
+}
+
+int main(int argc, char *argv[]){
+	if(argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)){
+		help(argv[0]);
+		return 0;
+	}
+	unsigned int nScanlines = (argc > 1 ? strtoul(argv[1], NULL, 0) : DEFAULT_SCANLINES);
+	unsigned int seed = (argc > 2 ? strtoul(argv[2], NULL, 0) : 0);
+
+	// Select all methods supported by this build and the host CPU, the first is the reference
+	std::vector<std::string> methods;
+	std::vector<ScanlineCompositor> compositors;
+	const std::string names[3] = { "scalar", "sse2", "avx2" };
+	for(unsigned short i = 0; i < 3; i++){
+		ScanlineCompositor compositor;
+		if(compositor.setMethod(names[i])){
+			methods.push_back(names[i]);
+			compositors.push_back(compositor);
+		}
+		else
+			std::cout << " Skipping " << names[i] << " (not supported)\n";
+	}
+
+	// Every palette table entry is unique, so the output colors identify the selected index
+	uint32_t palette[64];
+	for(unsigned short i = 0; i < 64; i++)
+		palette[i] = 0xFF000000 | (i * 0x010203);
+
+	std::mt19937 rng(seed);
+	LayerLine background, window, sprites;
+	uint32_t reference[SCREEN_LINE_WIDTH];
+	uint32_t output[SCREEN_LINE_WIDTH];
+	unsigned char referenceIndex[SCREEN_LINE_WIDTH];
+	unsigned int nMismatched = 0;
+	for(unsigned int line = 0; line < nScanlines; line++){
+		randomize(background, rng, false);
+		randomize(window, rng, false);
+		randomize(sprites, rng, true);
+		unsigned char scroll = rng() & 0xFF;
+		short windowStart = (short)(rng() % (SCREEN_LINE_WIDTH + 40)) - 7; // Includes windows off either edge of the screen
+		bool objPriority = (rng() & 0x1) != 0;
+		bool bgPriority = (rng() & 0x1) != 0;
+		for(size_t i = 0; i < compositors.size(); i++){
+			compositors[i].setPriorityMode(objPriority, bgPriority);
+			if(i == 0){
+				compositors[i].composite(background, window, sprites, scroll, windowStart, palette, reference);
+				memcpy(referenceIndex, compositors[i].getColorIndices(), SCREEN_LINE_WIDTH);
+				continue;
+			}
+			compositors[i].composite(background, window, sprites, scroll, windowStart, palette, output);
+			if(memcmp(referenceIndex, compositors[i].getColorIndices(), SCREEN_LINE_WIDTH) == 0 && memcmp(reference, output, sizeof(output)) == 0)
+				continue;
+			if(nMismatched++ < PRINT_LIMIT){
+				std::cout << " Mismatch on scanline " << line << " (" << methods[i] << "): scroll=" << (int)scroll << ", windowStart=" << windowStart;
+				std::cout << ", objPriority=" << objPriority << ", bgPriority=" << bgPriority << std::endl;
+			}
+		}
+	}
+
+	std::cout << " Compared " << nScanlines << " scanlines using";
+	for(auto method = methods.cbegin(); method != methods.cend(); method++)
+		std::cout << " " << *method;
+	std::cout << " (seed=" << seed << "), " << nMismatched << " mismatched\n";
+
+	return (nMismatched == 0 ? 0 : 1);
+}
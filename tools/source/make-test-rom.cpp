@@ -0,0 +1,282 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+const unsigned int ROM_SIZE = 0x10000; ///< 64 kB (4 banks of 16 kB)
+
+const unsigned int NUM_BANKS = 4;
+
+const unsigned int COVERAGE_PASSES = 4; ///< Number of times every register instruction appears in the main loop body
+
+const unsigned int BANK_BLOCK_INSTRUCTIONS = 64; ///< Random instructions in each switchable bank routine
+
+const unsigned short MAIN_LOOP_COUNT = 4; ///< Number of main loop body iterations per frame
+
+const unsigned short SMC_SOURCE = 0x3000; ///< ROM location of the self-modifying WRAM routine
+
+const unsigned short SMC_DEST = 0xC100; ///< WRAM location of the self-modifying routine
+
+/** Minimal assembler which writes machine code into a ROM image
+  */
+class RomWriter{
+public:
+	std::vector<unsigned char> rom;
+
+	unsigned int pos; ///< Current ROM offset
+
+	RomWriter() : rom(ROM_SIZE, 0), pos(0) { }
+
+	/** Set the current ROM offset
+	  */
+	void org(const unsigned int &offset){ pos = offset; }
+
+	/** Get the CPU address of the current ROM offset
+	  */
+	unsigned short here() const { return (pos < 0x4000 ? pos : 0x4000 + (pos % 0x4000)); }
+
+	void emit(const std::vector<unsigned char> &bytes){
+		for(auto byte = bytes.cbegin(); byte != bytes.cend(); byte++)
+			rom[pos++] = *byte;
+	}
+
+	void emit16(const unsigned char &opcode, const unsigned short &value){
+		emit({ opcode, (unsigned char)(value & 0xFF), (unsigned char)(value >> 8) });
+	}
+
+	/** Emit a relative jump (JR opcode) to a target address before the current address
+	  */
+	void jr(const unsigned char &opcode, const unsigned short &target){
+		emit({ opcode, (unsigned char)(target - (here() + 2)) });
+	}
+};
+
+/** Get the encodings of all instructions which only operate on CPU registers (excluding SP)
+  * CB prefix instructions are returned with the CB prefix in the high byte.
+  */
+std::vector<unsigned short> getRegisterOpcodes(){
+	std::vector<unsigned short> opcodes;
+	for(unsigned short i = 0x40; i < 0xC0; i++){ // LD r,r and ALU A,r
+		if((i & 0x7) != 6 && (i >= 0x80 || ((i >> 3) & 0x7) != 6))
+			opcodes.push_back(i);
+	}
+	for(unsigned short r = 0; r < 8; r++){
+		if(r == 6) // (HL)
+			continue;
+		opcodes.push_back(0x04 | (r << 3)); // INC r
+		opcodes.push_back(0x05 | (r << 3)); // DEC r
+		opcodes.push_back(0x06 | (r << 3)); // LD r,d8
+		opcodes.push_back(0xC6 | (r << 3)); // ALU A,d8
+	}
+	opcodes.push_back(0xF6); // OR d8 (encoded like (HL))
+	for(unsigned short rr = 0; rr < 3; rr++){ // BC DE HL
+		opcodes.push_back(0x01 | (rr << 4)); // LD rr,d16
+		opcodes.push_back(0x03 | (rr << 4)); // INC rr
+		opcodes.push_back(0x0B | (rr << 4)); // DEC rr
+	}
+	for(unsigned short rr = 0; rr < 4; rr++)
+		opcodes.push_back(0x09 | (rr << 4)); // ADD HL,rr
+	const unsigned short misc[8] = { 0x00, 0x07, 0x0F, 0x17, 0x1F, 0x2F, 0x37, 0x3F };
+	opcodes.insert(opcodes.end(), misc, misc + 8);
+	for(unsigned short i = 0; i < 256; i++){ // Rotates, shifts, and bit operations
+		if((i & 0x7) != 6)
+			opcodes.push_back(0xCB00 | i);
+	}
+	return opcodes;
+}
+
+/** Emit a register instruction with random immediate data
+  */
+void emitRegisterOpcode(RomWriter &writer, std::mt19937 &rng, const unsigned short &opcode){
+	if(opcode >= 0xCB00)
+		writer.emit({ 0xCB, (unsigned char)(opcode & 0xFF) });
+	else if((opcode & 0xC7) == 0x06 || (opcode & 0xC7) == 0xC6) // d8
+		writer.emit({ (unsigned char)opcode, (unsigned char)rng() });
+	else if((opcode & 0xCF) == 0x01) // d16
+		writer.emit16((unsigned char)opcode, (unsigned short)rng());
+	else
+		writer.emit({ (unsigned char)opcode });
+}
+
+/** Emit an instruction which is executed by the CPU between runs of register instructions (or a jump which ends the block)
+  */
+void emitCpuOpcode(RomWriter &writer, std::mt19937 &rng){
+	const unsigned char pairs[4] = { 0xC5, 0xD5, 0xE5, 0xF5 };
+	switch(rng() % 5){
+		case 0: // DAA
+			writer.emit({ 0x27 });
+			break;
+		case 1: // LD HL,SP+r8
+			writer.emit({ 0xF8, (unsigned char)(rng() % 8) });
+			break;
+		case 2: // Scratch memory access
+			writer.emit16((rng() % 2) ? 0xEA : 0xFA, 0xC200);
+			break;
+		case 3: // Swap register pairs through the stack
+			writer.emit({ pairs[rng() % 4], (unsigned char)(pairs[rng() % 4] - 4) });
+			break;
+		default: // JR to the next instruction (ends the translated block)
+			writer.emit({ 0x18, 0x00 });
+			break;
+	}
+}
+
+/** Emit every register instruction in random order, with CPU instructions (DAA, stack, memory access, and jumps)
+  * inserted at random points so that runs of register instructions have random lengths
+  */
+void coverageBlock(RomWriter &writer, std::mt19937 &rng){
+	std::vector<unsigned short> opcodes = getRegisterOpcodes();
+	std::shuffle(opcodes.begin(), opcodes.end(), rng);
+	for(auto opcode = opcodes.cbegin(); opcode != opcodes.cend(); opcode++){
+		if(rng() % 8 == 0)
+			emitCpuOpcode(writer, rng);
+		emitRegisterOpcode(writer, rng, *opcode);
+	}
+}
+
+/** Emit a random sequence of register and CPU instructions
+  */
+void randomBlock(RomWriter &writer, std::mt19937 &rng, const unsigned int &nInstructions){
+	std::vector<unsigned short> opcodes = getRegisterOpcodes();
+	for(unsigned int i = 0; i < nInstructions; i++){
+		if(rng() % 8 == 0)
+			emitCpuOpcode(writer, rng);
+		else
+			emitRegisterOpcode(writer, rng, opcodes[rng() % opcodes.size()]);
+	}
+}
+
+/** Write the cartridge header (MBC1, 64 kB ROM, no RAM)
+  */
+void writeHeader(RomWriter &writer){
+	writer.org(0x100);
+	writer.emit({ 0x00 }); // nop
+	writer.emit16(0xC3, 0x0150); // jp $0150
+	const char *title = "ENGINECHECK";
+	memcpy(&writer.rom[0x134], title, strlen(title));
+	writer.rom[0x147] = 0x01; // MBC1
+	writer.rom[0x148] = 0x01; // 64 kB ROM
+	writer.rom[0x149] = 0x00; // No RAM
+	unsigned char checksum = 0;
+	for(unsigned short i = 0x134; i <= 0x14C; i++)
+		checksum = checksum - writer.rom[i] - 1;
+	writer.rom[0x14D] = checksum;
+}
+
+void help(char *name){
+	std::cout << " Usage: " << name << " <output> [seed]\n";
+	std::cout << "  Generate a test ROM for comparing CPU engines. The ROM repeatedly runs every register\n";
+	std::cout << "  instruction in random order with random operands, random register code in switchable MBC1\n";
+	std::cout << "  banks, and self-modifying code in WRAM, interrupted by VBlank and timer interrupts. It waits\n";
+	std::cout << "  for VBlank with HALT and a LY polling loop.\n";
+}
+
+int main(int argc, char *argv[]){
+	if(argc < 2 || strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0){
+		help(argv[0]);
+		return (argc < 2 ? 1 : 0);
+	}
+	unsigned int seed = (argc > 2 ? strtoul(argv[2], NULL, 0) : 0);
+	std::mt19937 rng(seed);
+	RomWriter writer;
+
+	// VBlank interrupt: count frames and draw the frame counter into tile 0
+	writer.org(0x40);
+	writer.emit({ 0xF5 }); // push af
+	writer.emit16(0xFA, 0xC000); // ld a,($C000)
+	writer.emit({ 0x3C }); // inc a
+	writer.emit16(0xEA, 0xC000); // ld ($C000),a
+	writer.emit16(0xEA, 0x8000); // ld ($8000),a
+	writer.emit16(0xEA, 0x8003); // ld ($8003),a
+	writer.emit({ 0xF1, 0xD9 }); // pop af, reti
+
+	// Timer interrupt: count interrupts
+	writer.org(0x50);
+	writer.emit({ 0xE5 }); // push hl
+	writer.emit16(0x21, 0xC002); // ld hl,$C002
+	writer.emit({ 0x34, 0xE1, 0xD9 }); // inc (hl), pop hl, reti
+
+	writeHeader(writer);
+
+	// Initialization
+	writer.org(0x150);
+	writer.emit({ 0xF3 }); // di
+	writer.emit16(0x31, 0xFFFE); // ld sp,$FFFE
+	writer.emit16(0x21, SMC_SOURCE); // ld hl,SMC_SOURCE
+	writer.emit16(0x11, SMC_DEST); // ld de,SMC_DEST
+	writer.emit({ 0x0E, 9 }); // ld c,9
+	unsigned short copy = writer.here();
+	writer.emit({ 0x2A, 0x12, 0x13, 0x0D }); // ld a,(hl+), ld (de),a, inc de, dec c
+	writer.jr(0x20, copy); // jr nz,copy
+	writer.emit({ 0xAF }); // xor a
+	writer.emit16(0xEA, 0xC000); // ld ($C000),a
+	writer.emit({ 0xE0, 0x0F }); // ldh ($0F),a (clear IF)
+	writer.emit({ 0x3E, 0xF0, 0xE0, 0x06 }); // TMA = $F0
+	writer.emit({ 0x3E, 0x06, 0xE0, 0x07 }); // TAC = 65536 Hz
+	writer.emit({ 0x3E, 0x05, 0xE0, 0xFF }); // IE = VBlank and timer
+	writer.emit({ 0x3E, 0x91, 0xE0, 0x40 }); // LCDC = display and background on
+	writer.emit({ 0xFB }); // ei
+
+	// Main loop
+	unsigned short mainLoop = writer.here();
+	writer.emit16(0x21, 0xFFFE); // ld hl,$FFFE
+	writer.emit({ 0xF9 }); // ld sp,hl
+	writer.emit({ 0x3E, (unsigned char)MAIN_LOOP_COUNT }); // ld a,MAIN_LOOP_COUNT
+	writer.emit16(0xEA, 0xC001); // ld ($C001),a
+	unsigned short body = writer.here();
+	for(unsigned int i = 0; i < COVERAGE_PASSES; i++)
+		coverageBlock(writer, rng);
+	writer.emit16(0x21, 0xC001); // ld hl,$C001
+	writer.emit({ 0x35 }); // dec (hl)
+	writer.emit16(0xC2, body); // jp nz,body
+
+	// Call a routine in bank 1, 2, or 3 (selected by the frame counter)
+	writer.emit16(0xFA, 0xC000); // ld a,($C000)
+	writer.emit({ 0xE6, 0x03 }); // and 3
+	writer.emit({ 0x20, 0x01, 0x3C }); // jr nz,+1, inc a
+	writer.emit16(0xEA, 0x2000); // ld ($2000),a
+	writer.emit16(0xCD, 0x4000); // call $4000
+
+	// Call the self-modifying routine
+	writer.emit16(0xCD, SMC_DEST); // call SMC_DEST
+
+	// Wait for VBlank, then for the start of line 5
+	writer.emit({ 0x76 }); // halt
+	unsigned short wait = writer.here();
+	writer.emit({ 0xF0, 0x44, 0xFE, 0x05 }); // ldh a,($44), cp 5
+	writer.jr(0x20, wait); // jr nz,wait
+	writer.emit16(0xC3, mainLoop); // jp mainLoop
+
+	if(writer.pos > SMC_SOURCE){
+		std::cout << " Error! Main loop overlaps the self-modifying routine.\n";
+		return 1;
+	}
+
+	// Self-modifying routine (the immediate operand of the first instruction is incremented on every call)
+	writer.org(SMC_SOURCE);
+	writer.emit({ 0x3E, 0x00 }); // ld a,0
+	writer.emit({ 0x3C }); // inc a
+	writer.emit16(0xEA, SMC_DEST + 1); // ld (SMC_DEST+1),a
+	writer.emit({ 0x80, 0x47, 0xC9 }); // add a,b, ld b,a, ret
+
+	// Switchable bank routines
+	for(unsigned int bank = 1; bank < NUM_BANKS; bank++){
+		writer.org(bank * 0x4000);
+		randomBlock(writer, rng, BANK_BLOCK_INSTRUCTIONS);
+		writer.emit({ 0xC9 }); // ret
+	}
+
+	std::ofstream file(argv[1], std::ios::binary);
+	if(!file.good()){
+		std::cout << " Error! Failed to open output file \"" << argv[1] << "\".\n";
+		return 1;
+	}
+	file.write((const char *)writer.rom.data(), writer.rom.size());
+	file.close();
+	std::cout << " Wrote " << writer.rom.size() / 1024 << " kB test ROM to \"" << argv[1] << "\" (seed=" << seed << ")\n";
+
+	return 0;
+}
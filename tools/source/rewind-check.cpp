@@ -0,0 +1,119 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cstring>
+#include <cstdlib>
+
+#include "RewindBuffer.hpp"
+
+const unsigned int DEFAULT_STATES = 20000; ///< Default number of random states to push
+
+const size_t STATE_SIZE = 256; ///< Size of each test state (in bytes)
+
+/** Change the first nBytes bytes of a state to different random values
+  * The XOR difference is a single run of nBytes random literals, which is stored uncompressed in nBytes+2 bytes.
+  */
+void modify(std::vector<unsigned char> &state, std::mt19937 &rng, const size_t &nBytes){
+	for(size_t i = 0; i < nBytes; i++)
+		state[i] ^= (unsigned char)(1 + rng() % 255);
+}
+
+/** Pop every state from the buffer and compare them against the newest pushed states
+  * @return True if all states match
+  */
+bool popAll(RewindBuffer &buffer, const std::vector<std::vector<unsigned char> > &history){
+	size_t nStates = buffer.getNumberOfStates();
+	if(nStates > history.size()){
+		std::cout << " Buffer holds " << nStates << " states, but only " << history.size() << " were pushed\n";
+		return false;
+	}
+	std::vector<unsigned char> state;
+	for(size_t i = 0; i < nStates; i++){
+		if(!buffer.pop(state) || state != history[history.size() - 1 - i]){
+			std::cout << " State " << i << " (newest first) of " << nStates << " does not match\n";
+			return false;
+		}
+	}
+	return buffer.empty();
+}
+
+/** Fill the ring exactly to the end, then push identical states
+  * Identical states produce empty differences which must not discard the history.
+  */
+bool checkFullRing(){
+	const size_t nDeltas = 10;
+	const size_t deltaLength = 100;
+	RewindBuffer buffer(nDeltas * deltaLength);
+	std::mt19937 rng(1);
+	std::vector<std::vector<unsigned char> > history;
+	std::vector<unsigned char> state(STATE_SIZE, 0);
+	history.push_back(state);
+	buffer.push(state);
+	for(size_t i = 0; i < nDeltas; i++){
+		modify(state, rng, deltaLength - 2);
+		history.push_back(state);
+		buffer.push(state);
+	}
+	for(size_t i = 0; i < 5; i++){
+		history.push_back(state);
+		buffer.push(state);
+	}
+	if(buffer.getNumberOfStates() != history.size()){
+		std::cout << " Full ring: expected " << history.size() << " states after pushing identical states, found " << buffer.getNumberOfStates() << "\n";
+		return false;
+	}
+
+	// The next difference wraps around and only discards the oldest state
+	modify(state, rng, deltaLength - 2);
+	history.push_back(state);
+	buffer.push(state);
+	if(buffer.getNumberOfStates() != history.size() - 1){
+		std::cout << " Full ring: expected " << history.size() - 1 << " states after wrapping, found " << buffer.getNumberOfStates() << "\n";
+		return false;
+	}
+	return popAll(buffer, history);
+}
+
+/** Push random states (including runs of identical states) and periodically verify the stored history
+  */
+bool checkRandom(const unsigned int &nStates, const unsigned int &seed){
+	RewindBuffer buffer(4096);
+	std::mt19937 rng(seed);
+	std::vector<std::vector<unsigned char> > history;
+	std::vector<unsigned char> state(STATE_SIZE, 0);
+	for(unsigned int i = 0; i < nStates; i++){
+		if(rng() % 3 != 0) // Otherwise identical to the previous state
+			modify(state, rng, 1 + rng() % (STATE_SIZE - 1));
+		history.push_back(state);
+		buffer.push(state);
+		if(rng() % 500 == 0){
+			if(!popAll(buffer, history)){
+				std::cout << " Random: mismatch after " << i + 1 << " states (seed=" << seed << ")\n";
+				return false;
+			}
+			history.clear();
+		}
+	}
+	return popAll(buffer, history);
+}
+
+void help(char *name){
+	std::cout << " Usage: " << name << " [states] [seed]\n";
+	std::cout << "  Push states into a rewind buffer, including identical states and states which fill the\n";
+	std::cout << "  buffer exactly to the end, then pop them and compare them against the pushed states.\n";
+}
+
+int main(int argc, char *argv[]){
+	if(argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)){
+		help(argv[0]);
+		return 0;
+	}
+	unsigned int nStates = (argc > 1 ? strtoul(argv[1], NULL, 0) : DEFAULT_STATES);
+	unsigned int seed = (argc > 2 ? strtoul(argv[2], NULL, 0) : 0);
+
+	bool fullRing = checkFullRing();
+	bool random = checkRandom(nStates, seed);
+	std::cout << " Full ring check " << (fullRing ? "passed" : "failed") << ", random check of " << nStates << " states " << (random ? "passed" : "failed") << " (seed=" << seed << ")\n";
+
+	return (fullRing && random ? 0 : 1);
+}